@@ -0,0 +1,169 @@
+/*
+ * log.c
+ *
+ *  Created on: Feb 9, 2026
+ *      Author: penel
+ */
+
+#include "log.h"
+#include "../uart/uart_tx.h"
+#include "../time/timebase.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Ordre de log_module_t */
+static const char *const s_mod_names[LOG_MOD_COUNT] =
+{
+    [LOG_MOD_MAIN]  = "MAIN",
+    [LOG_MOD_SENS]  = "SENS",
+    [LOG_MOD_MPU]   = "MPU",
+    [LOG_MOD_CAN]   = "CAN",
+    [LOG_MOD_PARAM] = "PARAM",
+    [LOG_MOD_RPI]   = "RPI",
+};
+
+static const char s_lvl_chars[] = "OEWID";
+
+static UART_HandleTypeDef *s_huart = NULL;
+static uint8_t     s_level[LOG_MOD_COUNT];
+static log_stats_t s_stats;
+static uint32_t    s_dropped_shown = 0;   /* pertes déjà signalées sur la console */
+
+HAL_StatusTypeDef Log_Init(UART_HandleTypeDef *huart)
+{
+    uint32_t i;
+
+    if (huart == NULL)
+        return HAL_ERROR;
+
+    for (i = 0; i < LOG_MOD_COUNT; i++)
+        s_level[i] = LOG_LEVEL_DEFAULT;
+    s_huart = huart;
+    return HAL_OK;
+}
+
+/* Horodatage µs (timebase.h) suivi d'une espace, sans %llu (newlib-nano) */
+static int Log_Stamp(char *buf, size_t size)
+{
+    uint64_t us = Timebase_Now();
+    uint32_t hi = (uint32_t)(us / 1000000u);
+    uint32_t lo = (uint32_t)(us % 1000000u);
+
+    if (hi == 0u)
+        return snprintf(buf, size, "%lu ", (unsigned long)lo);
+    return snprintf(buf, size, "%lu%06lu ", (unsigned long)hi, (unsigned long)lo);
+}
+
+/* Copie d'une ligne dans le buffer d'émission : entière ou perdue */
+static uint8_t Log_Put(const char *line, size_t len)
+{
+    if (s_huart == NULL || UartTx_Write(s_huart, (const uint8_t *)line, (uint16_t)len) == 0u)
+    {
+        s_stats.dropped++;
+        return 0;
+    }
+    s_stats.lines++;
+    return 1;
+}
+
+void Log_Write(log_module_t mod, uint8_t lvl, const char *fmt, ...)
+{
+    char line[LOG_LINE_MAX];
+    va_list ap;
+    int n, m;
+
+    if (mod >= LOG_MOD_COUNT || lvl == LOG_LVL_OFF || lvl > s_level[mod])
+        return;
+
+    /* Pertes depuis la dernière ligne émise : signalées dès qu'il y a de
+     * la place, avant la ligne suivante
+     */
+    if (s_stats.dropped != s_dropped_shown && s_huart != NULL)
+    {
+        uint32_t lost = s_stats.dropped - s_dropped_shown;
+
+        n = Log_Stamp(line, sizeof(line));
+        n += snprintf(&line[n], sizeof(line) - (size_t)n, "W LOG: %lu lignes perdues\r\n",
+                      (unsigned long)lost);
+        if (Log_Put(line, (size_t)n))
+            s_dropped_shown += lost;
+    }
+
+    n = Log_Stamp(line, sizeof(line));
+    n += snprintf(&line[n], sizeof(line) - (size_t)n, "%c %s: ",
+                  s_lvl_chars[lvl], s_mod_names[mod]);
+
+    va_start(ap, fmt);
+    m = vsnprintf(&line[n], sizeof(line) - (size_t)n - 2u, fmt, ap);
+    va_end(ap);
+
+    if (m < 0)
+        m = 0;
+    if ((size_t)(n + m) > sizeof(line) - 3u)
+    {
+        s_stats.truncated++;
+        m = (int)(sizeof(line) - 3u) - n;
+    }
+    n += m;
+    line[n++] = '\r';
+    line[n++] = '\n';
+
+    (void)Log_Put(line, (size_t)n);
+}
+
+HAL_StatusTypeDef Log_SetLevel(log_module_t mod, uint8_t lvl)
+{
+    uint32_t i;
+
+    if (lvl > LOG_LVL_DEBUG || mod > LOG_MOD_COUNT)
+        return HAL_ERROR;
+
+    if (mod == LOG_MOD_COUNT)
+    {
+        for (i = 0; i < LOG_MOD_COUNT; i++)
+            s_level[i] = lvl;
+    }
+    else
+        s_level[mod] = lvl;
+    return HAL_OK;
+}
+
+uint8_t Log_GetLevel(log_module_t mod)
+{
+    return (mod < LOG_MOD_COUNT) ? s_level[mod] : LOG_LVL_OFF;
+}
+
+const char *Log_ModuleName(log_module_t mod)
+{
+    return (mod < LOG_MOD_COUNT) ? s_mod_names[mod] : "?";
+}
+
+log_module_t Log_FindModule(const char *name, size_t len)
+{
+    uint32_t i;
+
+    for (i = 0; i < LOG_MOD_COUNT; i++)
+    {
+        if (strlen(s_mod_names[i]) == len && strncmp(s_mod_names[i], name, len) == 0)
+            return (log_module_t)i;
+    }
+    return LOG_MOD_COUNT;
+}
+
+char Log_LevelChar(uint8_t lvl)
+{
+    return (lvl <= LOG_LVL_DEBUG) ? s_lvl_chars[lvl] : '?';
+}
+
+uint8_t Log_LevelFromChar(char c)
+{
+    const char *p = (c != '\0') ? strchr(s_lvl_chars, c) : NULL;
+
+    return (p != NULL) ? (uint8_t)(p - s_lvl_chars) : (uint8_t)(LOG_LVL_DEBUG + 1u);
+}
+
+void Log_GetStats(log_stats_t *st)
+{
+    *st = s_stats;
+}
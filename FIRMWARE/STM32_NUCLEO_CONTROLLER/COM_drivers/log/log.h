@@ -0,0 +1,132 @@
+/*
+ * log.h
+ *
+ *  Created on: Feb 9, 2026
+ *      Author: penel
+ */
+
+#ifndef LOG_H_
+#define LOG_H_
+
+#include "main.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Traces de debug sur l'UART de la console (USART2) uniquement, jamais sur
+ * la liaison Raspberry Pi.
+ *
+ * Chaque ligne est formatée dans la pile puis copiée en une fois dans le
+ * buffer circulaire d'émission (uart_tx.h), vidé par DMA : l'appel ne
+ * bloque jamais. Buffer plein : la ligne entière est perdue et comptée.
+ *
+ *   "<µs> <E|W|I|D> <MODULE>: <message>\r\n"
+ *
+ * L'horodatage est la base de temps commune (timebase.h), comme les t_us
+ * des échantillons : les traces se recalent sur les mesures.
+ *
+ * Filtrage par module à l'exécution (Log_SetLevel, commande LOG du
+ * protocole) ; les niveaux au-dessus de LOG_LEVEL_MAX disparaissent à la
+ * compilation.
+ */
+
+/* Niveaux (du plus grave au plus bavard) */
+#define LOG_LVL_OFF        0u
+#define LOG_LVL_ERR        1u
+#define LOG_LVL_WARN       2u
+#define LOG_LVL_INFO       3u
+#define LOG_LVL_DEBUG      4u
+
+/* Niveau maximal compilé (-DLOG_LEVEL_MAX=LOG_LVL_INFO en release) */
+#ifndef LOG_LEVEL_MAX
+#define LOG_LEVEL_MAX      LOG_LVL_DEBUG
+#endif
+
+/* Niveau de chaque module au démarrage */
+#define LOG_LEVEL_DEFAULT  LOG_LVL_INFO
+
+/* Ligne complète, horodatage et "\r\n" compris (tronquée au-delà) */
+#define LOG_LINE_MAX       128u
+
+typedef enum
+{
+    LOG_MOD_MAIN = 0,       /* main.c, démarrage */
+    LOG_MOD_SENS,           /* sensors_app */
+    LOG_MOD_MPU,            /* mpu9250 */
+    LOG_MOD_CAN,            /* stepper_can */
+    LOG_MOD_PARAM,          /* param, EEPROM émulée */
+    LOG_MOD_RPI,            /* protocole Raspberry Pi */
+    LOG_MOD_COUNT
+} log_module_t;
+
+typedef struct
+{
+    uint32_t lines;         /* lignes mises en file d'émission */
+    uint32_t dropped;       /* lignes perdues : buffer d'émission plein */
+    uint32_t truncated;     /* lignes coupées à LOG_LINE_MAX */
+} log_stats_t;
+
+/**
+ * @brief Console de debug (émission DMA déjà initialisée par
+ *        UartTx_Init). Traces ignorées avant cet appel.
+ */
+HAL_StatusTypeDef Log_Init(UART_HandleTypeDef *huart);
+
+/**
+ * @brief Formate et met en file une ligne si `lvl` passe le filtre du
+ *        module. Ne bloque pas ; évitable dans les interruptions (formatage
+ *        vsnprintf dans la pile).
+ */
+void Log_Write(log_module_t mod, uint8_t lvl, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#if LOG_LEVEL_MAX >= LOG_LVL_ERR
+#define LOG_E(mod, ...)    Log_Write((mod), LOG_LVL_ERR, __VA_ARGS__)
+#else
+#define LOG_E(mod, ...)    ((void)0)
+#endif
+
+#if LOG_LEVEL_MAX >= LOG_LVL_WARN
+#define LOG_W(mod, ...)    Log_Write((mod), LOG_LVL_WARN, __VA_ARGS__)
+#else
+#define LOG_W(mod, ...)    ((void)0)
+#endif
+
+#if LOG_LEVEL_MAX >= LOG_LVL_INFO
+#define LOG_I(mod, ...)    Log_Write((mod), LOG_LVL_INFO, __VA_ARGS__)
+#else
+#define LOG_I(mod, ...)    ((void)0)
+#endif
+
+#if LOG_LEVEL_MAX >= LOG_LVL_DEBUG
+#define LOG_D(mod, ...)    Log_Write((mod), LOG_LVL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_D(mod, ...)    ((void)0)
+#endif
+
+/**
+ * @brief Niveau d'un module (LOG_MOD_COUNT : tous). HAL_ERROR si le
+ *        niveau est inconnu.
+ */
+HAL_StatusTypeDef Log_SetLevel(log_module_t mod, uint8_t lvl);
+
+uint8_t Log_GetLevel(log_module_t mod);
+
+const char *Log_ModuleName(log_module_t mod);
+
+/**
+ * @brief Module de nom `name` (`len` caractères), LOG_MOD_COUNT si
+ *        inconnu.
+ */
+log_module_t Log_FindModule(const char *name, size_t len);
+
+/**
+ * @brief Lettre d'un niveau ('O', 'E', 'W', 'I', 'D') et inverse
+ *        (LOG_LVL_DEBUG + 1 si inconnue).
+ */
+char    Log_LevelChar(uint8_t lvl);
+uint8_t Log_LevelFromChar(char c);
+
+void Log_GetStats(log_stats_t *st);
+
+#endif /* LOG_H_ */
@@ -0,0 +1,91 @@
+/*
+ * trace.c
+ *
+ *  Created on: Feb 10, 2026
+ *      Author: penel
+ */
+
+#include "trace.h"
+#include "../time/timebase.h"
+
+#if (TRACE_RING_WORDS & (TRACE_RING_WORDS - 1u)) != 0u
+#error "TRACE_RING_WORDS doit etre une puissance de 2"
+#endif
+
+#define TRACE_MASK  (TRACE_RING_WORDS - 1u)
+
+/* Indices libres (non masqués) : head écrit sous masquage des
+ * interruptions, tail par le seul lecteur (boucle principale)
+ */
+static uint32_t s_ring[TRACE_RING_WORDS];
+static volatile uint32_t s_head = 0;
+static volatile uint32_t s_tail = 0;
+static uint32_t s_events = 0;
+static uint32_t s_lost = 0;
+static uint16_t s_high_water = 0;
+
+void Trace_Write(uint32_t token, uint32_t nargs, const uint32_t *args)
+{
+    uint32_t primask, head, used, i;
+
+    if (nargs > TRACE_ARGS_MAX)
+        nargs = TRACE_ARGS_MAX;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    head = s_head;
+    used = head - s_tail;
+    if (used + 2u + nargs > TRACE_RING_WORDS)
+    {
+        s_lost++;
+        __set_PRIMASK(primask);
+        return;
+    }
+
+    s_ring[head++ & TRACE_MASK] = (token & 0xFFFFu) | (nargs << 16);
+    s_ring[head++ & TRACE_MASK] = Timebase_Now32();
+    for (i = 0; i < nargs; i++)
+        s_ring[head++ & TRACE_MASK] = args[i];
+    s_head = head;
+
+    s_events++;
+    used += 2u + nargs;
+    if (used > s_high_water)
+        s_high_water = (uint16_t)used;
+
+    __set_PRIMASK(primask);
+}
+
+uint32_t Trace_Read(uint32_t *out, uint32_t max_words)
+{
+    uint32_t tail = s_tail;
+    uint32_t head = s_head;
+    uint32_t n = 0, len, i;
+
+    while (tail != head)
+    {
+        len = 2u + ((s_ring[tail & TRACE_MASK] >> 16) & 0xFFu);
+        if (n + len > max_words)
+            break;
+        for (i = 0; i < len; i++)
+            out[n++] = s_ring[(tail + i) & TRACE_MASK];
+        tail += len;
+    }
+
+    /* Place libérée une fois la copie terminée */
+    s_tail = tail;
+    return n;
+}
+
+void Trace_GetStats(trace_stats_t *st)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    st->events     = s_events;
+    st->lost       = s_lost;
+    st->used       = (uint16_t)(s_head - s_tail);
+    st->high_water = s_high_water;
+    __set_PRIMASK(primask);
+}
@@ -0,0 +1,125 @@
+/*
+ * trace.h
+ *
+ *  Created on: Feb 10, 2026
+ *      Author: penel
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "main.h"
+#include <stdint.h>
+
+/*
+ * Trace binaire pour les événements fréquents (I2C, CAN, régulation), là
+ * où une ligne de log.h coûterait trop cher.
+ *
+ * Le texte n'est pas dans l'image : chaque TRACEn() place sa chaîne de
+ * format dans la section .trace_fmt, présente dans l'ELF mais jamais
+ * chargée en flash (INFO dans le script de liaison, adresse 0). L'adresse
+ * de la chaîne dans cette section sert de jeton. En RAM, un événement ne
+ * coûte que
+ *
+ *   mot 0 : jeton (16 bits) | nombre d'arguments << 16
+ *   mot 1 : horodatage Timebase_Now32() (µs)
+ *   mots 2.. : arguments bruts (32 bits chacun, 0 à TRACE_ARGS_MAX)
+ *
+ * dans un buffer circulaire, soit quelques dizaines de cycles, interruptions
+ * comprises. Buffer plein : l'événement est perdu et compté.
+ *
+ * Lecture par le Raspberry Pi (commande TRC) ; python/stm32_trace.py
+ * retrouve les chaînes dans l'ELF et reconstruit les lignes. Les formats
+ * n'acceptent que des entiers (%d %i %u %x %X %c, largeur et zéros
+ * permis).
+ */
+
+/* 0 : TRACEn() ne génère aucun code */
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE        1
+#endif
+
+#define TRACE_RING_WORDS    512u     /* 2 Ko, puissance de 2 */
+#define TRACE_ARGS_MAX      4u
+#define TRACE_REC_MAX_WORDS (2u + TRACE_ARGS_MAX)
+
+typedef struct
+{
+    uint32_t events;        /* événements enregistrés */
+    uint32_t lost;          /* événements perdus : buffer plein */
+    uint16_t used;          /* mots en attente de lecture */
+    uint16_t high_water;    /* remplissage maximal (mots) */
+} trace_stats_t;
+
+/**
+ * @brief Enregistre un événement (tous contextes). Appelée par TRACEn().
+ */
+void Trace_Write(uint32_t token, uint32_t nargs, const uint32_t *args);
+
+/**
+ * @brief Retire des événements entiers du buffer, au plus `max_words` mots.
+ *
+ * @return nombre de mots copiés dans out (0 : buffer vide)
+ */
+uint32_t Trace_Read(uint32_t *out, uint32_t max_words);
+
+void Trace_GetStats(trace_stats_t *st);
+
+#if TRACE_ENABLE
+
+#define TRACE_STR_(x)       #x
+#define TRACE_STR(x)        TRACE_STR_(x)
+
+/* Chaîne "<fichier>:<ligne>\t<format>" hors de l'image chargée ; son
+ * adresse (< 64 Ko, vérifié par le script de liaison) est le jeton
+ */
+#define TRACE_TOKEN_(fmt)                                                    \
+    ({                                                                       \
+        static const char trace_fmt_[]                                       \
+            __attribute__((section(".trace_fmt"), used, aligned(1))) =       \
+            __FILE__ ":" TRACE_STR(__LINE__) "\t" fmt;                       \
+        (uint32_t)(uintptr_t)trace_fmt_;                                     \
+    })
+
+#define TRACE0(fmt)                                                          \
+    Trace_Write(TRACE_TOKEN_(fmt), 0u, NULL)
+
+#define TRACE1(fmt, a)                                                       \
+    do {                                                                     \
+        const uint32_t trace_a_[1] = { (uint32_t)(a) };                      \
+        Trace_Write(TRACE_TOKEN_(fmt), 1u, trace_a_);                        \
+    } while (0)
+
+#define TRACE2(fmt, a, b)                                                    \
+    do {                                                                     \
+        const uint32_t trace_a_[2] = { (uint32_t)(a), (uint32_t)(b) };       \
+        Trace_Write(TRACE_TOKEN_(fmt), 2u, trace_a_);                        \
+    } while (0)
+
+#define TRACE3(fmt, a, b, c)                                                 \
+    do {                                                                     \
+        const uint32_t trace_a_[3] = { (uint32_t)(a), (uint32_t)(b),         \
+                                       (uint32_t)(c) };                      \
+        Trace_Write(TRACE_TOKEN_(fmt), 3u, trace_a_);                        \
+    } while (0)
+
+#define TRACE4(fmt, a, b, c, d)                                              \
+    do {                                                                     \
+        const uint32_t trace_a_[4] = { (uint32_t)(a), (uint32_t)(b),         \
+                                       (uint32_t)(c), (uint32_t)(d) };       \
+        Trace_Write(TRACE_TOKEN_(fmt), 4u, trace_a_);                        \
+    } while (0)
+
+#else
+
+/* sizeof : arguments non évalués, pas d'avertissement "inutilisé" */
+#define TRACE0(fmt)                 ((void)0)
+#define TRACE1(fmt, a)              ((void)sizeof(a))
+#define TRACE2(fmt, a, b)           ((void)sizeof(a), (void)sizeof(b))
+#define TRACE3(fmt, a, b, c)        ((void)sizeof(a), (void)sizeof(b), (void)sizeof(c))
+#define TRACE4(fmt, a, b, c, d)     ((void)sizeof(a), (void)sizeof(b), (void)sizeof(c), \
+                                     (void)sizeof(d))
+
+#endif /* TRACE_ENABLE */
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,319 @@
+/*
+ * flash_ee.c
+ *
+ *  Created on: Feb 4, 2026
+ *      Author: penel
+ */
+
+#include "flash_ee.h"
+#include "../time/perf.h"
+
+/* Etat d'une page (1er mot de l'en-tête) : la programmation ne fait que
+ * passer des bits de 1 à 0, ERASED -> RECEIVE -> ACTIVE sans effacement
+ */
+#define EE_STATE_ERASED     0xFFFFFFFFu
+#define EE_STATE_RECEIVE    0xEEEEEEEEu
+#define EE_STATE_ACTIVE     0x00000000u
+
+#define EE_HDR_SIZE         8u
+#define EE_BLANK            0xFFFFFFFFu
+
+typedef struct
+{
+    uint32_t value;
+    uint32_t tag;           /* id | crc16 << 16 */
+} ee_rec_t;
+
+static const uint32_t s_page_addr[2]   = { FLASH_EE_PAGE0_ADDR, FLASH_EE_PAGE1_ADDR };
+static const uint32_t s_page_sector[2] = { FLASH_EE_PAGE0_SECTOR, FLASH_EE_PAGE1_SECTOR };
+
+static uint8_t  s_ready      = 0;
+static uint8_t  s_active     = 0;
+static uint32_t s_next       = 0;  /* premier emplacement vierge de la page active */
+static uint32_t s_generation = 0;
+static uint32_t s_crc_errors = 0;
+static uint32_t s_erases     = 0;
+
+static uint32_t ee_hdr(uint8_t page, uint32_t word)
+{
+    return ((const volatile uint32_t *)s_page_addr[page])[word];
+}
+
+static const volatile ee_rec_t *ee_rec(uint8_t page, uint32_t i)
+{
+    return (const volatile ee_rec_t *)(s_page_addr[page] + EE_HDR_SIZE + i * FLASH_EE_REC_SIZE);
+}
+
+/* CRC-16/CCITT (init 0xFFFF) sur id puis valeur, petit-boutiste */
+static uint16_t ee_crc16(uint16_t id, uint32_t value)
+{
+    uint8_t  b[6];
+    uint16_t crc = 0xFFFFu;
+    uint32_t i, k;
+
+    b[0] = (uint8_t)id;
+    b[1] = (uint8_t)(id >> 8);
+    b[2] = (uint8_t)value;
+    b[3] = (uint8_t)(value >> 8);
+    b[4] = (uint8_t)(value >> 16);
+    b[5] = (uint8_t)(value >> 24);
+
+    for (i = 0; i < sizeof(b); i++)
+    {
+        crc ^= (uint16_t)b[i] << 8;
+        for (k = 0; k < 8u; k++)
+            crc = (crc & 0x8000u) ? (uint16_t)((crc << 1) ^ 0x1021u) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+static uint8_t ee_rec_blank(const volatile ee_rec_t *r)
+{
+    return (r->value == EE_BLANK) && (r->tag == EE_BLANK);
+}
+
+static uint8_t ee_rec_valid(const volatile ee_rec_t *r)
+{
+    uint16_t id = (uint16_t)r->tag;
+
+    return (id != FLASH_EE_ID_NONE) && ((uint16_t)(r->tag >> 16) == ee_crc16(id, r->value));
+}
+
+/* Génération a plus récente que b (compteur circulaire) */
+static uint8_t ee_newer(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) > 0;
+}
+
+static void ee_unlock(void)
+{
+    (void)HAL_FLASH_Unlock();
+    __HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR |
+                           FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR);
+}
+
+/* Programme un mot puis le relit (cache de données vidé : il peut contenir
+ * l'ancienne valeur vierge)
+ */
+static HAL_StatusTypeDef ee_program(uint32_t addr, uint32_t data)
+{
+    if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr, data) != HAL_OK)
+        return HAL_ERROR;
+
+    __HAL_FLASH_DATA_CACHE_DISABLE();
+    __HAL_FLASH_DATA_CACHE_RESET();
+    __HAL_FLASH_DATA_CACHE_ENABLE();
+
+    return (*(const volatile uint32_t *)addr == data) ? HAL_OK : HAL_ERROR;
+}
+
+static HAL_StatusTypeDef ee_erase(uint8_t page)
+{
+    FLASH_EraseInitTypeDef e = {0};
+    uint32_t bad_sector;
+
+    e.TypeErase    = FLASH_TYPEERASE_SECTORS;
+    e.Sector       = s_page_sector[page];
+    e.NbSectors    = 1;
+    e.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+    s_erases++;
+    return HAL_FLASHEx_Erase(&e, &bad_sector);
+}
+
+static uint8_t ee_page_blank(uint8_t page)
+{
+    const volatile uint32_t *p = (const volatile uint32_t *)s_page_addr[page];
+    uint32_t i;
+
+    for (i = 0; i < FLASH_EE_PAGE_SIZE / 4u; i++)
+    {
+        if (p[i] != EE_BLANK)
+            return 0;
+    }
+    return 1;
+}
+
+/* Valeur d'abord : sans le mot id/crc, l'enregistrement est invalide */
+static HAL_StatusTypeDef ee_write_rec(uint8_t page, uint32_t i, uint16_t id, uint32_t value)
+{
+    uint32_t addr = (uint32_t)ee_rec(page, i);
+
+    if (ee_program(addr, value) != HAL_OK)
+        return HAL_ERROR;
+    return ee_program(addr + 4u, (uint32_t)id | ((uint32_t)ee_crc16(id, value) << 16));
+}
+
+/* Page vierge -> RECEIVE avec sa génération */
+static HAL_StatusTypeDef ee_start_page(uint8_t page, uint32_t generation)
+{
+    if (ee_program(s_page_addr[page] + 4u, generation) != HAL_OK)
+        return HAL_ERROR;
+    return ee_program(s_page_addr[page], EE_STATE_RECEIVE);
+}
+
+/* Lit la page active jusqu'au premier emplacement vierge */
+static uint32_t ee_scan(uint8_t page, void (*on_record)(uint16_t id, uint32_t value))
+{
+    uint32_t i;
+
+    for (i = 0; i < FLASH_EE_CAPACITY; i++)
+    {
+        const volatile ee_rec_t *r = ee_rec(page, i);
+
+        if (ee_rec_blank(r))
+            break;
+
+        if (!ee_rec_valid(r))
+        {
+            s_crc_errors++;
+            continue;
+        }
+
+        if (on_record != NULL)
+            on_record((uint16_t)r->tag, r->value);
+    }
+    return i;
+}
+
+/* Page active pleine : dernière valeur de chaque id recopiée dans l'autre
+ * page. Parcours du plus récent au plus ancien, un id déjà recopié est
+ * sauté. L'ancienne page reste active (génération inférieure) jusqu'à son
+ * effacement au démarrage suivant.
+ */
+static HAL_StatusTypeDef ee_transfer(void)
+{
+    uint8_t  from = s_active;
+    uint8_t  to   = (uint8_t)(from ^ 1u);
+    uint32_t n = 0, i, j;
+
+    if (!ee_page_blank(to) && ee_erase(to) != HAL_OK)
+        return HAL_ERROR;
+
+    if (ee_start_page(to, s_generation + 1u) != HAL_OK)
+        return HAL_ERROR;
+
+    for (i = s_next; i-- > 0u; )
+    {
+        const volatile ee_rec_t *r = ee_rec(from, i);
+        uint16_t id = (uint16_t)r->tag;
+
+        if (!ee_rec_valid(r))
+            continue;
+
+        for (j = 0; j < n; j++)
+        {
+            if ((uint16_t)ee_rec(to, j)->tag == id)
+                break;
+        }
+        if (j < n)
+            continue;
+
+        /* Garde une place pour l'enregistrement qui a déclenché la recopie */
+        if (n + 1u >= FLASH_EE_CAPACITY)
+            return HAL_ERROR;
+
+        if (ee_write_rec(to, n, id, r->value) != HAL_OK)
+            return HAL_ERROR;
+        n++;
+    }
+
+    if (ee_program(s_page_addr[to], EE_STATE_ACTIVE) != HAL_OK)
+        return HAL_ERROR;
+
+    s_active = to;
+    s_generation++;
+    s_next = n;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef FlashEe_Init(void (*on_record)(uint16_t id, uint32_t value))
+{
+    HAL_StatusTypeDef st = HAL_OK;
+    uint32_t state0 = ee_hdr(0, 0);
+    uint32_t state1 = ee_hdr(1, 0);
+    uint8_t  spare;
+
+    s_ready      = 0;
+    s_crc_errors = 0;
+    ee_unlock();
+
+    if (state0 == EE_STATE_ACTIVE && state1 == EE_STATE_ACTIVE)
+    {
+        /* Recopie depuis le dernier démarrage : ancienne page pas encore
+         * effacée */
+        s_active = ee_newer(ee_hdr(1, 1), ee_hdr(0, 1)) ? 1u : 0u;
+    }
+    else if (state0 == EE_STATE_ACTIVE)
+    {
+        s_active = 0;
+    }
+    else if (state1 == EE_STATE_ACTIVE)
+    {
+        s_active = 1;
+    }
+    else
+    {
+        /* Premier démarrage : page 0 formatée, valeurs par défaut */
+        s_active = 0;
+        if (!ee_page_blank(0))
+            st = ee_erase(0);
+        if (st == HAL_OK)
+            st = ee_start_page(0, 0);
+        if (st == HAL_OK)
+            st = ee_program(s_page_addr[0], EE_STATE_ACTIVE);
+    }
+
+    if (st == HAL_OK)
+    {
+        s_generation = ee_hdr(s_active, 1);
+        s_next       = ee_scan(s_active, on_record);
+
+        /* Ancienne page, ou recopie interrompue : effacée maintenant pour
+         * qu'une recopie en fonctionnement n'ait pas à le faire
+         */
+        spare = (uint8_t)(s_active ^ 1u);
+        if (ee_hdr(spare, 0) != EE_STATE_ERASED || ee_hdr(spare, 1) != EE_BLANK)
+            st = ee_erase(spare);
+
+        s_ready = 1;
+    }
+
+    HAL_FLASH_Lock();
+    return st;
+}
+
+HAL_StatusTypeDef FlashEe_Write(uint16_t id, uint32_t value)
+{
+    HAL_StatusTypeDef st = HAL_OK;
+
+    if (!s_ready || id == FLASH_EE_ID_NONE)
+        return HAL_ERROR;
+
+    PERF_BEGIN(PERF_FLASH);
+    ee_unlock();
+
+    if (s_next >= FLASH_EE_CAPACITY)
+        st = ee_transfer();
+
+    if (st == HAL_OK)
+    {
+        st = ee_write_rec(s_active, s_next, id, value);
+        /* Emplacement consommé même en cas d'échec : il n'est plus vierge */
+        s_next++;
+    }
+
+    HAL_FLASH_Lock();
+    PERF_END(PERF_FLASH);
+    return st;
+}
+
+void FlashEe_GetStats(flash_ee_stats_t *st)
+{
+    st->page       = s_active;
+    st->generation = s_generation;
+    st->used       = s_next;
+    st->capacity   = FLASH_EE_CAPACITY;
+    st->crc_errors = s_crc_errors;
+    st->erases     = s_erases;
+}
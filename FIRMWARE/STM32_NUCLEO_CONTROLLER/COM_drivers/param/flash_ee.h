@@ -0,0 +1,77 @@
+/*
+ * flash_ee.h
+ *
+ *  Created on: Feb 4, 2026
+ *      Author: penel
+ */
+
+#ifndef FLASH_EE_H_
+#define FLASH_EE_H_
+
+#include "main.h"
+#include <stdint.h>
+
+/*
+ * EEPROM émulée dans les secteurs 6 et 7 de la flash (2 x 128 Ko, retirés
+ * de la région FLASH du linker : STM32F446RETX_FLASH.ld).
+ *
+ * Un secteur (page) est actif, l'autre en réserve. Page :
+ *
+ *   en-tête (8 octets) : état | génération
+ *   enregistrements (8 octets) : valeur | id (16 bits) | crc16 (16 bits)
+ *
+ *  - écriture en journal : chaque mise à jour ajoute un enregistrement à
+ *    la suite, le dernier d'un id fait foi ; la valeur est programmée
+ *    avant le mot id/crc (coupure pendant l'écriture -> CRC faux, ignoré)
+ *  - page pleine : la dernière valeur de chaque id est recopiée dans la
+ *    page de réserve, qui devient active (génération + 1) ; les deux
+ *    secteurs sont effacés à tour de rôle (usure répartie)
+ *  - démarrage : seule la page active est lue, jusqu'au premier
+ *    emplacement vierge ; l'ancienne page est effacée à ce moment-là
+ *    (HAL_FLASHEx_Erase bloque ~1 à 2 s, pendant lesquelles le code en
+ *    flash est gelé). Un effacement en cours de fonctionnement n'a lieu
+ *    que si la page active se remplit avant le redémarrage suivant.
+ *
+ * Coupure pendant une recopie : la page active d'origine reste valide
+ * (la réserve n'est marquée active qu'une fois complète) ; deux pages
+ * actives -> la génération la plus récente l'emporte.
+ */
+
+#define FLASH_EE_PAGE_SIZE      (128u * 1024u)
+#define FLASH_EE_PAGE0_ADDR     0x08040000u       /* secteur 6 */
+#define FLASH_EE_PAGE1_ADDR     0x08060000u       /* secteur 7 */
+#define FLASH_EE_PAGE0_SECTOR   FLASH_SECTOR_6
+#define FLASH_EE_PAGE1_SECTOR   FLASH_SECTOR_7
+
+#define FLASH_EE_REC_SIZE       8u
+#define FLASH_EE_CAPACITY       (FLASH_EE_PAGE_SIZE / FLASH_EE_REC_SIZE - 1u)
+
+/* Id réservé : emplacement vierge */
+#define FLASH_EE_ID_NONE        0xFFFFu
+
+typedef struct
+{
+    uint8_t  page;          /* page active (0 : secteur 6, 1 : secteur 7) */
+    uint32_t generation;    /* recopies depuis le formatage */
+    uint32_t used;          /* enregistrements dans la page active */
+    uint32_t capacity;      /* FLASH_EE_CAPACITY */
+    uint32_t crc_errors;    /* enregistrements rejetés au chargement */
+    uint32_t erases;        /* secteurs effacés depuis le démarrage */
+} flash_ee_stats_t;
+
+/**
+ * @brief Retrouve la page active (formate si aucune) et appelle
+ *        `on_record` pour chaque enregistrement valide, dans l'ordre
+ *        d'écriture (le dernier d'un id fait foi).
+ */
+HAL_StatusTypeDef FlashEe_Init(void (*on_record)(uint16_t id, uint32_t value));
+
+/**
+ * @brief Ajoute un enregistrement (recopie dans l'autre page si la page
+ *        active est pleine). Contexte tâche uniquement.
+ */
+HAL_StatusTypeDef FlashEe_Write(uint16_t id, uint32_t value);
+
+void FlashEe_GetStats(flash_ee_stats_t *st);
+
+#endif /* FLASH_EE_H_ */
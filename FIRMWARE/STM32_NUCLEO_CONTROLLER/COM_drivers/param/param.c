@@ -0,0 +1,137 @@
+/*
+ * param.c
+ *
+ *  Created on: Feb 4, 2026
+ *      Author: penel
+ */
+
+#include "param.h"
+#include "flash_ee.h"
+#include "../rpi/rpi_protocol.h"
+#include "../rpi/rpi_modbus.h"
+#include "../valve/valve_control.h"
+#include "../log/log.h"
+#include <string.h>
+#include <stdlib.h>
+
+/* Ordre de param_id_t ; `key` fixé une fois pour toutes */
+static const param_def_t s_params[PARAM_COUNT] =
+{
+    [PARAM_K_CENTI]  = { 0x0001u, "K",        PARAM_TYPE_I32, 0,     100000,
+                         500,                          "coefficient K x100" },
+    [PARAM_CTRL_REF] = { 0x0002u, "CTRL_REF", PARAM_TYPE_I32, -4000, 12500,
+                         VALVE_T_REF_CENTI,            "consigne vanne (0.01 C)" },
+    [PARAM_NODE]     = { 0x0003u, "NODE",     PARAM_TYPE_U32, 0,     RPI_NODE_BROADCAST - 1,
+                         RPI_NODE_DEFAULT,             "adresse RS-485 (0: point a point)" },
+    [PARAM_MB_ADDR]  = { 0x0004u, "MB_ADDR",  PARAM_TYPE_U32, 1,     RPI_MB_ADDR_MAX,
+                         RPI_MB_ADDR_DEFAULT,          "adresse esclave Modbus" },
+};
+
+static uint32_t s_value[PARAM_COUNT];
+
+/* Enregistrement lu au démarrage : id inconnu ou valeur hors plage ignorés */
+static void Param_OnRecord(uint16_t key, uint32_t value)
+{
+    uint32_t i;
+
+    for (i = 0; i < PARAM_COUNT; i++)
+    {
+        if (s_params[i].key == key)
+        {
+            if (Param_InRange((param_id_t)i, value))
+                s_value[i] = value;
+            return;
+        }
+    }
+}
+
+HAL_StatusTypeDef Param_Init(void)
+{
+    HAL_StatusTypeDef st;
+    uint32_t i;
+
+    for (i = 0; i < PARAM_COUNT; i++)
+        s_value[i] = (uint32_t)s_params[i].def;
+
+    st = FlashEe_Init(Param_OnRecord);
+    if (st != HAL_OK)
+        LOG_E(LOG_MOD_PARAM, "Erreur EEPROM emulee : parametres par defaut");
+
+    return st;
+}
+
+const param_def_t *Param_Def(param_id_t p)
+{
+    return (p < PARAM_COUNT) ? &s_params[p] : NULL;
+}
+
+param_id_t Param_Find(const char *name, size_t len)
+{
+    uint32_t i;
+
+    for (i = 0; i < PARAM_COUNT; i++)
+    {
+        if (strlen(s_params[i].name) == len && strncmp(s_params[i].name, name, len) == 0)
+            return (param_id_t)i;
+    }
+    return PARAM_COUNT;
+}
+
+uint32_t Param_Get(param_id_t p)
+{
+    return (p < PARAM_COUNT) ? s_value[p] : 0u;
+}
+
+uint8_t Param_InRange(param_id_t p, uint32_t v)
+{
+    const param_def_t *d;
+
+    if (p >= PARAM_COUNT)
+        return 0;
+
+    d = &s_params[p];
+    if (d->type == PARAM_TYPE_I32)
+        return ((int32_t)v >= d->min) && ((int32_t)v <= d->max);
+
+    return (v >= (uint32_t)d->min) && (v <= (uint32_t)d->max);
+}
+
+HAL_StatusTypeDef Param_Parse(param_id_t p, const char *txt, uint32_t *v)
+{
+    char *end;
+
+    if (p >= PARAM_COUNT || txt[0] == '\0')
+        return HAL_ERROR;
+
+    if (s_params[p].type == PARAM_TYPE_I32)
+    {
+        long l = strtol(txt, &end, 10);
+
+        if (l != (long)(int32_t)l)
+            return HAL_ERROR;
+        *v = (uint32_t)(int32_t)l;
+    }
+    else
+    {
+        if (txt[0] == '-')
+            return HAL_ERROR;
+        *v = (uint32_t)strtoul(txt, &end, 10);
+    }
+
+    if (*end != '\0' || !Param_InRange(p, *v))
+        return HAL_ERROR;
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef Param_Set(param_id_t p, uint32_t v)
+{
+    if (!Param_InRange(p, v))
+        return HAL_ERROR;
+
+    if (s_value[p] == v)
+        return HAL_OK;
+
+    s_value[p] = v;
+    return FlashEe_Write(s_params[p].key, v);
+}
@@ -0,0 +1,88 @@
+/*
+ * param.h
+ *
+ *  Created on: Feb 4, 2026
+ *      Author: penel
+ */
+
+#ifndef PARAM_H_
+#define PARAM_H_
+
+#include "main.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Paramètres persistants (réglages conservés après un reset), enregistrés
+ * dans l'EEPROM émulée (flash_ee.h).
+ *
+ * Chaque paramètre a un id stocké en flash (à ne jamais réutiliser pour un
+ * autre sens), un type, une plage et une valeur par défaut. Au démarrage,
+ * une valeur absente ou hors plage est remplacée par la valeur par défaut.
+ * Une écriture n'ajoute un enregistrement que si la valeur change.
+ *
+ * Protocole ASCII : PAR_LIST, PAR_GET=<nom>, PAR_SET=<nom>,<valeur>
+ * (SET_K, NODE=, MODE=MODBUS,<adr> et les registres Modbus passent aussi
+ * par ici).
+ */
+
+typedef enum
+{
+    PARAM_K_CENTI = 0,      /* coefficient K x100 */
+    PARAM_CTRL_REF,         /* consigne de température, 0.01 °C */
+    PARAM_NODE,             /* adresse RS-485 (RPI_NODE_NONE : point à point) */
+    PARAM_MB_ADDR,          /* adresse d'esclave Modbus */
+    PARAM_COUNT
+} param_id_t;
+
+typedef enum
+{
+    PARAM_TYPE_I32 = 0,
+    PARAM_TYPE_U32 = 1
+} param_type_t;
+
+typedef struct
+{
+    uint16_t     key;       /* id en flash */
+    const char  *name;
+    param_type_t type;
+    int32_t      min;       /* bornes et défaut : uint32_t pour PARAM_TYPE_U32 */
+    int32_t      max;
+    int32_t      def;
+    const char  *help;
+} param_def_t;
+
+/**
+ * @brief Charge les valeurs enregistrées (page active de l'EEPROM émulée).
+ *        À appeler avant les modules qui lisent leurs réglages.
+ */
+HAL_StatusTypeDef Param_Init(void);
+
+const param_def_t *Param_Def(param_id_t p);
+
+/**
+ * @brief Paramètre de nom `name` (`len` caractères), PARAM_COUNT si
+ *        inconnu.
+ */
+param_id_t Param_Find(const char *name, size_t len);
+
+uint32_t Param_Get(param_id_t p);
+
+/**
+ * @brief Valeur dans la plage de `p`.
+ */
+uint8_t Param_InRange(param_id_t p, uint32_t v);
+
+/**
+ * @brief Texte décimal -> valeur (type et plage vérifiés).
+ */
+HAL_StatusTypeDef Param_Parse(param_id_t p, const char *txt, uint32_t *v);
+
+/**
+ * @brief Change et enregistre la valeur. HAL_ERROR si hors plage (rien
+ *        n'est modifié) ou si l'écriture flash échoue (valeur appliquée
+ *        jusqu'au prochain reset).
+ */
+HAL_StatusTypeDef Param_Set(param_id_t p, uint32_t v);
+
+#endif /* PARAM_H_ */
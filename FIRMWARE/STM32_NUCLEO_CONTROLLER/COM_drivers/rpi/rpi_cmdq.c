@@ -0,0 +1,87 @@
+/*
+ * rpi_cmdq.c
+ *
+ *  Created on: Jan 28, 2026
+ *      Author: penel
+ */
+
+#include "rpi_cmdq.h"
+#include "main.h"
+
+/* head : avancé par le producteur uniquement, tail : par le consommateur.
+ * Indices libres (modulo 256), la case est indice % RPI_CMDQ_DEPTH.
+ */
+static rpi_cmd_t s_slots[RPI_CMDQ_DEPTH];
+static volatile uint8_t s_head = 0;
+static volatile uint8_t s_tail = 0;
+
+static uint8_t  s_max_used  = 0;
+static uint32_t s_overflows = 0;
+static uint32_t s_too_long  = 0;
+
+void RpiCmdQ_Reset(void)
+{
+    s_head      = 0;
+    s_tail      = 0;
+    s_max_used  = 0;
+    s_overflows = 0;
+    s_too_long  = 0;
+}
+
+rpi_cmd_t *RpiCmdQ_WriteSlot(void)
+{
+    if ((uint8_t)(s_head - s_tail) >= RPI_CMDQ_DEPTH)
+        return NULL;
+
+    return &s_slots[s_head % RPI_CMDQ_DEPTH];
+}
+
+void RpiCmdQ_Commit(void)
+{
+    uint8_t used;
+
+    /* Contenu de la case écrit avant de la publier */
+    __DMB();
+    s_head = (uint8_t)(s_head + 1u);
+
+    used = (uint8_t)(s_head - s_tail);
+    if (used > s_max_used)
+        s_max_used = used;
+}
+
+void RpiCmdQ_CountOverflow(void)
+{
+    s_overflows++;
+}
+
+void RpiCmdQ_CountTooLong(void)
+{
+    s_too_long++;
+}
+
+const rpi_cmd_t *RpiCmdQ_Peek(void)
+{
+    if (s_head == s_tail)
+        return NULL;
+
+    __DMB();
+    return &s_slots[s_tail % RPI_CMDQ_DEPTH];
+}
+
+void RpiCmdQ_Pop(void)
+{
+    if (s_head == s_tail)
+        return;
+
+    /* Case entièrement lue avant de la rendre au producteur */
+    __DMB();
+    s_tail = (uint8_t)(s_tail + 1u);
+}
+
+void RpiCmdQ_GetStats(rpi_cmdq_stats_t *st)
+{
+    st->depth     = RPI_CMDQ_DEPTH;
+    st->max_used  = s_max_used;
+    st->overflows = s_overflows;
+    st->too_long  = s_too_long;
+}
@@ -0,0 +1,74 @@
+/*
+ * rpi_cmdq.h
+ *
+ *  Created on: Jan 28, 2026
+ *      Author: penel
+ */
+
+#ifndef RPI_CMDQ_H_
+#define RPI_CMDQ_H_
+
+#include <stdint.h>
+#include "rpi_frame.h"
+
+/* File de commandes complètes, remplie en interruption (réception UART)
+ * et vidée dans la boucle principale : un seul producteur, un seul
+ * consommateur, sans verrou.
+ */
+#define RPI_CMDQ_DEPTH     8u                  /* puissance de 2 */
+#define RPI_CMDQ_SLOT_LEN  RPI_FRAME_ENC_MAX   /* ligne ASCII (+ '\0'), trame COBS ou RTU */
+
+typedef enum
+{
+    RPI_CMD_ASCII  = 0,                 /* ligne terminée par '\0' */
+    RPI_CMD_FRAME  = 1,                 /* trame COBS sans délimiteur (rpi_frame.h) */
+    RPI_CMD_MODBUS = 2                  /* trame RTU, CRC compris (rpi_modbus.h) */
+} rpi_cmd_kind_t;
+
+typedef struct
+{
+    uint8_t len;                        /* octets utiles */
+    uint8_t kind;                       /* rpi_cmd_kind_t */
+    uint8_t broadcast;                  /* adresse de diffusion : pas de réponse */
+    uint32_t rx_us;                     /* timebase.h (32 bits bas) à la réception */
+    uint8_t data[RPI_CMDQ_SLOT_LEN];
+} rpi_cmd_t;
+
+typedef struct
+{
+    uint8_t  depth;
+    uint8_t  max_used;    /* remplissage maximal observé */
+    uint32_t overflows;   /* commandes perdues : file pleine */
+    uint32_t too_long;    /* commandes perdues : plus longues qu'une case */
+} rpi_cmdq_stats_t;
+
+void RpiCmdQ_Reset(void);
+
+/* --- Producteur (interruption) --- */
+
+/**
+ * @brief Case en cours d'écriture, NULL si la file est pleine.
+ *        La case n'est visible du consommateur qu'après RpiCmdQ_Commit().
+ */
+rpi_cmd_t *RpiCmdQ_WriteSlot(void);
+
+void RpiCmdQ_Commit(void);
+
+void RpiCmdQ_CountOverflow(void);
+void RpiCmdQ_CountTooLong(void);
+
+/* --- Consommateur (boucle principale) --- */
+
+/**
+ * @brief Plus ancienne commande non traitée, NULL si la file est vide.
+ */
+const rpi_cmd_t *RpiCmdQ_Peek(void);
+
+/**
+ * @brief Libère la commande retournée par RpiCmdQ_Peek().
+ */
+void RpiCmdQ_Pop(void);
+
+void RpiCmdQ_GetStats(rpi_cmdq_stats_t *st);
+
+#endif /* RPI_CMDQ_H_ */
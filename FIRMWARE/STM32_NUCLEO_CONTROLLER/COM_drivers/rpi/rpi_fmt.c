@@ -0,0 +1,129 @@
+/*
+ * rpi_fmt.c
+ *
+ *  Created on: Jan 27, 2026
+ *      Author: penel
+ */
+
+#include "rpi_fmt.h"
+
+/* 10 chiffres (uint32) + zéros de tête demandés */
+#define FMT_DIGITS_MAX  20u
+
+/* --------------------------------------------------------------------------
+ * Fonctions internes
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Ecrit u en décimal sur au moins min_digits chiffres, avec un '.'
+ *        avant les `decimals` derniers.
+ *        u / 10 est compilé en multiplication (UMULL) sur Cortex-M4.
+ */
+static void fmt_digits(rpi_fmt_t *f, uint32_t u, uint8_t min_digits, uint8_t decimals)
+{
+    char d[FMT_DIGITS_MAX];
+    uint8_t n = 0;
+
+    if (min_digits > FMT_DIGITS_MAX)
+        min_digits = FMT_DIGITS_MAX;
+
+    do
+    {
+        d[n++] = (char)('0' + (u % 10u));
+        u /= 10u;
+    } while ((u != 0u || n < min_digits) && n < FMT_DIGITS_MAX);
+
+    while (n > 0u)
+    {
+        if (n == decimals)
+            RpiFmt_Char(f, '.');
+        RpiFmt_Char(f, d[--n]);
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * API
+ * -------------------------------------------------------------------------- */
+
+void RpiFmt_Init(rpi_fmt_t *f, char *buf, uint16_t size)
+{
+    f->buf       = buf;
+    f->size      = size;
+    f->len       = 0;
+    f->truncated = 0;
+}
+
+void RpiFmt_Char(rpi_fmt_t *f, char c)
+{
+    if (f->len < f->size)
+        f->buf[f->len++] = c;
+    else
+        f->truncated = 1;
+}
+
+void RpiFmt_Str(rpi_fmt_t *f, const char *s)
+{
+    while (*s != '\0')
+        RpiFmt_Char(f, *s++);
+}
+
+void RpiFmt_U32(rpi_fmt_t *f, uint32_t v)
+{
+    fmt_digits(f, v, 1, 0);
+}
+
+void RpiFmt_I32(rpi_fmt_t *f, int32_t v)
+{
+    RpiFmt_Fixed(f, v, 0, 1, 0);
+}
+
+/* Tranches de 9 chiffres : une division 64 bits par tranche */
+void RpiFmt_U64(rpi_fmt_t *f, uint64_t v)
+{
+    uint64_t hi;
+
+    if (v <= 0xFFFFFFFFu)
+    {
+        fmt_digits(f, (uint32_t)v, 1, 0);
+        return;
+    }
+
+    hi = v / 1000000000u;
+    RpiFmt_U64(f, hi);
+    fmt_digits(f, (uint32_t)(v - hi * 1000000000u), 9, 0);
+}
+
+void RpiFmt_Fixed(rpi_fmt_t *f, int32_t v, uint8_t decimals,
+                  uint8_t int_width, uint8_t flags)
+{
+    uint32_t u;
+
+    if (v < 0)
+    {
+        RpiFmt_Char(f, '-');
+        u = 0u - (uint32_t)v;   /* correct aussi pour INT32_MIN */
+    }
+    else
+    {
+        if (flags & RPI_FMT_PLUS)
+            RpiFmt_Char(f, '+');
+        u = (uint32_t)v;
+    }
+
+    if (decimals > 9u)
+        decimals = 9u;
+    if (int_width == 0u)
+        int_width = 1u;
+
+    fmt_digits(f, u, (uint8_t)(int_width + decimals), decimals);
+}
+
+void RpiFmt_Hex16(rpi_fmt_t *f, uint16_t v)
+{
+    static const char hex[] = "0123456789ABCDEF";
+
+    RpiFmt_Char(f, hex[(v >> 12) & 0xFu]);
+    RpiFmt_Char(f, hex[(v >> 8)  & 0xFu]);
+    RpiFmt_Char(f, hex[(v >> 4)  & 0xFu]);
+    RpiFmt_Char(f, hex[v & 0xFu]);
+}
@@ -0,0 +1,60 @@
+/*
+ * rpi_fmt.h
+ *
+ *  Created on: Jan 27, 2026
+ *      Author: penel
+ */
+
+#ifndef RPI_FMT_H_
+#define RPI_FMT_H_
+
+#include <stdint.h>
+
+/*
+ * Formatage entier / virgule fixe des réponses du protocole, sans printf :
+ * les chiffres sont écrits directement dans le buffer d'émission.
+ *
+ *   rpi_fmt_t f;
+ *   RpiFmt_Init(&f, tx, sizeof(tx));
+ *   RpiFmt_Str(&f, "T=");
+ *   RpiFmt_Fixed(&f, 2345, 2, 2, RPI_FMT_PLUS);   -> "T=+23.45"
+ *
+ * Si le buffer est plein, la suite est ignorée et `truncated` passe à 1.
+ */
+
+#define RPI_FMT_PLUS   0x01u   /* '+' devant les valeurs positives ou nulles */
+
+typedef struct
+{
+    char     *buf;
+    uint16_t  size;        /* capacité (octets) */
+    uint16_t  len;         /* octets écrits */
+    uint8_t   truncated;
+} rpi_fmt_t;
+
+void RpiFmt_Init(rpi_fmt_t *f, char *buf, uint16_t size);
+
+void RpiFmt_Char(rpi_fmt_t *f, char c);
+void RpiFmt_Str(rpi_fmt_t *f, const char *s);
+
+/* Décimal sans zéros de tête */
+void RpiFmt_U32(rpi_fmt_t *f, uint32_t v);
+void RpiFmt_I32(rpi_fmt_t *f, int32_t v);
+void RpiFmt_U64(rpi_fmt_t *f, uint64_t v);
+
+/**
+ * @brief Entier signé à virgule implicite : v / 10^decimals.
+ *
+ * @param decimals   chiffres après la virgule (0..9), pas de '.' si 0
+ * @param int_width  chiffres minimum de la partie entière (zéros de tête)
+ * @param flags      RPI_FMT_PLUS
+ *
+ * ex: (-5, 3, 1, 0) -> "-0.005" ; (705, 2, 2, RPI_FMT_PLUS) -> "+07.05"
+ */
+void RpiFmt_Fixed(rpi_fmt_t *f, int32_t v, uint8_t decimals,
+                  uint8_t int_width, uint8_t flags);
+
+/* 4 chiffres hexadécimaux majuscules */
+void RpiFmt_Hex16(rpi_fmt_t *f, uint16_t v);
+
+#endif /* RPI_FMT_H_ */
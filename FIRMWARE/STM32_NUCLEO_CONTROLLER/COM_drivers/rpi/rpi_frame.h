@@ -0,0 +1,61 @@
+/*
+ * rpi_frame.h
+ *
+ *  Created on: Jan 23, 2026
+ *      Author: penel
+ */
+
+#ifndef RPI_FRAME_H_
+#define RPI_FRAME_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Trame binaire du lien Raspberry Pi :
+ *
+ *   COBS( id | len | payload[len] | crc16_lo | crc16_hi )  0x00
+ *
+ *  - id      : identifiant de commande (RPI_BIN_CMD_*), | 0x80 pour une erreur
+ *  - len     : taille du payload (0..RPI_FRAME_PAYLOAD_MAX)
+ *  - payload : entiers little-endian
+ *  - crc16   : CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) sur id, len, payload
+ *
+ * Le codage COBS garantit qu'aucun 0x00 n'apparaît dans la trame :
+ * 0x00 sert uniquement de délimiteur, la resynchronisation est immédiate.
+ */
+
+#define RPI_FRAME_PAYLOAD_MAX   48u
+#define RPI_FRAME_RAW_MAX       (2u + RPI_FRAME_PAYLOAD_MAX + 2u)
+/* COBS : 1 octet de surcharge par bloc de 254 octets, + délimiteur */
+#define RPI_FRAME_ENC_MAX       (RPI_FRAME_RAW_MAX + RPI_FRAME_RAW_MAX / 254u + 2u)
+
+#define RPI_FRAME_ERR_FLAG      0x80u
+
+/**
+ * @brief CRC-16/CCITT-FALSE (table 256 entrées en flash).
+ */
+uint16_t RpiFrame_Crc16(const uint8_t *data, size_t len);
+
+/**
+ * @brief Construit une trame complète (COBS + délimiteur 0x00).
+ *
+ * @param out  Buffer de sortie, au moins RPI_FRAME_ENC_MAX octets.
+ * @return nombre d'octets à émettre, 0 si payload trop long.
+ */
+size_t RpiFrame_Encode(uint8_t id, const uint8_t *payload, uint8_t len, uint8_t *out);
+
+/**
+ * @brief Décode une trame reçue (sans le délimiteur 0x00).
+ *
+ * @param in       Octets COBS reçus
+ * @param in_len   Nombre d'octets
+ * @param id       Identifiant de commande
+ * @param payload  Buffer d'au moins RPI_FRAME_PAYLOAD_MAX octets
+ * @param len      Taille du payload
+ * @return 0 si OK, -1 si COBS / longueur / CRC invalide.
+ */
+int RpiFrame_Decode(const uint8_t *in, size_t in_len,
+                    uint8_t *id, uint8_t *payload, uint8_t *len);
+
+#endif /* RPI_FRAME_H_ */
@@ -0,0 +1,361 @@
+/*
+ * rpi_modbus.c
+ *
+ *  Created on: Jan 30, 2026
+ *      Author: penel
+ */
+
+#include "rpi_modbus.h"
+
+/* Au-delà de 19200 bauds, la norme fixe t3.5 à 1750 µs */
+#define MB_T35_FAST_US      1750u
+#define MB_FAST_BAUD        19200u
+#define MB_BITS_PER_CHAR    11u
+
+static const uint16_t s_crc16_table[256] =
+{
+    0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
+    0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
+    0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+    0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
+    0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
+    0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+    0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
+    0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
+    0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+    0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
+    0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
+    0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+    0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
+    0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
+    0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+    0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
+    0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
+    0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+    0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
+    0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
+    0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+    0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
+    0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
+    0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+    0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
+    0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
+    0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+    0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
+    0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
+    0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+    0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
+    0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
+};
+
+static const rpi_mb_map_t *s_map = NULL;
+static void (*s_on_frame_end)(void) = NULL;
+
+static uint8_t  s_addr     = RPI_MB_ADDR_DEFAULT;
+static volatile uint8_t s_timer_on = 0;
+
+static rpi_mb_stats_t s_stats;
+
+/* --------------------------------------------------------------------------
+ * Fonctions internes
+ * -------------------------------------------------------------------------- */
+
+static uint16_t mb_get16(const uint8_t *p)
+{
+    return (uint16_t)(((uint16_t)p[0] << 8) | p[1]);
+}
+
+static void mb_put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)(v & 0xFFu);
+}
+
+/* Horloge des timers APB1 : doublée dès que APB1 est divisé (RM0390 §6.2) */
+static uint32_t mb_timer_clock(void)
+{
+    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1)
+        return 2u * pclk1;
+    return pclk1;
+}
+
+/**
+ * @brief Délai TIM7 (µs) entre un bloc reçu et la fin de trame.
+ *        Les blocs arrivent sur ligne IDLE, soit un caractère après le
+ *        dernier octet : ce caractère est retiré de t3.5.
+ */
+static uint32_t mb_silence_us(uint32_t baud)
+{
+    uint32_t char_us = (MB_BITS_PER_CHAR * 1000000u + baud - 1u) / baud;
+    uint32_t t35_us;
+
+    if (baud > MB_FAST_BAUD)
+        t35_us = MB_T35_FAST_US;
+    else
+        t35_us = (7u * char_us + 1u) / 2u;
+
+    return t35_us - char_us;
+}
+
+/* Lecture d'un bloc : 0x03 / 0x04, requête = adresse, quantité */
+static rpi_mb_ex_t mb_read(rpi_mb_table_t table, const uint8_t *pdu, uint16_t pdu_len,
+                           uint8_t *data, uint16_t data_size, uint16_t *data_len)
+{
+    uint16_t regs[RPI_MB_READ_MAX];
+    uint16_t start, count, i;
+    rpi_mb_ex_t ex;
+
+    if (pdu_len != 4u)
+        return RPI_MB_EX_VALUE;
+
+    start = mb_get16(&pdu[0]);
+    count = mb_get16(&pdu[2]);
+    if (count == 0u || count > RPI_MB_READ_MAX || 1u + 2u * count > data_size)
+        return RPI_MB_EX_VALUE;
+    if ((uint32_t)start + count > 0x10000u)
+        return RPI_MB_EX_ADDRESS;
+
+    ex = s_map->read(table, start, count, regs);
+    if (ex != RPI_MB_EX_NONE)
+        return ex;
+
+    data[0] = (uint8_t)(2u * count);
+    for (i = 0; i < count; i++)
+        mb_put16(&data[1u + 2u * i], regs[i]);
+    *data_len = (uint16_t)(1u + 2u * count);
+    return RPI_MB_EX_NONE;
+}
+
+/* Ecriture d'un registre : 0x06, réponse = écho de la requête */
+static rpi_mb_ex_t mb_write_single(const uint8_t *pdu, uint16_t pdu_len,
+                                   uint8_t *data, uint16_t *data_len)
+{
+    uint16_t val;
+    rpi_mb_ex_t ex;
+
+    if (pdu_len != 4u)
+        return RPI_MB_EX_VALUE;
+
+    val = mb_get16(&pdu[2]);
+    ex  = s_map->write(mb_get16(&pdu[0]), 1, &val);
+    if (ex != RPI_MB_EX_NONE)
+        return ex;
+
+    data[0] = pdu[0]; data[1] = pdu[1];
+    data[2] = pdu[2]; data[3] = pdu[3];
+    *data_len = 4;
+    return RPI_MB_EX_NONE;
+}
+
+/* Ecriture d'un bloc : 0x10, requête = adresse, quantité, octets, valeurs */
+static rpi_mb_ex_t mb_write_multi(const uint8_t *pdu, uint16_t pdu_len,
+                                  uint8_t *data, uint16_t *data_len)
+{
+    uint16_t regs[RPI_MB_WRITE_MAX];
+    uint16_t start, count, i;
+    rpi_mb_ex_t ex;
+
+    if (pdu_len < 5u)
+        return RPI_MB_EX_VALUE;
+
+    start = mb_get16(&pdu[0]);
+    count = mb_get16(&pdu[2]);
+    if (count == 0u || count > RPI_MB_WRITE_MAX ||
+        pdu[4] != 2u * count || pdu_len != 5u + 2u * count)
+        return RPI_MB_EX_VALUE;
+    if ((uint32_t)start + count > 0x10000u)
+        return RPI_MB_EX_ADDRESS;
+
+    for (i = 0; i < count; i++)
+        regs[i] = mb_get16(&pdu[5u + 2u * i]);
+
+    ex = s_map->write(start, count, regs);
+    if (ex != RPI_MB_EX_NONE)
+        return ex;
+
+    mb_put16(&data[0], start);
+    mb_put16(&data[2], count);
+    *data_len = 4;
+    return RPI_MB_EX_NONE;
+}
+
+/* --------------------------------------------------------------------------
+ * API
+ * -------------------------------------------------------------------------- */
+
+uint16_t RpiModbus_Crc16(const uint8_t *data, uint16_t len)
+{
+    uint16_t crc = 0xFFFFu;
+
+    while (len--)
+        crc = (uint16_t)((crc >> 8) ^ s_crc16_table[(crc ^ *data++) & 0xFFu]);
+
+    return crc;
+}
+
+void RpiModbus_Init(const rpi_mb_map_t *map, void (*on_frame_end)(void))
+{
+    s_map          = map;
+    s_on_frame_end = on_frame_end;
+    s_stats.frames     = 0;
+    s_stats.crc_errors = 0;
+    s_stats.exceptions = 0;
+}
+
+HAL_StatusTypeDef RpiModbus_TimerStart(uint32_t baud)
+{
+    uint32_t us;
+
+    if (baud == 0u)
+        return HAL_ERROR;
+
+    us = mb_silence_us(baud);
+    if (us == 0u || us > 0x10000u)
+        return HAL_ERROR;
+
+    /* TIM7 (timer de base) one-shot à 1 MHz : pas de périphérique CubeMX,
+     * configuré directement par registres.
+     * URS : seul le débordement lève UIF, pas le chargement par UG.
+     */
+    __HAL_RCC_TIM7_CLK_ENABLE();
+    TIM7->CR1  = TIM_CR1_OPM | TIM_CR1_URS;
+    TIM7->PSC  = (uint16_t)(mb_timer_clock() / 1000000u - 1u);
+    TIM7->ARR  = (uint16_t)(us - 1u);
+    TIM7->EGR  = TIM_EGR_UG;
+    TIM7->SR   = 0;
+    TIM7->DIER = TIM_DIER_UIE;
+
+    /* Même priorité que la réception UART1 : pas de préemption mutuelle */
+    HAL_NVIC_SetPriority(TIM7_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(TIM7_IRQn);
+
+    s_timer_on = 1;
+    return HAL_OK;
+}
+
+void RpiModbus_TimerStop(void)
+{
+    s_timer_on = 0;
+    HAL_NVIC_DisableIRQ(TIM7_IRQn);
+    TIM7->CR1 &= ~TIM_CR1_CEN;
+    TIM7->DIER = 0;
+    TIM7->SR   = 0;
+}
+
+void RpiModbus_OnRxActivity(void)
+{
+    if (!s_timer_on)
+        return;
+
+    TIM7->CR1 &= ~TIM_CR1_CEN;
+    TIM7->CNT  = 0;
+    TIM7->CR1 |= TIM_CR1_CEN;
+}
+
+void RpiModbus_OnRxBusy(void)
+{
+    if (!s_timer_on)
+        return;
+
+    TIM7->CR1 &= ~TIM_CR1_CEN;
+}
+
+void RpiModbus_IRQHandler(void)
+{
+    if ((TIM7->SR & TIM_SR_UIF) == 0u)
+        return;
+
+    TIM7->SR = (uint16_t)~TIM_SR_UIF;
+    if (s_on_frame_end != NULL)
+        s_on_frame_end();
+}
+
+uint16_t RpiModbus_Handle(const uint8_t *req, uint16_t len,
+                          uint8_t *rsp, uint16_t rsp_size)
+{
+    const uint8_t *pdu;
+    uint16_t pdu_len, data_len = 0, crc;
+    uint8_t addr, fc;
+    rpi_mb_ex_t ex;
+
+    if (s_map == NULL || rsp_size < 8u)
+        return 0;
+
+    if (len < 4u || RpiModbus_Crc16(req, (uint16_t)(len - 2u)) !=
+                    (uint16_t)(req[len - 2u] | ((uint16_t)req[len - 1u] << 8)))
+    {
+        s_stats.crc_errors++;
+        return 0;
+    }
+
+    /* Adresse relevée avant traitement : une écriture du registre
+     * d'adresse prend effet à la requête suivante.
+     */
+    addr = s_addr;
+    if (req[0] != 0u && req[0] != addr)
+        return 0;
+
+    s_stats.frames++;
+    fc      = req[1];
+    pdu     = &req[2];
+    pdu_len = (uint16_t)(len - 4u);
+
+    switch (fc)
+    {
+    case RPI_MB_FC_READ_HOLDING:
+    case RPI_MB_FC_READ_INPUT:
+        if (req[0] == 0u)
+            return 0;   /* lecture en diffusion : ignorée */
+        ex = mb_read((fc == RPI_MB_FC_READ_INPUT) ? RPI_MB_INPUT : RPI_MB_HOLDING,
+                     pdu, pdu_len, &rsp[2], (uint16_t)(rsp_size - 4u), &data_len);
+        break;
+    case RPI_MB_FC_WRITE_SINGLE:
+        ex = mb_write_single(pdu, pdu_len, &rsp[2], &data_len);
+        break;
+    case RPI_MB_FC_WRITE_MULTI:
+        ex = mb_write_multi(pdu, pdu_len, &rsp[2], &data_len);
+        break;
+    default:
+        ex = RPI_MB_EX_FUNCTION;
+        break;
+    }
+
+    if (req[0] == 0u)
+        return 0;
+
+    rsp[0] = addr;
+    rsp[1] = fc;
+    if (ex != RPI_MB_EX_NONE)
+    {
+        s_stats.exceptions++;
+        rsp[1]   = (uint8_t)(fc | 0x80u);
+        rsp[2]   = (uint8_t)ex;
+        data_len = 1;
+    }
+
+    crc = RpiModbus_Crc16(rsp, (uint16_t)(2u + data_len));
+    rsp[2u + data_len] = (uint8_t)(crc & 0xFFu);
+    rsp[3u + data_len] = (uint8_t)(crc >> 8);
+    return (uint16_t)(4u + data_len);
+}
+
+HAL_StatusTypeDef RpiModbus_SetAddress(uint8_t addr)
+{
+    if (addr == 0u || addr > RPI_MB_ADDR_MAX)
+        return HAL_ERROR;
+
+    s_addr = addr;
+    return HAL_OK;
+}
+
+uint8_t RpiModbus_GetAddress(void)
+{
+    return s_addr;
+}
+
+void RpiModbus_GetStats(rpi_mb_stats_t *st)
+{
+    *st = s_stats;
+}
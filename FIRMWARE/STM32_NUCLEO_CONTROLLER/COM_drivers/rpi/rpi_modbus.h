@@ -0,0 +1,133 @@
+/*
+ * rpi_modbus.h
+ *
+ *  Created on: Jan 30, 2026
+ *      Author: penel
+ */
+
+#ifndef RPI_MODBUS_H_
+#define RPI_MODBUS_H_
+
+#include "main.h"
+#include <stdint.h>
+
+/*
+ * Esclave Modbus RTU sur le lien Raspberry Pi ("MODE=MODBUS") :
+ *
+ *   adresse | fonction | données | crc16_lo | crc16_hi
+ *
+ *  - crc16 : CRC-16/MODBUS (poly 0xA001 réfléchi, init 0xFFFF), octet bas
+ *            en premier
+ *  - fin de trame : silence de 3,5 caractères mesuré par TIM7 (one-shot,
+ *    relancé à chaque ligne IDLE, arrêté quand le DMA coupe un bloc en
+ *    moitié / fin de buffer) ; 1750 µs au-delà de 19200 bauds
+ *  - fonctions : 0x03 / 0x04 (lecture d'un bloc de registres),
+ *                0x06 / 0x10 (écriture de registres de maintien)
+ *  - adresse 0 (diffusion) : écritures exécutées, pas de réponse
+ *
+ * Ce module ne fait que le transport et le décodage des requêtes : la table
+ * des registres est fournie par l'appelant (rpi_mb_map_t).
+ */
+
+#define RPI_MB_ADDR_DEFAULT     1u
+#define RPI_MB_ADDR_MAX         247u
+
+/* Limites de la norme (PDU de 253 octets) */
+#define RPI_MB_READ_MAX         125u
+#define RPI_MB_WRITE_MAX        123u
+
+/* Réponse la plus longue : lecture de RPI_MB_READ_MAX registres */
+#define RPI_MB_ADU_MAX          (3u + 2u * RPI_MB_READ_MAX + 2u)
+
+typedef enum
+{
+    RPI_MB_FC_READ_HOLDING  = 0x03,
+    RPI_MB_FC_READ_INPUT    = 0x04,
+    RPI_MB_FC_WRITE_SINGLE  = 0x06,
+    RPI_MB_FC_WRITE_MULTI   = 0x10
+} rpi_mb_fc_t;
+
+typedef enum
+{
+    RPI_MB_EX_NONE          = 0x00,
+    RPI_MB_EX_FUNCTION      = 0x01,   /* fonction non supportée */
+    RPI_MB_EX_ADDRESS       = 0x02,   /* registre hors table */
+    RPI_MB_EX_VALUE         = 0x03,   /* quantité ou valeur invalide */
+    RPI_MB_EX_FAILURE       = 0x04
+} rpi_mb_ex_t;
+
+typedef enum
+{
+    RPI_MB_INPUT   = 0,               /* registres d'entrée (0x04), lecture seule */
+    RPI_MB_HOLDING = 1                /* registres de maintien (0x03, 0x06, 0x10) */
+} rpi_mb_table_t;
+
+/* Table des registres fournie par l'appelant. Les deux fonctions traitent
+ * un bloc complet : une écriture invalide ne doit rien modifier.
+ */
+typedef struct
+{
+    rpi_mb_ex_t (*read)(rpi_mb_table_t table, uint16_t addr, uint16_t count,
+                        uint16_t *out);
+    rpi_mb_ex_t (*write)(uint16_t addr, uint16_t count, const uint16_t *val);
+} rpi_mb_map_t;
+
+typedef struct
+{
+    uint32_t frames;       /* requêtes valides adressées à cet esclave */
+    uint32_t crc_errors;   /* trames rejetées : CRC ou longueur */
+    uint32_t exceptions;   /* réponses d'exception */
+} rpi_mb_stats_t;
+
+/**
+ * @brief CRC-16/MODBUS (table 256 entrées en flash).
+ */
+uint16_t RpiModbus_Crc16(const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Enregistre la table des registres et le rappel de fin de trame
+ *        (appelé dans l'interruption TIM7).
+ */
+void RpiModbus_Init(const rpi_mb_map_t *map, void (*on_frame_end)(void));
+
+/**
+ * @brief Configure TIM7 pour le silence de 3,5 caractères au débit `baud`
+ *        (8 bits + parité/stop = 11 bits par caractère) et active son
+ *        interruption. À rappeler après un changement de débit.
+ */
+HAL_StatusTypeDef RpiModbus_TimerStart(uint32_t baud);
+
+void RpiModbus_TimerStop(void);
+
+/**
+ * @brief Ligne au repos après un bloc reçu (contexte interruption) :
+ *        relance le délai de fin de trame.
+ */
+void RpiModbus_OnRxActivity(void);
+
+/**
+ * @brief Bloc coupé par le DMA (moitié / fin de buffer) : la trame continue,
+ *        délai arrêté jusqu'à la ligne IDLE suivante.
+ */
+void RpiModbus_OnRxBusy(void);
+
+/**
+ * @brief À appeler depuis TIM7_IRQHandler.
+ */
+void RpiModbus_IRQHandler(void);
+
+/**
+ * @brief Traite une trame RTU complète et construit la réponse.
+ *
+ * @return taille de la réponse dans rsp (CRC compris), 0 si rien à émettre
+ *         (CRC faux, autre esclave, diffusion).
+ */
+uint16_t RpiModbus_Handle(const uint8_t *req, uint16_t len,
+                          uint8_t *rsp, uint16_t rsp_size);
+
+HAL_StatusTypeDef RpiModbus_SetAddress(uint8_t addr);
+uint8_t RpiModbus_GetAddress(void);
+
+void RpiModbus_GetStats(rpi_mb_stats_t *st);
+
+#endif /* RPI_MODBUS_H_ */
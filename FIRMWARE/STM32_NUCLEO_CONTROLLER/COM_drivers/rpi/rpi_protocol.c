@@ -6,152 +6,2429 @@
  */
 
 #include "rpi_protocol.h"
+#include "rpi_frame.h"
+#include "rpi_cmdq.h"
+#include "rpi_fmt.h"
+#include "rpi_modbus.h"
+#include "rpi_tlm.h"
+#include "../sensors/imu_capture.h"
+#include "../valve/valve_control.h"
+#include "../param/param.h"
+#include "../param/flash_ee.h"
+#include "../time/timebase.h"
+#include "../time/perf.h"
+#include "../uart/uart_tx.h"
+#include "../uart/uart_rx.h"
+#include "../uart/uart_baud.h"
+#include "../log/log.h"
+#include "../log/trace.h"
 #include <string.h>
-#include <stdio.h>
 #include <stdlib.h>
 
+/* UART de debug (compteurs d'émission, GET_TX) */
+extern UART_HandleTypeDef huart2;
+
 /* UART et état capteurs */
 static UART_HandleTypeDef *s_huart = NULL;
 static const sensors_state_t *s_state = NULL;
 
-/* Coefficient K en 1/100 */
-static volatile int32_t s_K_centi = 500; /* 1.00 */
+/* Mode courant */
+static volatile rpi_mode_t s_mode = RPI_MODE_ASCII;
+
+/* Commande en cours de réception, construite directement dans une case
+ * de la file (rpi_cmdq.h)
+ */
+static uint8_t s_rx_len     = 0;
+static uint8_t s_rx_discard = 0;
+
+/* Adressage multipoint (RS-485) : adresse du nœud, RPI_NODE_NONE = liaison
+ * point à point (pas de préfixe). Le préfixe "@<adresse>:" (ASCII) ou
+ * l'octet d'adresse (binaire) est filtré à la réception, octet par octet.
+ */
+static volatile uint8_t s_node = RPI_NODE_NONE;
+
+typedef enum
+{
+    PROTO_NODE_START = 0,               /* début de commande : adresse attendue */
+    PROTO_NODE_DIGITS,                  /* ASCII : chiffres après '@' */
+    PROTO_NODE_DONE                     /* adresse reconnue, suite = commande */
+} proto_node_state_t;
+
+static uint8_t  s_rx_node_state = PROTO_NODE_START;
+static uint16_t s_rx_node_addr  = 0;
+static uint8_t  s_rx_node_digits = 0;
+static uint8_t  s_rx_broadcast  = 0;
+
+/* Commande diffusée en cours de traitement : exécutée sans réponse */
+static uint8_t s_reply_mute = 0;
+
+/* Horodatage du dernier bloc reçu (interruption) et de la commande en
+ * cours de traitement (t2 de TIME=)
+ */
+static uint32_t s_rx_us  = 0;
+static uint32_t s_cmd_us = 0;
+
+/* Abonnement : canaux poussés périodiquement ou sur changement */
+static struct
+{
+    uint8_t  mask;                      /* bit n = canal n (0 : pas d'abonnement) */
+    uint32_t period_ms;                 /* 0 : sur changement */
+    uint32_t next_tick;
+    uint32_t seq;
+    uint8_t  has_last;
+    int32_t  last[SENSORS_CH_COUNT];
+    uint8_t  batch;                     /* binaire : 0 = RPI_BIN_MSG_DATA, sinon MSG_DATA_Z */
+    uint32_t batch_tick;                /* HAL_GetTick() du 1er enregistrement en attente */
+} s_sub;
+
+/* Codeur de la télémétrie compressée (rpi_tlm.h) */
+static rpi_tlm_enc_t s_tlm;
+
+/* Préfixe des réponses ASCII : adresse du nœud ("@254:", multipoint),
+ * puis tag de la requête en cours de traitement (RPI_TAG_MAX) ; les
+ * données poussées ne portent que l'adresse.
+ */
+static char    s_pfx[12];              /* "@254:#65535:" */
+static uint8_t s_pfx_len      = 0;
+static uint8_t s_node_pfx_len = 0;     /* partie adresse de s_pfx */
+static uint8_t s_bin_tagged = 0;
+static uint16_t s_bin_tag = 0;
+
+/* Changement de débit en attente de confirmation (BAUD_OK) */
+static struct
+{
+    uint8_t  pending;
+    uint32_t deadline;
+    uint32_t prev_baud;                 /* réglage à restaurer sans BAUD_OK */
+    uint32_t prev_flow;
+} s_baud;
+
+/* Retour en ASCII demandé par écriture de RPI_MB_HR_MODE, appliqué après
+ * l'émission de la réponse Modbus
+ */
+static uint8_t s_mb_exit = 0;
+
+/* Débits proposés au Raspberry Pi (BAUD=) */
+static const uint32_t s_baud_rates[] = { 115200u, 230400u, 460800u, 921600u, 2000000u };
+
+/* Oublie la commande en cours de réception (interruption, ou section
+ * critique)
+ */
+static void Proto_RxReset(void)
+{
+    s_rx_len        = 0;
+    s_rx_discard    = 0;
+    s_rx_node_state = PROTO_NODE_START;
+    s_rx_broadcast  = 0;
+}
+
+/* Trame binaire ou RTU ; en multipoint, une trame binaire est précédée de
+ * l'adresse du nœud (RTU : adresse déjà dans la trame)
+ */
+static void Proto_SendBytes(const uint8_t *buf, uint16_t len)
+{
+    uint8_t node = s_node;
+
+    if (s_huart == NULL || buf == NULL || s_reply_mute)
+        return;
+
+    /* Copie dans le buffer DMA : rend la main immédiatement */
+    if (node != RPI_NODE_NONE && s_mode == RPI_MODE_BIN)
+        (void)UartTx_Write2(s_huart, &node, 1, buf, len);
+    else
+        (void)UartTx_Write(s_huart, buf, len);
+}
+
+/* Réponse ASCII, précédée de l'adresse du nœud et du tag s'il y en a */
+static void Proto_SendText(const char *buf, uint16_t len)
+{
+    if (s_huart == NULL || buf == NULL || s_reply_mute)
+        return;
+
+    /* Préfixe et réponse acceptés ensemble : pas de ligne orpheline */
+    (void)UartTx_Write2(s_huart, (const uint8_t*)s_pfx, s_pfx_len,
+                        (const uint8_t*)buf, len);
+}
+
+static void Proto_SendString(const char *s)
+{
+    if (s == NULL)
+        return;
+
+    Proto_SendText(s, (uint16_t)strlen(s));
+}
+
+/* Envoie le contenu d'un rpi_fmt_t (voir rpi_fmt.h) */
+static void Proto_SendFmt(const rpi_fmt_t *f)
+{
+    Proto_SendText(f->buf, f->len);
+}
+
+/* Canal capteur -> lettre protocole */
+static const char s_ch_letter[SENSORS_CH_COUNT] = { 'T', 'P', 'A' };
+
+/* Lettre protocole -> canal capteur ('T', 'P', 'A') */
+static int Proto_ParseChannel(char c, sensors_channel_t *ch)
+{
+    switch (c)
+    {
+    case 'T': *ch = SENSORS_CH_TEMP;  return 1;
+    case 'P': *ch = SENSORS_CH_PRESS; return 1;
+    case 'A': *ch = SENSORS_CH_ANGLE; return 1;
+    default:  return 0;
+    }
+}
+
+/* Lit n entiers séparés par des virgules ("12,-5,300").
+ * Retourne un pointeur sur le caractère qui suit le dernier entier,
+ * ou NULL si la syntaxe est invalide.
+ */
+static const char *Proto_ParseInts(const char *s, long *out, int n)
+{
+    char *end;
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        out[i] = strtol(s, &end, 10);
+        if (end == s)
+            return NULL;
+        s = end;
+        if (i < n - 1)
+        {
+            if (*s != ',')
+                return NULL;
+            s++;
+        }
+    }
+    return s;
+}
+
+/* CAP_ARM[=<sources>] : sources parmi C (commande), V (vanne), S (seuil) */
+static HAL_StatusTypeDef Proto_CaptureArm(const char *arg)
+{
+    uint8_t mask = 0;
+
+    if (arg == NULL)
+    {
+        mask = IMU_CAPTURE_SRC_CMD | IMU_CAPTURE_SRC_VALVE | IMU_CAPTURE_SRC_THRESHOLD;
+    }
+    else
+    {
+        for (; *arg != '\0'; arg++)
+        {
+            if      (*arg == (char)IMU_CAPTURE_TRIG_CMD)       mask |= IMU_CAPTURE_SRC_CMD;
+            else if (*arg == (char)IMU_CAPTURE_TRIG_VALVE)     mask |= IMU_CAPTURE_SRC_VALVE;
+            else if (*arg == (char)IMU_CAPTURE_TRIG_THRESHOLD) mask |= IMU_CAPTURE_SRC_THRESHOLD;
+            else return HAL_ERROR;
+        }
+    }
+
+    return ImuCapture_Arm(mask);
+}
+
+/* CAP_READ=<k>,<n> : n échantillons (max 8) à partir de k, en hexadécimal
+ * (12 octets big-endian par échantillon : ax ay az gx gy gz)
+ */
+#define CAP_READ_MAX  8
+static void Proto_CaptureRead(const char *arg)
+{
+    char tx[16 + CAP_READ_MAX * 24];
+    mpu9250_raw_data_t smp;
+    rpi_fmt_t f;
+    long v[2];
+    int i;
+
+    if (Proto_ParseInts(arg, v, 2) == NULL || v[0] < 0 || v[0] > 0xFFFF ||
+        v[1] < 1 || v[1] > CAP_READ_MAX)
+    {
+        Proto_SendString("ERR=ARG\r\n");
+        return;
+    }
+
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    RpiFmt_Str(&f, "C=");
+    RpiFmt_U32(&f, (uint32_t)v[0]);
+    RpiFmt_Char(&f, ':');
+
+    for (i = 0; i < v[1]; i++)
+    {
+        if (ImuCapture_GetSample((uint16_t)(v[0] + i), &smp) != HAL_OK)
+            break;
+
+        RpiFmt_Hex16(&f, (uint16_t)smp.ax);
+        RpiFmt_Hex16(&f, (uint16_t)smp.ay);
+        RpiFmt_Hex16(&f, (uint16_t)smp.az);
+        RpiFmt_Hex16(&f, (uint16_t)smp.gx);
+        RpiFmt_Hex16(&f, (uint16_t)smp.gy);
+        RpiFmt_Hex16(&f, (uint16_t)smp.gz);
+    }
+
+    if (i == 0)
+    {
+        Proto_SendString("ERR=ARG\r\n");
+        return;
+    }
+
+    RpiFmt_Str(&f, "\r\n");
+    Proto_SendFmt(&f);
+}
+
+/* SET_F=<canal>,<type>,<param> ex: "SET_F=T,M,8" */
+static HAL_StatusTypeDef Proto_SetFilter(const char *arg)
+{
+    sensors_channel_t ch;
+    char *end;
+    long param;
+
+    if (!Proto_ParseChannel(arg[0], &ch) || arg[1] != ',' ||
+        arg[2] == '\0' || arg[3] != ',')
+        return HAL_ERROR;
+
+    param = strtol(&arg[4], &end, 10);
+    if (end == &arg[4] || *end != '\0' || param < 0 || param > 255)
+        return HAL_ERROR;
+
+    return SensorsApp_SetFilter(ch, (sensor_filter_type_t)arg[2], (uint8_t)param);
+}
+
+/* Valeur publiée d'un canal (unité native : 0.01 °C, Pa, 0.001°) */
+static int32_t Proto_ChannelValue(sensors_channel_t ch)
+{
+    switch (ch)
+    {
+    case SENSORS_CH_TEMP:  return s_state->temp_centi;
+    case SENSORS_CH_PRESS: return (int32_t)s_state->press_pa;
+    default:               return s_state->angle_milli;
+    }
+}
+
+/* Instantané GET_ALL : canaux T, P, A puis K (bit SENSORS_CH_COUNT) */
+#define PROTO_ALL_K      (1u << SENSORS_CH_COUNT)
+#define PROTO_ALL_MASK   ((1u << (SENSORS_CH_COUNT + 1u)) - 1u)
+#define PROTO_ALL_COUNT  (SENSORS_CH_COUNT + 1u)
+
+typedef struct
+{
+    uint32_t seq;                   /* sample_seq de l'échantillon */
+    uint32_t t_us;                  /* horodatage de l'échantillon (timebase.h) */
+    int32_t  v[PROTO_ALL_COUNT];    /* T, P, A, K */
+} proto_snapshot_t;
+
+/* s_state n'est écrit que par SensorsApp_Update(), dans la même boucle que
+ * le traitement des commandes : la copie est cohérente sans section critique.
+ */
+static void Proto_TakeSnapshot(proto_snapshot_t *snap)
+{
+    unsigned ch;
+
+    snap->seq  = s_state->sample_seq;
+    snap->t_us = s_state->sample_us;
+    for (ch = 0; ch < SENSORS_CH_COUNT; ch++)
+        snap->v[ch] = Proto_ChannelValue((sensors_channel_t)ch);
+    snap->v[SENSORS_CH_COUNT] = RpiProto_GetK_centi();
+}
+
+/* "TPAK" -> masque ; NULL = toutes les valeurs */
+static HAL_StatusTypeDef Proto_ParseAllMask(const char *arg, uint8_t *mask)
+{
+    sensors_channel_t ch;
+
+    if (arg == NULL)
+    {
+        *mask = PROTO_ALL_MASK;
+        return HAL_OK;
+    }
+
+    *mask = 0;
+    for (; *arg != '\0'; arg++)
+    {
+        if (*arg == 'K')
+            *mask |= PROTO_ALL_K;
+        else if (Proto_ParseChannel(*arg, &ch))
+            *mask |= (uint8_t)(1u << ch);
+        else
+            return HAL_ERROR;
+    }
+    return (*mask != 0u) ? HAL_OK : HAL_ERROR;
+}
+
+static HAL_StatusTypeDef Proto_Subscribe(uint8_t mask, uint32_t period_ms, uint8_t batch)
+{
+    uint8_t n_ch = 0;
+    unsigned ch;
+
+    if (mask == 0u || mask >= (1u << SENSORS_CH_COUNT) || batch > RPI_TLM_BATCH_MAX)
+        return HAL_ERROR;
+
+    if (period_ms != 0u &&
+        (period_ms < RPI_SUB_PERIOD_MIN_MS || period_ms > RPI_SUB_PERIOD_MAX_MS))
+        return HAL_ERROR;
+
+    s_sub.mask      = mask;
+    s_sub.period_ms = period_ms;
+    s_sub.next_tick = HAL_GetTick();
+    s_sub.seq       = 0;
+    s_sub.has_last  = 0;
+    s_sub.batch     = batch;
+
+    for (ch = 0; ch < SENSORS_CH_COUNT; ch++)
+    {
+        if (mask & (1u << ch))
+            n_ch++;
+    }
+    /* + t_us en tête de chaque enregistrement */
+    RpiTlm_Init(&s_tlm, (uint8_t)(n_ch + 1u), batch);
+    return HAL_OK;
+}
+
+/* SUB=<canaux>,<ms> ex: "SUB=TP,100", "SUB=TPA,0" (sur changement) */
+static HAL_StatusTypeDef Proto_SubscribeAscii(const char *arg)
+{
+    sensors_channel_t ch;
+    uint8_t mask = 0;
+    long period;
+
+    for (; *arg != ',' && *arg != '\0'; arg++)
+    {
+        if (!Proto_ParseChannel(*arg, &ch))
+            return HAL_ERROR;
+        mask |= (uint8_t)(1u << ch);
+    }
+
+    if (*arg != ',' || Proto_ParseInts(arg + 1, &period, 1) == NULL || period < 0)
+        return HAL_ERROR;
+
+    return Proto_Subscribe(mask, (uint32_t)period, 0);
+}
+
+/* SET_W=<canal>,<slot>,<ms> ex: "SET_W=T,1,60000" */
+static HAL_StatusTypeDef Proto_SetStatsWindow(const char *arg)
+{
+    sensors_channel_t ch;
+    long v[2];
+    const char *end;
+
+    if (!Proto_ParseChannel(arg[0], &ch) || arg[1] != ',')
+        return HAL_ERROR;
+
+    end = Proto_ParseInts(&arg[2], v, 2);
+    if (end == NULL || *end != '\0' || v[0] < 0 || v[0] > 255 || v[1] < 0)
+        return HAL_ERROR;
+
+    return SensorsApp_SetStatsWindow(ch, (uint8_t)v[0], (uint32_t)v[1]);
+}
+
+/* GET_S : dernières fenêtres terminées de tous les canaux, sur une ligne
+ *   S=<canal><slot>:<ms>,<seq>,<n>,<min>,<max>,<moy>,<var>,<ecart-type>,<tick fin>;...
+ */
+#define STATS_ENTRY_MAX  104
+static void Proto_SendStats(void)
+{
+    static char tx[8 + SENSORS_CH_COUNT * SENSORS_STATS_SLOTS * STATS_ENTRY_MAX];
+    const sensor_stats_window_t *w;
+    uint32_t window_ms;
+    rpi_fmt_t f;
+    unsigned ch, slot;
+
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    RpiFmt_Str(&f, "S=");
+
+    for (ch = 0; ch < SENSORS_CH_COUNT; ch++)
+    {
+        for (slot = 0; slot < SENSORS_STATS_SLOTS; slot++)
+        {
+            w = SensorsApp_GetStats((sensors_channel_t)ch, (uint8_t)slot, &window_ms);
+            if (w == NULL)
+                continue;
+
+            if (f.len > 2u)
+                RpiFmt_Char(&f, ';');
+            RpiFmt_Char(&f, s_ch_letter[ch]);
+            RpiFmt_U32(&f, slot);
+            RpiFmt_Char(&f, ':');
+            RpiFmt_U32(&f, window_ms);
+            RpiFmt_Char(&f, ',');
+            RpiFmt_U32(&f, w->seq);
+            RpiFmt_Char(&f, ',');
+            RpiFmt_U32(&f, w->count);
+            RpiFmt_Char(&f, ',');
+            RpiFmt_I32(&f, w->min);
+            RpiFmt_Char(&f, ',');
+            RpiFmt_I32(&f, w->max);
+            RpiFmt_Char(&f, ',');
+            RpiFmt_I32(&f, w->mean);
+            RpiFmt_Char(&f, ',');
+            RpiFmt_U32(&f, w->var);
+            RpiFmt_Char(&f, ',');
+            RpiFmt_U32(&f, w->std);
+            RpiFmt_Char(&f, ',');
+            RpiFmt_U32(&f, w->end_tick);
+        }
+    }
+
+    RpiFmt_Str(&f, "\r\n");
+    Proto_SendFmt(&f);
+}
+
+/* --------------------------------------------------------------------------
+ * Commandes ASCII
+ *
+ * "<NOM>" ou "<NOM>=<argument>". Chaque commande est une entrée de
+ * s_commands ; le nom est retrouvé par hachage parfait (s_hash, calculé
+ * à l'init), HELP est construit à partir de la table.
+ * -------------------------------------------------------------------------- */
+
+/* Réponses courtes : formatées sans printf (rpi_fmt.h) */
+#define PROTO_REPLY_LEN  64
+
+/* "<nom>=OK" ou "ERR=ARG" */
+static void Proto_ReplyStatus(const char *name, HAL_StatusTypeDef st)
+{
+    char tx[PROTO_REPLY_LEN];
+    rpi_fmt_t f;
+
+    if (st != HAL_OK)
+    {
+        Proto_SendString("ERR=ARG\r\n");
+        return;
+    }
+
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    RpiFmt_Str(&f, name);
+    RpiFmt_Str(&f, "=OK\r\n");
+    Proto_SendFmt(&f);
+}
+
+/* "<préfixe><valeur à virgule fixe><suffixe>" */
+static void Proto_ReplyFixed(const char *prefix, int32_t v, uint8_t decimals,
+                             uint8_t int_width, uint8_t flags, const char *suffix)
+{
+    char tx[PROTO_REPLY_LEN];
+    rpi_fmt_t f;
+
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    RpiFmt_Str(&f, prefix);
+    RpiFmt_Fixed(&f, v, decimals, int_width, flags);
+    RpiFmt_Str(&f, suffix);
+    Proto_SendFmt(&f);
+}
+
+/* "<préfixe>v0,v1,...\r\n" (entiers non signés) */
+static void Proto_ReplyU32List(const char *prefix, const uint32_t *v, unsigned n)
+{
+    char tx[PROTO_REPLY_LEN];
+    rpi_fmt_t f;
+    unsigned i;
+
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    RpiFmt_Str(&f, prefix);
+    for (i = 0; i < n; i++)
+    {
+        if (i > 0u)
+            RpiFmt_Char(&f, ',');
+        RpiFmt_U32(&f, v[i]);
+    }
+    RpiFmt_Str(&f, "\r\n");
+    Proto_SendFmt(&f);
+}
+
+static void Proto_PutU32(uint8_t *p, uint32_t v);
+static void Proto_SendFrame(uint8_t id, const uint8_t *payload, uint8_t len);
+
+/* "ALL=<seq>,<t_us>,T2345,P101325,A0,K1234\r\n" (valeurs de `mask`) */
+#define PROTO_ALL_TEXT_MAX  (24u + PROTO_ALL_COUNT * 13u)
+static void Proto_RenderAll(rpi_fmt_t *f, const proto_snapshot_t *snap, uint8_t mask)
+{
+    unsigned i;
+
+    RpiFmt_Str(f, "ALL=");
+    RpiFmt_U32(f, snap->seq);
+    RpiFmt_Char(f, ',');
+    RpiFmt_U32(f, snap->t_us);
+    for (i = 0; i < PROTO_ALL_COUNT; i++)
+    {
+        if (mask & (1u << i))
+        {
+            RpiFmt_Char(f, ',');
+            RpiFmt_Char(f, (i < SENSORS_CH_COUNT) ? s_ch_letter[i] : 'K');
+            RpiFmt_I32(f, snap->v[i]);
+        }
+    }
+    RpiFmt_Str(f, "\r\n");
+}
+
+/* Payload binaire GET_ALL : seq, t_us, puis int32 par valeur de `mask` */
+#define PROTO_ALL_PAYLOAD_MAX  (8u + 4u * PROTO_ALL_COUNT)
+static uint8_t Proto_BuildAllPayload(uint8_t *out, const proto_snapshot_t *snap, uint8_t mask)
+{
+    uint8_t n = 8;
+    unsigned i;
+
+    Proto_PutU32(out, snap->seq);
+    Proto_PutU32(&out[4], snap->t_us);
+    for (i = 0; i < PROTO_ALL_COUNT; i++)
+    {
+        if (mask & (1u << i))
+        {
+            Proto_PutU32(&out[n], (uint32_t)snap->v[i]);
+            n = (uint8_t)(n + 4u);
+        }
+    }
+    return n;
+}
+
+/* --------------------------------------------------------------------------
+ * Cache des réponses
+ *
+ * GET_T/P/A/K et GET_ALL (sans argument) sont rendus une seule fois par
+ * publication de SensorsApp (sample_seq) ou changement de K, en texte et en
+ * trame binaire : une requête ne fait plus qu'une copie dans le buffer DMA.
+ * -------------------------------------------------------------------------- */
+
+typedef enum
+{
+    PROTO_CACHE_T = 0,      /* indices alignés sur proto_snapshot_t.v */
+    PROTO_CACHE_P,
+    PROTO_CACHE_A,
+    PROTO_CACHE_K,
+    PROTO_CACHE_ALL,
+    PROTO_CACHE_COUNT
+} proto_cache_id_t;
+
+typedef struct
+{
+    uint8_t text_len;
+    uint8_t payload_len;
+    uint8_t frame_len;
+    char    text[PROTO_ALL_TEXT_MAX];
+    uint8_t payload[PROTO_ALL_PAYLOAD_MAX];     /* réponses étiquetées */
+    uint8_t frame[RPI_FRAME_ENC_MAX];
+} proto_cache_entry_t;
+
+static struct
+{
+    uint8_t  valid;
+    uint32_t seq;           /* sample_seq rendu */
+    int32_t  k_centi;       /* K rendu */
+    proto_cache_entry_t e[PROTO_CACHE_COUNT];
+} s_cache;
+
+static const uint8_t s_cache_bin_id[PROTO_CACHE_COUNT] =
+{
+    RPI_BIN_CMD_GET_T, RPI_BIN_CMD_GET_P, RPI_BIN_CMD_GET_A,
+    RPI_BIN_CMD_GET_K, RPI_BIN_CMD_GET_ALL
+};
+
+static void Proto_CacheRender(proto_cache_entry_t *e, proto_cache_id_t id,
+                              const proto_snapshot_t *snap)
+{
+    rpi_fmt_t f;
+
+    RpiFmt_Init(&f, e->text, sizeof(e->text));
+    switch (id)
+    {
+    case PROTO_CACHE_T:
+        RpiFmt_Str(&f, "T=");
+        RpiFmt_Fixed(&f, snap->v[id], 2, 2, RPI_FMT_PLUS);
+        RpiFmt_Str(&f, "_C\r\n");
+        break;
+    case PROTO_CACHE_P:
+        RpiFmt_Str(&f, "P=");
+        RpiFmt_U32(&f, (uint32_t)snap->v[id]);
+        RpiFmt_Str(&f, "Pa\r\n");
+        break;
+    case PROTO_CACHE_A:
+        /* 0.001°, affiché sur 4 décimales */
+        RpiFmt_Str(&f, "A=");
+        RpiFmt_Fixed(&f, snap->v[id], 3, 1, 0);
+        RpiFmt_Str(&f, "0\r\n");
+        break;
+    case PROTO_CACHE_K:
+        RpiFmt_Str(&f, "K=");
+        RpiFmt_Fixed(&f, snap->v[id], 2, 1, 0);
+        RpiFmt_Str(&f, "000\r\n");
+        break;
+    default:
+        Proto_RenderAll(&f, snap, PROTO_ALL_MASK);
+        break;
+    }
+    e->text_len = (uint8_t)f.len;
+
+    if (id == PROTO_CACHE_ALL)
+    {
+        e->payload_len = Proto_BuildAllPayload(e->payload, snap, PROTO_ALL_MASK);
+    }
+    else
+    {
+        Proto_PutU32(e->payload, (uint32_t)snap->v[id]);
+        e->payload_len = 4;
+    }
+    e->frame_len = (uint8_t)RpiFrame_Encode(s_cache_bin_id[id], e->payload,
+                                            e->payload_len, e->frame);
+}
+
+/* Reconstruit le cache si une publication ou un SET_K est intervenu */
+static void Proto_CacheRefresh(void)
+{
+    proto_snapshot_t snap;
+    unsigned id;
+
+    if (s_state == NULL ||
+        (s_cache.valid && s_cache.seq == s_state->sample_seq && s_cache.k_centi == RpiProto_GetK_centi()))
+        return;
+
+    Proto_TakeSnapshot(&snap);
+    for (id = 0; id < PROTO_CACHE_COUNT; id++)
+        Proto_CacheRender(&s_cache.e[id], (proto_cache_id_t)id, &snap);
+
+    s_cache.seq     = snap.seq;
+    s_cache.k_centi = snap.v[PROTO_CACHE_K];
+    s_cache.valid   = 1;
+}
+
+static void Proto_SendCachedText(proto_cache_id_t id)
+{
+    Proto_CacheRefresh();
+    Proto_SendText(s_cache.e[id].text, s_cache.e[id].text_len);
+}
+
+static void Proto_SendCachedFrame(proto_cache_id_t id)
+{
+    const proto_cache_entry_t *e = &s_cache.e[id];
+
+    Proto_CacheRefresh();
+
+    /* Requête étiquetée : la trame change (tag), seul le payload est repris */
+    if (s_bin_tagged)
+        Proto_SendFrame(s_cache_bin_id[id], e->payload, e->payload_len);
+    else
+        Proto_SendBytes(e->frame, e->frame_len);
+}
+
+static void Cmd_GetT(const char *arg)
+{
+    Proto_SendCachedText(PROTO_CACHE_T);
+}
+
+static void Cmd_GetP(const char *arg)
+{
+    Proto_SendCachedText(PROTO_CACHE_P);
+}
+
+static void Cmd_GetA(const char *arg)
+{
+    Proto_SendCachedText(PROTO_CACHE_A);
+}
+
+/* GET_ALL[=TPAK] : "ALL=<seq>,<t_us>,T2345,P101325,A0,K1234" (unités natives) */
+static void Cmd_GetAll(const char *arg)
+{
+    char tx[PROTO_ALL_TEXT_MAX];
+    proto_snapshot_t snap;
+    rpi_fmt_t f;
+    uint8_t mask;
+
+    if (Proto_ParseAllMask(arg, &mask) != HAL_OK)
+    {
+        Proto_SendString("ERR=ARG\r\n");
+        return;
+    }
+
+    if (mask == PROTO_ALL_MASK)
+    {
+        Proto_SendCachedText(PROTO_CACHE_ALL);
+        return;
+    }
+
+    Proto_TakeSnapshot(&snap);
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    Proto_RenderAll(&f, &snap, mask);
+    Proto_SendFmt(&f);
+}
+
+static void Cmd_SetK(const char *arg)
+{
+    uint32_t k;
+
+    if (Param_Parse(PARAM_K_CENTI, arg, &k) != HAL_OK)
+    {
+        Proto_SendString("ERR=ARG\r\n");
+        return;
+    }
+
+    if (Param_Set(PARAM_K_CENTI, k) != HAL_OK)
+        Proto_SendString("ERR=FLASH\r\n");
+    else
+        Proto_SendString("SET_K=OK\r\n");
+}
+
+static void Cmd_GetK(const char *arg)
+{
+    Proto_SendCachedText(PROTO_CACHE_K);
+}
+
+static void Cmd_GetR(const char *arg)
+{
+    Proto_ReplyFixed("R=", (int32_t)s_state->period_ms, 0, 1, 0, "ms\r\n");
+}
+
+static void Cmd_GetI2C(const char *arg)
+{
+    uint32_t v[3];
+
+    v[0] = SensorsApp_GetBmpBusHealth()->total_fail;
+    v[1] = mpu9250_get_bus_health()->total_fail;
+    v[2] = I2CBus_GetRecoveryCount();
+    Proto_ReplyU32List("I2C=", v, 3);
+}
+
+static void Cmd_GetTx(const char *arg)
+{
+    uart_tx_stats_t pi = {0}, dbg = {0};
+    uint32_t v[4];
+
+    (void)UartTx_GetStats(s_huart, &pi);
+    (void)UartTx_GetStats(&huart2, &dbg);
+    v[0] = pi.high_water;
+    v[1] = pi.overflows;
+    v[2] = dbg.high_water;
+    v[3] = dbg.overflows;
+    Proto_ReplyU32List("TX=", v, 4);
+}
+
+static void Cmd_GetQ(const char *arg)
+{
+    rpi_cmdq_stats_t q;
+    uint32_t v[4];
+
+    RpiCmdQ_GetStats(&q);
+    v[0] = q.depth;
+    v[1] = q.max_used;
+    v[2] = q.overflows;
+    v[3] = q.too_long;
+    Proto_ReplyU32List("Q=", v, 4);
+}
+
+/* Z=<enregistrements>,<trames>,<octets MSG_DATA>,<octets MSG_DATA_Z>,<cycles/enr.> */
+static void Cmd_GetZ(const char *arg)
+{
+    const rpi_tlm_stats_t *st = &s_tlm.stats;
+    uint32_t v[5];
+
+    v[0] = st->samples;
+    v[1] = st->frames;
+    v[2] = st->raw_bytes;
+    v[3] = st->enc_bytes;
+    v[4] = (st->samples > 0u) ? st->cycles / st->samples : 0u;
+    Proto_ReplyU32List("Z=", v, 5);
+}
+
+static void Cmd_SetF(const char *arg)
+{
+    Proto_ReplyStatus("SET_F", Proto_SetFilter(arg));
+}
+
+static void Cmd_GetF(const char *arg)
+{
+    sensors_channel_t ch;
+    sensor_filter_type_t type;
+    uint8_t param;
+
+    if (Proto_ParseChannel(arg[0], &ch) &&
+        SensorsApp_GetFilter(ch, &type, &param) == HAL_OK)
+    {
+        char prefix[] = "F=c,t,";
+        uint32_t v = param;
+
+        prefix[2] = arg[0];
+        prefix[4] = (char)type;
+        Proto_ReplyU32List(prefix, &v, 1);
+    }
+    else
+    {
+        Proto_SendString("ERR=ARG\r\n");
+    }
+}
+
+static void Cmd_SetW(const char *arg)
+{
+    Proto_ReplyStatus("SET_W", Proto_SetStatsWindow(arg));
+}
+
+static void Cmd_GetS(const char *arg)
+{
+    Proto_SendStats();
+}
+
+static void Cmd_CapCfg(const char *arg)
+{
+    long v[2];
+    const char *end = Proto_ParseInts(arg, v, 2);
+
+    if (end != NULL && *end == '\0' && v[0] >= 0 && v[0] <= 0xFFFF &&
+        v[1] >= 0 && v[1] <= 0xFFFF &&
+        ImuCapture_Config((uint16_t)v[0], (uint16_t)v[1]) == HAL_OK)
+        Proto_SendString("CAP_CFG=OK\r\n");
+    else
+        Proto_SendString("ERR=ARG\r\n");
+}
+
+static void Cmd_CapThr(const char *arg)
+{
+    long v[2];
+    const char *end = Proto_ParseInts(arg, v, 2);
+
+    if (end != NULL && end[0] == ',' && end[1] != '\0' && end[2] == '\0' &&
+        v[1] >= INT16_MIN && v[1] <= INT16_MAX &&
+        ImuCapture_SetThreshold((imu_axis_t)v[0], (int16_t)v[1],
+                                (imu_capture_edge_t)end[1]) == HAL_OK)
+        Proto_SendString("CAP_THR=OK\r\n");
+    else
+        Proto_SendString("ERR=ARG\r\n");
+}
+
+static void Cmd_CapArm(const char *arg)
+{
+    if (Proto_CaptureArm(arg) == HAL_OK)
+        Proto_SendString("CAP_ARM=OK\r\n");
+    else
+        Proto_SendString("ERR=CAP\r\n");
+}
+
+static void Cmd_CapTrig(const char *arg)
+{
+    ImuCapture_Trigger(IMU_CAPTURE_TRIG_CMD);
+    Proto_SendString("CAP_TRIG=OK\r\n");
+}
+
+static void Cmd_CapStop(const char *arg)
+{
+    ImuCapture_Disarm();
+    Proto_SendString("CAP_STOP=OK\r\n");
+}
+
+static void Cmd_CapStat(const char *arg)
+{
+    imu_capture_status_t st;
+    char prefix[] = "CAP=s,t,";
+    uint32_t v[4];
+
+    ImuCapture_GetStatus(&st);
+    prefix[4] = (char)st.state;
+    prefix[6] = (char)st.trig_src;
+    v[0] = st.pre;
+    v[1] = st.total;
+    v[2] = st.trig_us;
+    v[3] = st.overflows;
+    Proto_ReplyU32List(prefix, v, 4);
+}
+
+static void Cmd_CapRead(const char *arg)
+{
+    Proto_CaptureRead(arg);
+}
+
+static void Cmd_Sub(const char *arg)
+{
+    Proto_ReplyStatus("SUB", Proto_SubscribeAscii(arg));
+}
+
+static void Cmd_Unsub(const char *arg)
+{
+    s_sub.mask = 0;
+    Proto_SendString("UNSUB=OK\r\n");
+}
+
+/* Change de mode en oubliant la commande en cours de réception : les
+ * délimiteurs ne sont pas les mêmes d'un mode à l'autre
+ */
+static void Proto_SetMode(rpi_mode_t mode)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    s_mode       = mode;
+    Proto_RxReset();
+    __set_PRIMASK(primask);
+}
+
+static HAL_StatusTypeDef Proto_SetParam(param_id_t p, uint32_t v);
+
+/* MODE=MODBUS[,<adresse>] : réponse en ASCII, puis esclave RTU */
+static void Proto_EnterModbus(const char *arg)
+{
+    char tx[24];
+    rpi_fmt_t f;
+
+    if (arg[0] == ',')
+    {
+        char *end;
+        long addr = strtol(arg + 1, &end, 10);
+
+        if (end == arg + 1 || *end != '\0' || !Param_InRange(PARAM_MB_ADDR, (uint32_t)addr))
+        {
+            Proto_SendString("ERR=ARG\r\n");
+            return;
+        }
+        (void)Proto_SetParam(PARAM_MB_ADDR, (uint32_t)addr);
+    }
+    else if (arg[0] != '\0')
+    {
+        Proto_SendString("ERR=ARG\r\n");
+        return;
+    }
+
+    if (RpiModbus_TimerStart(s_huart->Init.BaudRate) != HAL_OK)
+    {
+        Proto_SendString("ERR=MODE\r\n");
+        return;
+    }
+
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    RpiFmt_Str(&f, "MODE=MODBUS,");
+    RpiFmt_U32(&f, RpiModbus_GetAddress());
+    RpiFmt_Str(&f, "\r\n");
+    Proto_SendFmt(&f);
+
+    s_mb_exit = 0;
+    Proto_SetMode(RPI_MODE_MODBUS);
+}
+
+static void Cmd_Mode(const char *arg)
+{
+    if (strncmp(arg, "MODBUS", 6) == 0)
+    {
+        Proto_EnterModbus(arg + 6);
+        return;
+    }
+
+    if (strcmp(arg, "BIN") != 0)
+    {
+        Proto_SendString("ERR=ARG\r\n");
+        return;
+    }
+
+    /* Réponse encore en ASCII, puis trames binaires */
+    Proto_SendString("MODE=BIN\r\n");
+    s_mode = RPI_MODE_BIN;
+}
+
+/* Adresse multipoint et préfixe "@<adresse>:" des réponses ASCII */
+static void Proto_SetNode(uint8_t node)
+{
+    rpi_fmt_t f;
+
+    RpiFmt_Init(&f, s_pfx, sizeof(s_pfx));
+    if (node != RPI_NODE_NONE)
+    {
+        RpiFmt_Char(&f, '@');
+        RpiFmt_U32(&f, node);
+        RpiFmt_Char(&f, ':');
+    }
+    s_pfx_len      = (uint8_t)f.len;
+    s_node_pfx_len = (uint8_t)f.len;
+    s_node         = node;
+}
+
+/* NODE[=<adresse>] : réponse avec l'ancien préfixe, puis changement */
+static void Cmd_Node(const char *arg)
+{
+    char tx[16];
+    rpi_fmt_t f;
+    long node = s_node;
+
+    if (arg != NULL)
+    {
+        char *end;
+
+        node = strtol(arg, &end, 10);
+        if (end == arg || *end != '\0' || node < 0 || !Param_InRange(PARAM_NODE, (uint32_t)node))
+        {
+            Proto_SendString("ERR=ARG\r\n");
+            return;
+        }
+    }
+
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    RpiFmt_Str(&f, "NODE=");
+    RpiFmt_U32(&f, (uint32_t)node);
+    RpiFmt_Str(&f, "\r\n");
+    Proto_SendFmt(&f);
+
+    if (arg != NULL)
+        (void)Proto_SetParam(PARAM_NODE, (uint32_t)node);
+}
+
+/* Paramètres persistants (param.h) : valeur enregistrée appliquée au
+ * module qui l'utilise (K est relu à chaque usage)
+ */
+static void Proto_ApplyParam(param_id_t p)
+{
+    switch (p)
+    {
+    case PARAM_CTRL_REF:
+        /* Une seule consigne : régulation et cadence d'acquisition */
+        ValveControl_SetRef((int32_t)Param_Get(p));
+        SensorsApp_SetControlRef((int32_t)Param_Get(p));
+        break;
+    case PARAM_NODE:
+        Proto_SetNode((uint8_t)Param_Get(p));
+        break;
+    case PARAM_MB_ADDR:
+        (void)RpiModbus_SetAddress((uint8_t)Param_Get(p));
+        break;
+    default:
+        break;
+    }
+}
+
+/* Enregistre puis applique ; une valeur dans la plage est appliquée même
+ * si l'écriture flash échoue
+ */
+static HAL_StatusTypeDef Proto_SetParam(param_id_t p, uint32_t v)
+{
+    HAL_StatusTypeDef st = Param_Set(p, v);
+
+    if (Param_Get(p) == v)
+        Proto_ApplyParam(p);
+    return st;
+}
+
+static void Proto_FmtParamValue(rpi_fmt_t *f, param_id_t p, uint32_t v)
+{
+    if (Param_Def(p)->type == PARAM_TYPE_I32)
+        RpiFmt_I32(f, (int32_t)v);
+    else
+        RpiFmt_U32(f, v);
+}
+
+/* PAR=<nom>,<valeur>,<min>,<max>,<défaut>;<nom>,... */
+static void Cmd_ParList(const char *arg)
+{
+    static char tx[8 + PARAM_COUNT * 64u];
+    rpi_fmt_t f;
+    uint32_t i;
+
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    RpiFmt_Str(&f, "PAR=");
+    for (i = 0; i < PARAM_COUNT; i++)
+    {
+        const param_def_t *d = Param_Def((param_id_t)i);
+
+        if (i > 0u)
+            RpiFmt_Char(&f, ';');
+        RpiFmt_Str(&f, d->name);
+        RpiFmt_Char(&f, ',');
+        Proto_FmtParamValue(&f, (param_id_t)i, Param_Get((param_id_t)i));
+        RpiFmt_Char(&f, ',');
+        Proto_FmtParamValue(&f, (param_id_t)i, (uint32_t)d->min);
+        RpiFmt_Char(&f, ',');
+        Proto_FmtParamValue(&f, (param_id_t)i, (uint32_t)d->max);
+        RpiFmt_Char(&f, ',');
+        Proto_FmtParamValue(&f, (param_id_t)i, (uint32_t)d->def);
+    }
+    RpiFmt_Str(&f, "\r\n");
+    Proto_SendFmt(&f);
+}
+
+/* PAR_GET=<nom> -> PAR=<nom>,<valeur> */
+static void Cmd_ParGet(const char *arg)
+{
+    char tx[PROTO_REPLY_LEN];
+    rpi_fmt_t f;
+    param_id_t p = Param_Find(arg, strlen(arg));
+
+    if (p >= PARAM_COUNT)
+    {
+        Proto_SendString("ERR=ARG\r\n");
+        return;
+    }
+
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    RpiFmt_Str(&f, "PAR=");
+    RpiFmt_Str(&f, Param_Def(p)->name);
+    RpiFmt_Char(&f, ',');
+    Proto_FmtParamValue(&f, p, Param_Get(p));
+    RpiFmt_Str(&f, "\r\n");
+    Proto_SendFmt(&f);
+}
+
+/* PAR_SET=<nom>,<valeur> : réponse avant application (NODE : ancien
+ * préfixe), ERR=FLASH si la valeur n'a pas pu être enregistrée
+ */
+static void Cmd_ParSet(const char *arg)
+{
+    const char *comma = strchr(arg, ',');
+    param_id_t p;
+    uint32_t v;
+    HAL_StatusTypeDef st;
+
+    p = (comma != NULL) ? Param_Find(arg, (size_t)(comma - arg)) : PARAM_COUNT;
+    if (p >= PARAM_COUNT || Param_Parse(p, comma + 1, &v) != HAL_OK)
+    {
+        Proto_SendString("ERR=ARG\r\n");
+        return;
+    }
+
+    st = Param_Set(p, v);
+    Proto_SendString((st == HAL_OK) ? "PAR_SET=OK\r\n" : "ERR=FLASH\r\n");
+    Proto_ApplyParam(p);
+}
+
+/* PAR_STAT=<page>,<génération>,<enregistrements>,<capacité>,<CRC faux>,<effacements> */
+static void Cmd_ParStat(const char *arg)
+{
+    flash_ee_stats_t ee;
+    uint32_t v[6];
+
+    FlashEe_GetStats(&ee);
+    v[0] = ee.page;
+    v[1] = ee.generation;
+    v[2] = ee.used;
+    v[3] = ee.capacity;
+    v[4] = ee.crc_errors;
+    v[5] = ee.erases;
+    Proto_ReplyU32List("PAR_STAT=", v, 6);
+}
+
+/* LOG : "LOG=<module>:<niveau>,...;<lignes>,<perdues>,<tronquées>"
+ * LOG=<module|*>,<O|E|W|I|D> : niveau des traces de la console (USART2)
+ */
+static void Cmd_Log(const char *arg)
+{
+    char tx[PROTO_REPLY_LEN + LOG_MOD_COUNT * 8u];
+    rpi_fmt_t f;
+    log_stats_t st;
+    log_module_t m;
+    const char *comma;
+    uint32_t i;
+
+    if (arg != NULL)
+    {
+        comma = strchr(arg, ',');
+        if (comma == NULL || comma[1] == '\0' || comma[2] != '\0')
+        {
+            Proto_SendString("ERR=ARG\r\n");
+            return;
+        }
+        m = (comma - arg == 1 && arg[0] == '*') ? LOG_MOD_COUNT
+                                                 : Log_FindModule(arg, (size_t)(comma - arg));
+        if ((m == LOG_MOD_COUNT && arg[0] != '*') ||
+            Log_SetLevel(m, Log_LevelFromChar(comma[1])) != HAL_OK)
+        {
+            Proto_SendString("ERR=ARG\r\n");
+            return;
+        }
+    }
+
+    Log_GetStats(&st);
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    RpiFmt_Str(&f, "LOG=");
+    for (i = 0; i < LOG_MOD_COUNT; i++)
+    {
+        if (i > 0u)
+            RpiFmt_Char(&f, ',');
+        RpiFmt_Str(&f, Log_ModuleName((log_module_t)i));
+        RpiFmt_Char(&f, ':');
+        RpiFmt_Char(&f, Log_LevelChar(Log_GetLevel((log_module_t)i)));
+    }
+    RpiFmt_Char(&f, ';');
+    RpiFmt_U32(&f, st.lines);
+    RpiFmt_Char(&f, ',');
+    RpiFmt_U32(&f, st.dropped);
+    RpiFmt_Char(&f, ',');
+    RpiFmt_U32(&f, st.truncated);
+    RpiFmt_Str(&f, "\r\n");
+    Proto_SendFmt(&f);
+}
+
+/* TRC : "TRC=<événements>,<perdus>:<mots hex>" (trace.h), événements
+ * entiers retirés du buffer, 8 chiffres par mot de 32 bits ; rien après
+ * ':' quand le buffer est vide
+ */
+#define TRC_READ_MAX_WORDS  24u
+static void Cmd_Trc(const char *arg)
+{
+    static char tx[32 + TRC_READ_MAX_WORDS * 8u];
+    uint32_t w[TRC_READ_MAX_WORDS];
+    trace_stats_t st;
+    rpi_fmt_t f;
+    uint32_t n, i;
+
+    n = Trace_Read(w, TRC_READ_MAX_WORDS);
+    Trace_GetStats(&st);
+
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    RpiFmt_Str(&f, "TRC=");
+    RpiFmt_U32(&f, st.events);
+    RpiFmt_Char(&f, ',');
+    RpiFmt_U32(&f, st.lost);
+    RpiFmt_Char(&f, ':');
+    for (i = 0; i < n; i++)
+    {
+        RpiFmt_Hex16(&f, (uint16_t)(w[i] >> 16));
+        RpiFmt_Hex16(&f, (uint16_t)w[i]);
+    }
+    RpiFmt_Str(&f, "\r\n");
+    Proto_SendFmt(&f);
+}
+
+/* Nombre, min, max, moyenne d'une sonde (cycles) */
+static void Proto_FmtPerf(rpi_fmt_t *f, perf_probe_t p, const perf_stats_t *st)
+{
+    RpiFmt_Str(f, Perf_Name(p));
+    RpiFmt_Char(f, ',');
+    RpiFmt_U32(f, st->count);
+    RpiFmt_Char(f, ',');
+    RpiFmt_U32(f, st->min);
+    RpiFmt_Char(f, ',');
+    RpiFmt_U32(f, st->max);
+    RpiFmt_Char(f, ',');
+    RpiFmt_U32(f, (st->count > 0u) ? (uint32_t)(st->sum / st->count) : 0u);
+}
+
+/* GET_PERF : "PERF=<Hz CPU>;<sonde>,<n>,<min>,<max>,<moy>;..." (cycles)
+ * GET_PERF=<sonde> : "PERF=<sonde>,<n>,<min>,<max>,<moy>:<h0>,...,<h23>",
+ * histogramme log2 de perf.h
+ */
+static void Cmd_GetPerf(const char *arg)
+{
+    static char tx[24 + PERF_COUNT * 56u];
+    perf_stats_t st;
+    rpi_fmt_t f;
+    perf_probe_t p;
+    uint32_t i;
+
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    RpiFmt_Str(&f, "PERF=");
+
+    if (arg != NULL)
+    {
+        p = Perf_Find(arg, strlen(arg));
+        if (Perf_Get(p, &st) != HAL_OK)
+        {
+            Proto_SendString("ERR=ARG\r\n");
+            return;
+        }
+        Proto_FmtPerf(&f, p, &st);
+        for (i = 0; i < PERF_HIST_BINS; i++)
+        {
+            RpiFmt_Char(&f, (i == 0u) ? ':' : ',');
+            RpiFmt_U32(&f, st.hist[i]);
+        }
+    }
+    else
+    {
+        RpiFmt_U32(&f, SystemCoreClock);
+        for (i = 0; i < PERF_COUNT; i++)
+        {
+            (void)Perf_Get((perf_probe_t)i, &st);
+            RpiFmt_Char(&f, ';');
+            Proto_FmtPerf(&f, (perf_probe_t)i, &st);
+        }
+    }
+    RpiFmt_Str(&f, "\r\n");
+    Proto_SendFmt(&f);
+}
+
+static void Cmd_PerfRst(const char *arg)
+{
+    Perf_Reset();
+    Proto_ReplyStatus("PERF_RST", HAL_OK);
+}
+
+/* TIME=<t1> : "TIME=<t1>,<t2>,<t3>" (µs, voir rpi_protocol.h). t3 est lu
+ * en dernier, juste avant la mise en file d'émission.
+ */
+static void Cmd_Time(const char *arg)
+{
+    char tx[PROTO_REPLY_LEN];
+    rpi_fmt_t f;
+    char *end;
+    uint64_t t1;
+
+    if (arg[0] < '0' || arg[0] > '9')
+    {
+        Proto_SendString("ERR=ARG\r\n");
+        return;
+    }
+    t1 = (uint64_t)strtoull(arg, &end, 10);
+    if (*end != '\0')
+    {
+        Proto_SendString("ERR=ARG\r\n");
+        return;
+    }
+
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    RpiFmt_Str(&f, "TIME=");
+    RpiFmt_U64(&f, t1);
+    RpiFmt_Char(&f, ',');
+    RpiFmt_U64(&f, Timebase_Extend(s_cmd_us));
+    RpiFmt_Char(&f, ',');
+    RpiFmt_U64(&f, Timebase_Now());
+    RpiFmt_Str(&f, "\r\n");
+    Proto_SendFmt(&f);
+}
+
+/* Applique débit / contrôle de flux, puis oublie la ligne en cours de
+ * réception (octets éventuellement corrompus pendant la bascule)
+ */
+static HAL_StatusTypeDef Proto_ApplyBaud(uint32_t baud, uint32_t flow)
+{
+    HAL_StatusTypeDef st = UartBaud_Set(s_huart, baud, flow);
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    Proto_RxReset();
+    __set_PRIMASK(primask);
+    return st;
+}
+
+/* BAUD=<débit>[,H] : réponse "BAUD=<demandé>,<obtenu>" à l'ancien débit,
+ * puis bascule ; H = contrôle de flux RTS/CTS.
+ */
+static void Cmd_Baud(const char *arg)
+{
+    uint32_t flow = UART_HWCONTROL_NONE;
+    uint32_t actual = 0;
+    const char *end;
+    long rate;
+    unsigned i;
+    rpi_fmt_t f;
+    char tx[PROTO_REPLY_LEN];
+
+    end = Proto_ParseInts(arg, &rate, 1);
+    if (end != NULL && end[0] == ',' && end[1] == 'H' && end[2] == '\0')
+        flow = UART_HWCONTROL_RTS_CTS;
+    else if (end == NULL || *end != '\0')
+        end = NULL;
+
+    for (i = 0; end != NULL && i < sizeof(s_baud_rates) / sizeof(s_baud_rates[0]); i++)
+    {
+        if ((uint32_t)rate == s_baud_rates[i])
+        {
+            actual = UartBaud_Actual(s_huart, (uint32_t)rate);
+            break;
+        }
+    }
+
+    if (actual == 0u)
+    {
+        Proto_SendString("ERR=ARG\r\n");
+        return;
+    }
+
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    RpiFmt_Str(&f, "BAUD=");
+    RpiFmt_U32(&f, (uint32_t)rate);
+    RpiFmt_Char(&f, ',');
+    RpiFmt_U32(&f, actual);
+    RpiFmt_Str(&f, "\r\n");
+    Proto_SendFmt(&f);
+
+    /* Une bascule non confirmée revient au dernier réglage confirmé */
+    if (!s_baud.pending)
+    {
+        s_baud.prev_baud = s_huart->Init.BaudRate;
+        s_baud.prev_flow = s_huart->Init.HwFlowCtl;
+    }
+
+    if (Proto_ApplyBaud((uint32_t)rate, flow) != HAL_OK)
+    {
+        (void)Proto_ApplyBaud(s_baud.prev_baud, s_baud.prev_flow);
+        s_baud.pending = 0;
+        return;
+    }
+
+    s_baud.pending  = 1;
+    s_baud.deadline = HAL_GetTick() + RPI_BAUD_CONFIRM_MS;
+}
+
+/* BAUD_OK : confirmation au nouveau débit -> "BAUD_OK=<débit>[,H]" */
+static void Cmd_BaudOk(const char *arg)
+{
+    rpi_fmt_t f;
+    char tx[PROTO_REPLY_LEN];
+
+    s_baud.pending = 0;
+
+    RpiFmt_Init(&f, tx, sizeof(tx));
+    RpiFmt_Str(&f, "BAUD_OK=");
+    RpiFmt_U32(&f, s_huart->Init.BaudRate);
+    if (s_huart->Init.HwFlowCtl != UART_HWCONTROL_NONE)
+        RpiFmt_Str(&f, ",H");
+    RpiFmt_Str(&f, "\r\n");
+    Proto_SendFmt(&f);
+}
+
+/* Pas de BAUD_OK dans les temps : retour au débit précédent */
+static void Proto_BaudTask(void)
+{
+    if (!s_baud.pending || (int32_t)(HAL_GetTick() - s_baud.deadline) < 0)
+        return;
+
+    s_baud.pending = 0;
+    (void)Proto_ApplyBaud(s_baud.prev_baud, s_baud.prev_flow);
+    LOG_W(LOG_MOD_RPI, "debit non confirme, retour a %lu bauds",
+          (unsigned long)s_baud.prev_baud);
+}
+
+static void Cmd_Help(const char *arg);
+
+/* Présence de l'argument "=<...>" */
+typedef enum
+{
+    PROTO_ARG_NONE     = 0,   /* ignoré s'il est fourni */
+    PROTO_ARG_REQUIRED = 1,   /* absent -> ERR=ARG */
+    PROTO_ARG_OPTIONAL = 2    /* handler appelé avec NULL s'il est absent */
+} proto_arg_t;
+
+typedef struct
+{
+    const char *name;
+    proto_arg_t arg;
+    void (*handler)(const char *arg);   /* arg : texte après '=', ou NULL */
+    const char *syntax;                 /* argument, pour HELP */
+    const char *help;
+} proto_cmd_t;
+
+static const proto_cmd_t s_commands[] =
+{
+    { "GET_T",    PROTO_ARG_NONE,     Cmd_GetT,    "",                      "temperature (C)" },
+    { "GET_P",    PROTO_ARG_NONE,     Cmd_GetP,    "",                      "pression (Pa)" },
+    { "GET_A",    PROTO_ARG_NONE,     Cmd_GetA,    "",                      "angle (deg)" },
+    { "SET_K",    PROTO_ARG_REQUIRED, Cmd_SetK,    "<K x100>",              "coefficient K" },
+    { "GET_K",    PROTO_ARG_NONE,     Cmd_GetK,    "",                      "coefficient K" },
+    { "GET_ALL",  PROTO_ARG_OPTIONAL, Cmd_GetAll,  "[T][P][A][K]",          "instantane: seq,t_us,valeurs" },
+    { "GET_R",    PROTO_ARG_NONE,     Cmd_GetR,    "",                      "periode d'acquisition (ms)" },
+    { "GET_I2C",  PROTO_ARG_NONE,     Cmd_GetI2C,  "",                      "erreurs BMP,IMU,deblocages I2C" },
+    { "GET_TX",   PROTO_ARG_NONE,     Cmd_GetTx,   "",                      "buffers TX: max,rejets Pi puis debug" },
+    { "GET_Q",    PROTO_ARG_NONE,     Cmd_GetQ,    "",                      "file commandes: taille,max,pleine,trop longues" },
+    { "GET_Z",    PROTO_ARG_NONE,     Cmd_GetZ,    "",                      "flux compresse: enr,trames,octets brut,octets Z,cycles/enr" },
+    { "SET_F",    PROTO_ARG_REQUIRED, Cmd_SetF,    "<T|P|A>,<N|E|M|D>,<n>", "filtre d'un canal" },
+    { "GET_F",    PROTO_ARG_REQUIRED, Cmd_GetF,    "<T|P|A>",               "filtre d'un canal" },
+    { "SET_W",    PROTO_ARG_REQUIRED, Cmd_SetW,    "<T|P|A>,<slot>,<ms>",   "fenetre de statistiques" },
+    { "GET_S",    PROTO_ARG_NONE,     Cmd_GetS,    "",                      "statistiques par fenetre" },
+    { "CAP_CFG",  PROTO_ARG_REQUIRED, Cmd_CapCfg,  "<pre>,<post>",          "fenetres de capture IMU" },
+    { "CAP_THR",  PROTO_ARG_REQUIRED, Cmd_CapThr,  "<axe>,<LSB>,<R|F|B>",   "seuil de declenchement" },
+    { "CAP_ARM",  PROTO_ARG_OPTIONAL, Cmd_CapArm,  "[C][V][S]",             "arme la capture" },
+    { "CAP_TRIG", PROTO_ARG_NONE,     Cmd_CapTrig, "",                      "declenchement manuel" },
+    { "CAP_STOP", PROTO_ARG_NONE,     Cmd_CapStop, "",                      "arrete la capture" },
+    { "CAP_STAT", PROTO_ARG_NONE,     Cmd_CapStat, "",                      "etat de la capture" },
+    { "CAP_READ", PROTO_ARG_REQUIRED, Cmd_CapRead, "<k>,<n>",               "lit n echantillons (hex)" },
+    { "SUB",      PROTO_ARG_REQUIRED, Cmd_Sub,     "<TPA>,<ms>",            "flux D=... (0 ms: sur changement)" },
+    { "UNSUB",    PROTO_ARG_NONE,     Cmd_Unsub,   "",                      "arrete le flux" },
+    { "BAUD",     PROTO_ARG_REQUIRED, Cmd_Baud,    "<debit>[,H]",           "change le debit (H: RTS/CTS), BAUD_OK sous 1 s" },
+    { "BAUD_OK",  PROTO_ARG_NONE,     Cmd_BaudOk,  "",                      "confirme le nouveau debit" },
+    { "NODE",     PROTO_ARG_OPTIONAL, Cmd_Node,    "[<adr>]",               "adresse RS-485 (0: point a point)" },
+    { "PAR_LIST", PROTO_ARG_NONE,     Cmd_ParList, "",                      "parametres: nom,valeur,min,max,defaut;..." },
+    { "PAR_GET",  PROTO_ARG_REQUIRED, Cmd_ParGet,  "<nom>",                 "parametre enregistre" },
+    { "PAR_SET",  PROTO_ARG_REQUIRED, Cmd_ParSet,  "<nom>,<valeur>",        "change et enregistre en flash" },
+    { "PAR_STAT", PROTO_ARG_NONE,     Cmd_ParStat, "",                      "EEPROM: page,generation,enr,capacite,CRC,effacements" },
+    { "LOG",      PROTO_ARG_OPTIONAL, Cmd_Log,     "[<mod|*>,<O|E|W|I|D>]",  "traces console: niveaux;lignes,perdues,tronquees" },
+    { "TRC",      PROTO_ARG_NONE,     Cmd_Trc,     "",                      "trace binaire: evenements,perdus:mots hex" },
+    { "GET_PERF", PROTO_ARG_OPTIONAL, Cmd_GetPerf, "[<sonde>]",             "profil cycles: Hz;sonde,n,min,max,moy / histogramme log2" },
+    { "PERF_RST", PROTO_ARG_NONE,     Cmd_PerfRst, "",                      "remet le profil a zero" },
+    { "TIME",     PROTO_ARG_REQUIRED, Cmd_Time,    "<t1 us>",               "synchro: t1,t2 reception,t3 emission (us)" },
+    { "MODE",     PROTO_ARG_REQUIRED, Cmd_Mode,    "BIN|MODBUS[,<adr>]",    "passe en trames binaires / esclave Modbus RTU" },
+    { "HELP",     PROTO_ARG_OPTIONAL, Cmd_Help,    "[<commande>]",          "liste / aide d'une commande" },
+};
+
+#define PROTO_NB_COMMANDS  (sizeof(s_commands) / sizeof(s_commands[0]))
+#define PROTO_NAME_MAX     12u
+
+/* Hachage parfait : table de 128 cases, graine cherchée à l'init pour
+ * qu'aucun nom ne partage une case. s_hash[i] = index + 1 (0 : vide).
+ */
+#define PROTO_HASH_SIZE    128u
+
+static uint8_t s_hash[PROTO_HASH_SIZE];
+static uint8_t s_hash_seed  = 0;
+static uint8_t s_hash_ready = 0;
+
+static uint8_t Proto_Hash(const char *name, size_t len, uint8_t seed)
+{
+    uint32_t h = 2166136261u ^ seed;   /* FNV-1a */
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        h ^= (uint8_t)name[i];
+        h *= 16777619u;
+    }
+    return (uint8_t)((h ^ (h >> 16)) & (PROTO_HASH_SIZE - 1u));
+}
+
+static void Proto_BuildHash(void)
+{
+    uint32_t seed, i;
+    uint8_t  slot;
+
+    for (seed = 0; seed < 256u; seed++)
+    {
+        memset(s_hash, 0, sizeof(s_hash));
+
+        for (i = 0; i < PROTO_NB_COMMANDS; i++)
+        {
+            slot = Proto_Hash(s_commands[i].name, strlen(s_commands[i].name), (uint8_t)seed);
+            if (s_hash[slot] != 0u)
+                break;
+            s_hash[slot] = (uint8_t)(i + 1u);
+        }
+
+        if (i == PROTO_NB_COMMANDS)
+        {
+            s_hash_seed  = (uint8_t)seed;
+            s_hash_ready = 1;
+            return;
+        }
+    }
+
+    /* Aucune graine sans collision : recherche linéaire (toujours correcte) */
+    s_hash_ready = 0;
+    LOG_W(LOG_MOD_RPI, "pas de hachage parfait, recherche lineaire");
+}
+
+static const proto_cmd_t *Proto_FindCommand(const char *name, size_t len)
+{
+    const proto_cmd_t *c;
+    uint32_t i;
+    uint8_t idx;
+
+    if (s_hash_ready)
+    {
+        idx = s_hash[Proto_Hash(name, len, s_hash_seed)];
+        if (idx == 0u)
+            return NULL;
+        c = &s_commands[idx - 1u];
+        return (strncmp(c->name, name, len) == 0 && c->name[len] == '\0') ? c : NULL;
+    }
+
+    for (i = 0; i < PROTO_NB_COMMANDS; i++)
+    {
+        c = &s_commands[i];
+        if (strncmp(c->name, name, len) == 0 && c->name[len] == '\0')
+            return c;
+    }
+    return NULL;
+}
 
-/* Buffer commande */
-#define CMD_BUF_LEN 32
-static char g_cmd_buf[CMD_BUF_LEN];
-static volatile uint8_t g_cmd_idx   = 0;
-static volatile uint8_t g_cmd_ready = 0;
+/* HELP : "HELP=GET_T,GET_P,..." ; HELP=<cmd> : "<cmd>=<argument> : <aide>" */
+static void Cmd_Help(const char *arg)
+{
+    static char tx[8 + PROTO_NB_COMMANDS * (PROTO_NAME_MAX + 1u)];
+    const proto_cmd_t *c;
+    rpi_fmt_t f;
+    uint32_t i;
 
-/* Réception IT (1 byte) */
-static uint8_t s_rx_byte = 0;
+    RpiFmt_Init(&f, tx, sizeof(tx));
 
-static void Proto_SendString(const char *s)
-{
-    if (s_huart == NULL || s == NULL)
+    if (arg == NULL)
+    {
+        RpiFmt_Str(&f, "HELP=");
+        for (i = 0; i < PROTO_NB_COMMANDS; i++)
+        {
+            if (i > 0u)
+                RpiFmt_Char(&f, ',');
+            RpiFmt_Str(&f, s_commands[i].name);
+        }
+        RpiFmt_Str(&f, "\r\n");
+        Proto_SendFmt(&f);
+        return;
+    }
+
+    c = Proto_FindCommand(arg, strlen(arg));
+    if (c == NULL)
+    {
+        Proto_SendString("ERR=ARG\r\n");
         return;
+    }
 
-    HAL_UART_Transmit(s_huart, (uint8_t*)s, (uint16_t)strlen(s), HAL_MAX_DELAY);
+    RpiFmt_Str(&f, c->name);
+    if (c->syntax[0] != '\0')
+    {
+        RpiFmt_Char(&f, '=');
+        RpiFmt_Str(&f, c->syntax);
+    }
+    RpiFmt_Str(&f, " : ");
+    RpiFmt_Str(&f, c->help);
+    RpiFmt_Str(&f, "\r\n");
+    Proto_SendFmt(&f);
 }
 
-static void Proto_HandleCommand(const char *cmd)
+static void Proto_DispatchCommand(const char *cmd)
 {
-    char tx[48];
+    const proto_cmd_t *c;
+    const char *eq;
+    const char *arg;
+    size_t len;
 
     if (cmd == NULL || s_state == NULL)
         return;
 
-    /* GET_T */
-    if (strncmp(cmd, "GET_T", 5) == 0)
+    eq  = strchr(cmd, '=');
+    len = (eq != NULL) ? (size_t)(eq - cmd) : strlen(cmd);
+    arg = (eq != NULL) ? eq + 1 : NULL;
+
+    c = (len <= PROTO_NAME_MAX) ? Proto_FindCommand(cmd, len) : NULL;
+    if (c == NULL)
+    {
+        Proto_SendString("ERR=CMD\r\n");
+        return;
+    }
+
+    if (c->arg == PROTO_ARG_REQUIRED && (arg == NULL || *arg == '\0'))
+    {
+        Proto_SendString("ERR=ARG\r\n");
+        return;
+    }
+
+    c->handler((c->arg == PROTO_ARG_NONE) ? NULL : arg);
+}
+
+/* "#<tag>:<commande>" ou "<commande>" */
+static void Proto_HandleCommand(const char *cmd)
+{
+    uint32_t tag = 0;
+    uint8_t n = 0;
+
+    if (cmd == NULL || cmd[0] != '#')
     {
-        int32_t t = s_state->temp_centi;
-        char sign = '+';
-        if (t < 0) { sign = '-'; t = -t; }
+        Proto_DispatchCommand(cmd);
+        return;
+    }
 
-        int32_t t_int  = t / 100;
-        int32_t t_frac = t % 100;
+    for (cmd++; *cmd >= '0' && *cmd <= '9' && n < 5u; cmd++, n++)
+        tag = tag * 10u + (uint32_t)(*cmd - '0');
 
-        snprintf(tx, sizeof(tx), "T=%c%02ld.%02ld_C\r\n",
-                 sign, (long)t_int, (long)t_frac);
-        Proto_SendString(tx);
+    if (n == 0u || *cmd != ':' || tag > RPI_TAG_MAX)
+    {
+        Proto_SendString("ERR=ARG\r\n");
+        return;
     }
-    /* GET_P */
-    else if (strncmp(cmd, "GET_P", 5) == 0)
+
+    /* Tag recopié tel quel (mêmes chiffres que la requête) */
+    s_pfx_len = (uint8_t)(s_node_pfx_len + n + 2u);
+    memcpy(&s_pfx[s_node_pfx_len], cmd - n - 1, (size_t)n + 2u);
+
+    Proto_DispatchCommand(cmd + 1);
+    s_pfx_len = s_node_pfx_len;
+}
+
+/* --------------------------------------------------------------------------
+ * Mode binaire
+ * -------------------------------------------------------------------------- */
+
+static void Proto_PutU32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)(v);
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint32_t Proto_GetU32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void Proto_PutU64(uint8_t *p, uint64_t v)
+{
+    Proto_PutU32(p, (uint32_t)v);
+    Proto_PutU32(&p[4], (uint32_t)(v >> 32));
+}
+
+static uint64_t Proto_GetU64(const uint8_t *p)
+{
+    return (uint64_t)Proto_GetU32(p) | ((uint64_t)Proto_GetU32(&p[4]) << 32);
+}
+
+static void Proto_SendFrame(uint8_t id, const uint8_t *payload, uint8_t len)
+{
+    uint8_t out[RPI_FRAME_ENC_MAX];
+    uint8_t tagged[RPI_FRAME_PAYLOAD_MAX];
+    size_t n;
+
+    /* Requête enveloppée : réponse enveloppée avec le même tag */
+    if (s_bin_tagged)
     {
-        uint32_t p = s_state->press_pa;
-        snprintf(tx, sizeof(tx), "P=%luPa\r\n", (unsigned long)p);
-        Proto_SendString(tx);
+        if (len > RPI_TAG_PAYLOAD_MAX)
+            return;
+        tagged[0] = (uint8_t)(s_bin_tag & 0xFFu);
+        tagged[1] = (uint8_t)(s_bin_tag >> 8);
+        tagged[2] = id;
+        if (len > 0u)
+            memcpy(&tagged[3], payload, len);
+        id      = RPI_BIN_CMD_TAG;
+        payload = tagged;
+        len     = (uint8_t)(len + 3u);
     }
-    /* SET_K=1234 */
-    else if (strncmp(cmd, "SET_K=", 6) == 0)
+
+    n = RpiFrame_Encode(id, payload, len, out);
+    if (n > 0u)
+        Proto_SendBytes(out, (uint16_t)n);
+}
+
+static void Proto_SendError(uint8_t id, rpi_bin_err_t err)
+{
+    uint8_t code = (uint8_t)err;
+    Proto_SendFrame((uint8_t)(id | RPI_FRAME_ERR_FLAG), &code, 1);
+}
+
+static void Proto_HandleFrame(const uint8_t *buf, uint8_t buf_len)
+{
+    uint8_t payload[RPI_FRAME_PAYLOAD_MAX];
+    uint8_t id, len;
+    uint8_t rep[4];
+
+    if (s_state == NULL)
+        return;
+
+    if (RpiFrame_Decode(buf, buf_len, &id, payload, &len) != 0)
     {
-        const char *value_str = cmd + 6;
-        s_K_centi = (int32_t)atoi(value_str);
+        Proto_SendError(0, RPI_BIN_ERR_CRC);
+        return;
+    }
 
-        snprintf(tx, sizeof(tx), "SET_K=OK\r\n");
-        Proto_SendString(tx);
+    /* Enveloppe : uint16 tag, id, payload de la commande */
+    if (id == RPI_BIN_CMD_TAG)
+    {
+        if (len < 3u)
+        {
+            Proto_SendError(id, RPI_BIN_ERR_ARG);
+            return;
+        }
+        s_bin_tag    = (uint16_t)(payload[0] | ((uint16_t)payload[1] << 8));
+        s_bin_tagged = 1;
+        id           = payload[2];
+        len          = (uint8_t)(len - 3u);
+        memmove(payload, &payload[3], len);
     }
-    /* GET_K */
-    else if (strncmp(cmd, "GET_K", 5) == 0)
+
+    switch ((rpi_bin_cmd_t)id)
+    {
+    case RPI_BIN_CMD_GET_T:
+        Proto_SendCachedFrame(PROTO_CACHE_T);
+        break;
+
+    case RPI_BIN_CMD_GET_P:
+        Proto_SendCachedFrame(PROTO_CACHE_P);
+        break;
+
+    case RPI_BIN_CMD_GET_A:
+        Proto_SendCachedFrame(PROTO_CACHE_A);
+        break;
+
+    case RPI_BIN_CMD_GET_K:
+        Proto_SendCachedFrame(PROTO_CACHE_K);
+        break;
+
+    case RPI_BIN_CMD_SET_K:
+        if (len != 4u)
+        {
+            Proto_SendError(id, RPI_BIN_ERR_ARG);
+            break;
+        }
+        if (!Param_InRange(PARAM_K_CENTI, Proto_GetU32(payload)))
+        {
+            Proto_SendError(id, RPI_BIN_ERR_ARG);
+            break;
+        }
+        if (Param_Set(PARAM_K_CENTI, Proto_GetU32(payload)) != HAL_OK)
+            Proto_SendError(id, RPI_BIN_ERR_FLASH);
+        else
+            Proto_SendFrame(id, NULL, 0);
+        break;
+
+    case RPI_BIN_CMD_GET_R:
+        Proto_PutU32(rep, s_state->period_ms);
+        Proto_SendFrame(id, rep, 4);
+        break;
+
+    case RPI_BIN_CMD_SUB:
+        if ((len != 5u && len != 6u) ||
+            Proto_Subscribe(payload[0], Proto_GetU32(&payload[1]),
+                            (len == 6u) ? payload[5] : 0u) != HAL_OK)
+        {
+            Proto_SendError(id, RPI_BIN_ERR_ARG);
+            break;
+        }
+        Proto_SendFrame(id, NULL, 0);
+        break;
+
+    case RPI_BIN_CMD_UNSUB:
+        s_sub.mask = 0;
+        Proto_SendFrame(id, NULL, 0);
+        break;
+
+    case RPI_BIN_CMD_GET_ALL:
     {
-        int32_t k = s_K_centi;
-        int32_t k_int  = k / 100;
-        int32_t k_frac = k % 100;
-        if (k_frac < 0) k_frac = -k_frac;
+        uint8_t all[PROTO_ALL_PAYLOAD_MAX];
+        proto_snapshot_t snap;
+        uint8_t mask = PROTO_ALL_MASK;
+
+        if (len > 1u || (len == 1u && (payload[0] == 0u || (payload[0] & ~PROTO_ALL_MASK) != 0u)))
+        {
+            Proto_SendError(id, RPI_BIN_ERR_ARG);
+            break;
+        }
+        if (len == 1u)
+            mask = payload[0];
+
+        if (mask == PROTO_ALL_MASK)
+        {
+            Proto_SendCachedFrame(PROTO_CACHE_ALL);
+            break;
+        }
 
-        snprintf(tx, sizeof(tx), "K=%ld.%02ld000\r\n",
-                 (long)k_int, (long)k_frac);
-        Proto_SendString(tx);
+        Proto_TakeSnapshot(&snap);
+        Proto_SendFrame(id, all, Proto_BuildAllPayload(all, &snap, mask));
+        break;
     }
-    /* GET_A */
-    else if (strncmp(cmd, "GET_A", 5) == 0)
+
+    case RPI_BIN_CMD_TIME:
     {
-        int32_t a = s_state->angle_milli; /* 0.001° */
-        int32_t a_int  = a / 1000;
-        int32_t a_frac = a % 1000;
-        if (a_frac < 0) a_frac = -a_frac;
+        uint8_t t[24];
+
+        if (len != 8u)
+        {
+            Proto_SendError(id, RPI_BIN_ERR_ARG);
+            break;
+        }
+        Proto_PutU64(t, Proto_GetU64(payload));
+        Proto_PutU64(&t[8], Timebase_Extend(s_cmd_us));
+        Proto_PutU64(&t[16], Timebase_Now());
+        Proto_SendFrame(id, t, sizeof(t));
+        break;
+    }
+
+    case RPI_BIN_CMD_MODE_ASCII:
+        Proto_SendFrame(id, NULL, 0);
+        s_mode = RPI_MODE_ASCII;
+        break;
+
+    default:
+        Proto_SendError(id, RPI_BIN_ERR_CMD);
+        break;
+    }
+
+    s_bin_tagged = 0;
+}
+
+/* --------------------------------------------------------------------------
+ * Modbus RTU : table des registres (rpi_protocol.h, rpi_mb_*_reg_t)
+ * -------------------------------------------------------------------------- */
+
+static void Proto_MbPut32(uint16_t *regs, unsigned idx, uint32_t v)
+{
+    regs[idx]      = (uint16_t)(v >> 16);
+    regs[idx + 1u] = (uint16_t)(v & 0xFFFFu);
+}
+
+static uint32_t Proto_MbGet32(const uint16_t *regs, unsigned idx)
+{
+    return ((uint32_t)regs[idx] << 16) | regs[idx + 1u];
+}
+
+/* Bloc d'entrée complet, construit à chaque lecture : les valeurs d'une
+ * même réponse viennent du même échantillon.
+ */
+static void Proto_MbInputRegs(uint16_t *regs)
+{
+    proto_snapshot_t snap;
+    uart_tx_stats_t tx = {0};
+    rpi_cmdq_stats_t q;
+    rpi_mb_stats_t mb;
 
-        snprintf(tx, sizeof(tx), "A=%ld.%03ld0\r\n",
-                 (long)a_int, (long)a_frac);
-        Proto_SendString(tx);
+    Proto_TakeSnapshot(&snap);
+    (void)UartTx_GetStats(s_huart, &tx);
+    RpiCmdQ_GetStats(&q);
+    RpiModbus_GetStats(&mb);
+
+    Proto_MbPut32(regs, RPI_MB_IR_TEMP,         (uint32_t)snap.v[SENSORS_CH_TEMP]);
+    Proto_MbPut32(regs, RPI_MB_IR_PRESS,        (uint32_t)snap.v[SENSORS_CH_PRESS]);
+    Proto_MbPut32(regs, RPI_MB_IR_ANGLE,        (uint32_t)snap.v[SENSORS_CH_ANGLE]);
+    Proto_MbPut32(regs, RPI_MB_IR_PERIOD,       s_state->period_ms);
+    Proto_MbPut32(regs, RPI_MB_IR_SEQ,          snap.seq);
+    Proto_MbPut32(regs, RPI_MB_IR_TIME_US,      snap.t_us);
+    Proto_MbPut32(regs, RPI_MB_IR_I2C_BMP_FAIL, SensorsApp_GetBmpBusHealth()->total_fail);
+    Proto_MbPut32(regs, RPI_MB_IR_I2C_IMU_FAIL, mpu9250_get_bus_health()->total_fail);
+    Proto_MbPut32(regs, RPI_MB_IR_I2C_RECOVER,  I2CBus_GetRecoveryCount());
+    Proto_MbPut32(regs, RPI_MB_IR_TX_OVERFLOW,  tx.overflows);
+    Proto_MbPut32(regs, RPI_MB_IR_CMDQ_LOST,    q.overflows + q.too_long);
+    Proto_MbPut32(regs, RPI_MB_IR_MB_FRAMES,    mb.frames);
+    Proto_MbPut32(regs, RPI_MB_IR_MB_CRC,       mb.crc_errors);
+    Proto_MbPut32(regs, RPI_MB_IR_MB_EXCEPT,    mb.exceptions);
+}
+
+static void Proto_MbHoldingRegs(uint16_t *regs)
+{
+    Proto_MbPut32(regs, RPI_MB_HR_K,        Param_Get(PARAM_K_CENTI));
+    Proto_MbPut32(regs, RPI_MB_HR_CTRL_REF, (uint32_t)ValveControl_GetRef());
+    regs[RPI_MB_HR_ADDR] = RpiModbus_GetAddress();
+    regs[RPI_MB_HR_MODE] = (uint16_t)s_mode;
+}
+
+static rpi_mb_ex_t Proto_MbRead(rpi_mb_table_t table, uint16_t addr, uint16_t count,
+                                uint16_t *out)
+{
+    uint16_t regs[RPI_MB_IR_COUNT];
+    uint16_t n;
+
+    if (table == RPI_MB_INPUT)
+    {
+        n = RPI_MB_IR_COUNT;
+        Proto_MbInputRegs(regs);
     }
     else
     {
-        snprintf(tx, sizeof(tx), "ERR=CMD\r\n");
-        Proto_SendString(tx);
+        n = RPI_MB_HR_COUNT;
+        Proto_MbHoldingRegs(regs);
     }
+
+    if ((uint32_t)addr + count > n)
+        return RPI_MB_EX_ADDRESS;
+
+    memcpy(out, &regs[addr], (size_t)count * sizeof(uint16_t));
+    return RPI_MB_EX_NONE;
 }
 
-void RpiProto_Init(UART_HandleTypeDef *huart_rpi, const sensors_state_t *state)
+/* Ecriture appliquée seulement si tout le bloc est valide. Un seul mot
+ * d'une valeur 32 bits peut être écrit (0x06) : l'autre mot est conservé.
+ */
+static rpi_mb_ex_t Proto_MbWrite(uint16_t addr, uint16_t count, const uint16_t *val)
 {
-    s_huart = huart_rpi;
-    s_state = state;
+    uint16_t regs[RPI_MB_HR_COUNT];
+    uint16_t mb_addr, mode;
+    uint32_t k, ref;
+    HAL_StatusTypeDef st = HAL_OK;
+
+    if ((uint32_t)addr + count > RPI_MB_HR_COUNT)
+        return RPI_MB_EX_ADDRESS;
 
-    g_cmd_idx   = 0;
-    g_cmd_ready = 0;
-    s_rx_byte   = 0;
+    Proto_MbHoldingRegs(regs);
+    memcpy(&regs[addr], val, (size_t)count * sizeof(uint16_t));
 
-    /* Lance RX IT sur UART1 */
-    HAL_UART_Receive_IT(s_huart, &s_rx_byte, 1);
+    k       = Proto_MbGet32(regs, RPI_MB_HR_K);
+    ref     = Proto_MbGet32(regs, RPI_MB_HR_CTRL_REF);
+    mb_addr = regs[RPI_MB_HR_ADDR];
+    mode    = regs[RPI_MB_HR_MODE];
+    if (!Param_InRange(PARAM_K_CENTI, k) || !Param_InRange(PARAM_CTRL_REF, ref) ||
+        !Param_InRange(PARAM_MB_ADDR, mb_addr))
+        return RPI_MB_EX_VALUE;
+    if (mode != RPI_MODE_ASCII && mode != RPI_MODE_MODBUS)
+        return RPI_MB_EX_VALUE;
 
-    printf("=== Protocole UART1 pret (Raspberry Pi) ===\r\n");
+    /* Valeurs inchangées : pas d'écriture flash */
+    if (Proto_SetParam(PARAM_K_CENTI, k) != HAL_OK)
+        st = HAL_ERROR;
+    if (Proto_SetParam(PARAM_CTRL_REF, ref) != HAL_OK)
+        st = HAL_ERROR;
+    if (Proto_SetParam(PARAM_MB_ADDR, mb_addr) != HAL_OK)
+        st = HAL_ERROR;
+    if (mode == RPI_MODE_ASCII)
+        s_mb_exit = 1;
+
+    return (st == HAL_OK) ? RPI_MB_EX_NONE : RPI_MB_EX_FAILURE;
+}
+
+static const rpi_mb_map_t s_mb_map = { Proto_MbRead, Proto_MbWrite };
+
+static void Proto_HandleModbus(const uint8_t *req, uint8_t len)
+{
+    uint8_t rsp[RPI_MB_ADU_MAX];
+    uint16_t n;
+
+    n = RpiModbus_Handle(req, len, rsp, sizeof(rsp));
+    if (n > 0u)
+        Proto_SendBytes(rsp, n);
+
+    if (s_mb_exit)
+    {
+        s_mb_exit = 0;
+        RpiModbus_TimerStop();
+        Proto_SetMode(RPI_MODE_ASCII);
+    }
+}
+
+/* Fin de trame RTU : silence de 3,5 caractères (interruption TIM7) */
+static void Proto_OnModbusFrameEnd(void)
+{
+    rpi_cmd_t *slot;
+
+    if (s_mode == RPI_MODE_MODBUS && s_rx_len > 0u && !s_rx_discard)
+    {
+        slot = RpiCmdQ_WriteSlot();
+        slot->len       = s_rx_len;
+        slot->kind      = RPI_CMD_MODBUS;
+        slot->broadcast = 0;   /* géré par rpi_modbus (adresse 0) */
+        slot->rx_us     = s_rx_us;
+        RpiCmdQ_Commit();
+    }
+    Proto_RxReset();
+}
+
+/* Trame compressée en attente émise (pleine ou trop ancienne) */
+static void Proto_StreamFlushZ(void)
+{
+    if (s_tlm.samples == 0u)
+        return;
+
+    Proto_SendFrame(RPI_BIN_MSG_DATA_Z, s_tlm.buf, s_tlm.len);
+    RpiTlm_Sent(&s_tlm);
 }
 
-void RpiProto_OnRxByte(uint8_t ch)
+/**
+ * @brief Pousse les canaux abonnés :
+ *   ASCII  : "D=<seq>,<t_us>,T2345,P101325,A0\r\n" (canaux abonnés uniquement)
+ *   binaire: trame RPI_BIN_MSG_DATA (seq, t_us, puis une valeur int32 par
+ *            canal), ou enregistrements groupés dans RPI_BIN_MSG_DATA_Z
+ *            (rpi_tlm.h, t_us en premier canal)
+ * t_us : horodatage de l'échantillon publié (timebase.h)
+ */
+static void Proto_StreamTask(void)
 {
-    /* Construit la ligne */
-    if (ch == '\r' || ch == '\n')
+    int32_t v[SENSORS_CH_COUNT];
+    uint8_t changed = 0;
+    uint32_t now, t_us;
+    unsigned ch;
+
+    /* En Modbus, l'esclave ne parle que pour répondre : flux suspendu */
+    if (s_sub.mask == 0u || s_state == NULL || s_mode == RPI_MODE_MODBUS)
+        return;
+
+    /* Latence bornée quand les enregistrements arrivent lentement */
+    if (s_tlm.samples > 0u && (HAL_GetTick() - s_sub.batch_tick) >= RPI_TLM_MAX_AGE_MS)
+        Proto_StreamFlushZ();
+
+    for (ch = 0; ch < SENSORS_CH_COUNT; ch++)
+    {
+        v[ch] = Proto_ChannelValue((sensors_channel_t)ch);
+        if ((s_sub.mask & (1u << ch)) && (!s_sub.has_last || v[ch] != s_sub.last[ch]))
+            changed = 1;
+    }
+
+    now = HAL_GetTick();
+    if (s_sub.period_ms == 0u)
+    {
+        if (!changed)
+            return;
+    }
+    else
+    {
+        if ((int32_t)(now - s_sub.next_tick) < 0)
+            return;
+        /* Pas de rattrapage en rafale si la boucle a pris du retard */
+        s_sub.next_tick += s_sub.period_ms;
+        if ((int32_t)(now - s_sub.next_tick) >= 0)
+            s_sub.next_tick = now + s_sub.period_ms;
+    }
+    t_us = s_state->sample_us;
+
+    if (s_mode == RPI_MODE_BIN && s_sub.batch > 0u)
+    {
+        int32_t rec[1u + SENSORS_CH_COUNT];
+        uint8_t n = 0;
+
+        rec[n++] = (int32_t)t_us;
+
+        for (ch = 0; ch < SENSORS_CH_COUNT; ch++)
+        {
+            if (s_sub.mask & (1u << ch))
+                rec[n++] = v[ch];
+        }
+        if (s_tlm.samples == 0u)
+            s_sub.batch_tick = now;
+        if (RpiTlm_Add(&s_tlm, s_sub.seq, rec))
+            Proto_StreamFlushZ();
+    }
+    else if (s_mode == RPI_MODE_BIN)
     {
-        if (g_cmd_idx > 0)
+        uint8_t payload[8u + 4u * SENSORS_CH_COUNT];
+        uint8_t len = 8;
+
+        Proto_PutU32(payload, s_sub.seq);
+        Proto_PutU32(&payload[4], t_us);
+        for (ch = 0; ch < SENSORS_CH_COUNT; ch++)
+        {
+            if (s_sub.mask & (1u << ch))
+            {
+                Proto_PutU32(&payload[len], (uint32_t)v[ch]);
+                len = (uint8_t)(len + 4u);
+            }
+        }
+        Proto_SendFrame(RPI_BIN_MSG_DATA, payload, len);
+    }
+    else
+    {
+        char tx[28 + SENSORS_CH_COUNT * 13];
+        rpi_fmt_t f;
+
+        RpiFmt_Init(&f, tx, sizeof(tx));
+        RpiFmt_Str(&f, "D=");
+        RpiFmt_U32(&f, s_sub.seq);
+        RpiFmt_Char(&f, ',');
+        RpiFmt_U32(&f, t_us);
+        for (ch = 0; ch < SENSORS_CH_COUNT; ch++)
         {
-            g_cmd_buf[g_cmd_idx] = '\0';
-            g_cmd_ready = 1;
+            if (s_sub.mask & (1u << ch))
+            {
+                RpiFmt_Char(&f, ',');
+                RpiFmt_Char(&f, s_ch_letter[ch]);
+                RpiFmt_I32(&f, v[ch]);
+            }
         }
-        g_cmd_idx = 0;
+        RpiFmt_Str(&f, "\r\n");
+        Proto_SendFmt(&f);
+    }
+
+    s_sub.seq++;
+    s_sub.has_last = 1;
+    for (ch = 0; ch < SENSORS_CH_COUNT; ch++)
+        s_sub.last[ch] = v[ch];
+}
+
+/* Adresse reçue en tête de commande : ce nœud, diffusion, ou autre nœud
+ * (commande ignorée jusqu'à sa fin)
+ */
+static void Proto_RxNodeMatch(uint16_t addr)
+{
+    if (addr == s_node)
+        s_rx_node_state = PROTO_NODE_DONE;
+    else if (addr == RPI_NODE_BROADCAST)
+    {
+        s_rx_node_state = PROTO_NODE_DONE;
+        s_rx_broadcast  = 1;
     }
     else
+        s_rx_discard = 1;
+}
+
+/**
+ * @brief Filtre d'adresse multipoint (interruption), avant toute écriture
+ *        dans la file : le trafic des autres nœuds ne coûte rien à la
+ *        boucle principale.
+ *
+ * @return 1 si l'octet fait partie de l'adresse (consommé).
+ */
+static uint8_t Proto_RxNodeFilter(uint8_t kind, uint8_t ch)
+{
+    if (s_rx_node_state == PROTO_NODE_DONE)
+        return 0;
+
+    /* Binaire : un octet d'adresse avant la trame COBS */
+    if (kind == RPI_CMD_FRAME)
     {
-        if (g_cmd_idx < (CMD_BUF_LEN - 1))
+        Proto_RxNodeMatch(ch);
+        return 1;
+    }
+
+    /* ASCII : "@<adresse>:" */
+    if (s_rx_node_state == PROTO_NODE_START)
+    {
+        if (ch == '@')
         {
-            g_cmd_buf[g_cmd_idx++] = (char)ch;
+            s_rx_node_state  = PROTO_NODE_DIGITS;
+            s_rx_node_addr   = 0;
+            s_rx_node_digits = 0;
         }
         else
+            s_rx_discard = 1;
+        return 1;
+    }
+
+    if (ch >= '0' && ch <= '9' && s_rx_node_digits < 3u)
+    {
+        s_rx_node_addr = (uint16_t)(s_rx_node_addr * 10u + (uint16_t)(ch - '0'));
+        s_rx_node_digits++;
+    }
+    else if (ch == ':' && s_rx_node_digits > 0u)
+        Proto_RxNodeMatch(s_rx_node_addr);
+    else
+        s_rx_discard = 1;
+    return 1;
+}
+
+/**
+ * @brief Réception d'un octet (contexte interruption).
+ *        Fin de commande : '\r' / '\n' en ASCII, 0x00 en binaire, silence
+ *        détecté par TIM7 en Modbus (Proto_OnModbusFrameEnd).
+ *        Une commande trop longue ou arrivant file pleine est ignorée
+ *        jusqu'à sa fin (compteurs de rpi_cmdq).
+ */
+static void Proto_OnRxByte(uint8_t ch)
+{
+    uint8_t kind  = (s_mode == RPI_MODE_BIN)    ? RPI_CMD_FRAME :
+                    (s_mode == RPI_MODE_MODBUS) ? RPI_CMD_MODBUS : RPI_CMD_ASCII;
+    uint8_t limit = (kind == RPI_CMD_ASCII) ? (uint8_t)(RPI_CMDQ_SLOT_LEN - 1u) : RPI_CMDQ_SLOT_LEN;
+    uint8_t end;
+    rpi_cmd_t *slot;
+
+    if (kind == RPI_CMD_FRAME)
+        end = (ch == 0u);
+    else if (kind == RPI_CMD_ASCII)
+        end = (ch == '\r' || ch == '\n');
+    else
+        end = 0;   /* RTU : tous les octets sont des données */
+
+    if (end)
+    {
+        if (s_rx_len > 0u && !s_rx_discard)
+        {
+            slot = RpiCmdQ_WriteSlot();
+            slot->len       = s_rx_len;
+            slot->kind      = kind;
+            slot->broadcast = s_rx_broadcast;
+            slot->rx_us     = s_rx_us;
+            if (kind == RPI_CMD_ASCII)
+                slot->data[s_rx_len] = '\0';
+            RpiCmdQ_Commit();
+        }
+        Proto_RxReset();
+        return;
+    }
+
+    if (s_rx_discard)
+        return;
+
+    if (kind == RPI_CMD_MODBUS)
+    {
+        /* RTU : adresse = premier octet, gardé dans la trame (CRC) */
+        if (s_rx_len == 0u && ch != 0u && ch != RpiModbus_GetAddress())
         {
-            g_cmd_idx = 0; /* overflow -> reset */
+            s_rx_discard = 1;
+            return;
         }
     }
+    else if (s_node != RPI_NODE_NONE && Proto_RxNodeFilter(kind, ch))
+        return;
+
+    slot = RpiCmdQ_WriteSlot();
+    if (slot == NULL)
+    {
+        RpiCmdQ_CountOverflow();
+        s_rx_discard = 1;
+    }
+    else if (s_rx_len >= limit)
+    {
+        RpiCmdQ_CountTooLong();
+        s_rx_discard = 1;
+    }
+    else
+    {
+        slot->data[s_rx_len++] = ch;
+    }
+}
+
+/* Bloc reçu par DMA (moitié / fin de buffer ou ligne IDLE) */
+static void Proto_OnRxData(const uint8_t *data, uint16_t len, uint8_t idle)
+{
+    uint16_t i;
+
+    /* Bloc livré à la ligne IDLE : la commande vient de se terminer */
+    if (len > 0u)
+        s_rx_us = Timebase_Now32();
+
+    for (i = 0; i < len; i++)
+        Proto_OnRxByte(data[i]);
+
+    /* Silence de fin de trame compté depuis la ligne IDLE seulement : un
+     * bloc coupé en moitié / fin de buffer peut être suivi du reste de la
+     * trame, moins de t3.5 plus tard
+     */
+    if (s_mode == RPI_MODE_MODBUS)
+    {
+        if (idle)
+            RpiModbus_OnRxActivity();
+        else
+            RpiModbus_OnRxBusy();
+    }
+}
+
+/* Broche DE du transceiver RS-485, à 0 (réception) hors émission */
+static void Proto_InitDriverEnable(void)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    RPI_RS485_DE_CLK_ENABLE();
+    HAL_GPIO_WritePin(RPI_RS485_DE_PORT, RPI_RS485_DE_PIN, GPIO_PIN_RESET);
+    GPIO_InitStruct.Pin   = RPI_RS485_DE_PIN;
+    GPIO_InitStruct.Mode  = GPIO_MODE_OUTPUT_PP;
+    GPIO_InitStruct.Pull  = GPIO_PULLDOWN;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(RPI_RS485_DE_PORT, &GPIO_InitStruct);
+
+    (void)UartTx_SetDriverEnable(s_huart, RPI_RS485_DE_PORT, RPI_RS485_DE_PIN);
+}
+
+void RpiProto_Init(UART_HandleTypeDef *huart_rpi, const sensors_state_t *state)
+{
+    s_huart = huart_rpi;
+    s_state = state;
+
+    s_mode       = RPI_MODE_ASCII;
+    s_sub.mask   = 0;
+    s_sub.batch  = 0;
+    RpiTlm_Init(&s_tlm, 1, 1);
+    Proto_SetNode((uint8_t)Param_Get(PARAM_NODE));
+    Proto_RxReset();
+    RpiCmdQ_Reset();
+
+    Proto_BuildHash();
+    RpiModbus_Init(&s_mb_map, Proto_OnModbusFrameEnd);
+    (void)RpiModbus_SetAddress((uint8_t)Param_Get(PARAM_MB_ADDR));
+
+    Proto_InitDriverEnable();
+
+    /* Lance la réception DMA circulaire sur UART1 */
+    if (UartRx_Start(s_huart, Proto_OnRxData) != HAL_OK)
+        LOG_E(LOG_MOD_RPI, "Erreur RX DMA UART1");
+
+    LOG_I(LOG_MOD_RPI, "=== Protocole UART1 pret (Raspberry Pi) ===");
 }
 
 void RpiProto_Task(void)
 {
-    if (g_cmd_ready)
+    const rpi_cmd_t *c;
+
+    /* Réponses rendues dès la publication, avant l'arrivée des requêtes */
+    Proto_CacheRefresh();
+
+    /* Commandes reçues depuis le dernier passage, dans l'ordre */
+    while ((c = RpiCmdQ_Peek()) != NULL)
     {
-        g_cmd_ready = 0;
-        Proto_HandleCommand(g_cmd_buf);
+        s_reply_mute = c->broadcast;
+        s_cmd_us     = c->rx_us;
+
+        switch (c->kind)
+        {
+        case RPI_CMD_FRAME:
+            Proto_HandleFrame(c->data, c->len);
+            break;
+        case RPI_CMD_MODBUS:
+            Proto_HandleModbus(c->data, c->len);
+            break;
+        default:
+            Proto_HandleCommand((const char *)c->data);
+            break;
+        }
+
+        s_reply_mute = 0;
+        RpiCmdQ_Pop();
     }
+
+    Proto_StreamTask();
+    Proto_BaudTask();
 }
 
 int32_t RpiProto_GetK_centi(void)
 {
-    return s_K_centi;
+    return (int32_t)Param_Get(PARAM_K_CENTI);
+}
+
+rpi_mode_t RpiProto_GetMode(void)
+{
+    return s_mode;
 }
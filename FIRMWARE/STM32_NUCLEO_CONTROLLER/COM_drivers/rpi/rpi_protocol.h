@@ -12,29 +12,164 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "../sensors/sensors_app.h"
+#include "rpi_frame.h"
+
+/* Mode du lien : ASCII (minicom, par défaut), trames binaires (rpi_frame.h)
+ * ou esclave Modbus RTU (rpi_modbus.h).
+ * "MODE=BIN" passe en binaire, la commande RPI_BIN_CMD_MODE_ASCII revient
+ * en ASCII. "MODE=MODBUS[,adresse]" passe en Modbus, l'écriture de 0 dans
+ * RPI_MB_HR_MODE revient en ASCII. Un reset revient toujours en ASCII.
+ */
+typedef enum
+{
+    RPI_MODE_ASCII  = 0,
+    RPI_MODE_BIN    = 1,
+    RPI_MODE_MODBUS = 2
+} rpi_mode_t;
+
+/* Commandes binaires (id de trame). Réponse : même id, payload little-endian.
+ * En cas d'erreur : id | RPI_FRAME_ERR_FLAG, payload = 1 octet RPI_BIN_ERR_*.
+ */
+typedef enum
+{
+    RPI_BIN_CMD_GET_T      = 0x01,  /* -> int32  temp_centi  */
+    RPI_BIN_CMD_GET_P      = 0x02,  /* -> uint32 press_pa    */
+    RPI_BIN_CMD_GET_A      = 0x03,  /* -> int32  angle_milli */
+    RPI_BIN_CMD_GET_K      = 0x04,  /* -> int32  K_centi     */
+    RPI_BIN_CMD_SET_K      = 0x05,  /* int32 K_centi -> (vide), enregistré (param.h) */
+    RPI_BIN_CMD_GET_R      = 0x06,  /* -> uint32 period_ms   */
+    RPI_BIN_CMD_SUB        = 0x07,  /* uint8 masque canaux, uint32 période ms,
+                                       [uint8 lot : 0 = MSG_DATA, 1..16 = MSG_DATA_Z] -> (vide) */
+    RPI_BIN_CMD_UNSUB      = 0x08,  /* -> (vide) */
+    RPI_BIN_CMD_GET_ALL    = 0x09,  /* [uint8 masque T,P,A,K] -> uint32 seq, uint32 t_us,
+                                       puis int32 par valeur demandée */
+    RPI_BIN_CMD_TIME       = 0x0A,  /* uint64 t1 -> uint64 t1, t2, t3 (voir TIME) */
+    RPI_BIN_MSG_DATA       = 0x10,  /* poussé : uint32 seq, uint32 t_us, puis int32 par
+                                       canal abonné */
+    RPI_BIN_MSG_DATA_Z     = 0x11,  /* poussé : enregistrements compressés (rpi_tlm.h) */
+    RPI_BIN_CMD_TAG        = 0x7E,  /* uint16 tag, id, payload -> uint16 tag, id réponse,
+                                       payload réponse (RPI_TAG_PAYLOAD_MAX au plus) */
+    RPI_BIN_CMD_MODE_ASCII = 0x7F   /* -> (vide), puis retour en ASCII */
+} rpi_bin_cmd_t;
+
+/* Abonnement (SUB) : période d'émission bornée, 0 = sur changement */
+#define RPI_SUB_PERIOD_MIN_MS   10u
+#define RPI_SUB_PERIOD_MAX_MS   60000u
+
+/* Identifiant de requête, renvoyé dans la réponse pour apparier requêtes
+ * et réponses quand plusieurs commandes sont en vol :
+ *   ASCII  : "#<tag>:<commande>" -> "#<tag>:<réponse>"  (tag 0..65535)
+ *   binaire: commande enveloppée dans RPI_BIN_CMD_TAG
+ * Les données poussées (D=..., RPI_BIN_MSG_DATA) ne portent pas de tag.
+ */
+#define RPI_TAG_MAX             65535u
+#define RPI_TAG_PAYLOAD_MAX     (RPI_FRAME_PAYLOAD_MAX - 3u)
+
+/* Bus RS-485 multipoint : plusieurs STM32 sur la même paire, interrogés
+ * à tour de rôle par le Raspberry Pi. "NODE=<adresse>" active l'adressage
+ * (adresse enregistrée en flash, param.h) :
+ *   ASCII  : "@<adresse>:<commande>" -> "@<adresse>:<réponse>"
+ *            (avant l'éventuel tag : "@3:#12:GET_T")
+ *   binaire: octet d'adresse avant la trame COBS, dans les deux sens
+ * Les commandes d'un autre nœud sont ignorées dès la réception ; celles
+ * envoyées à RPI_NODE_BROADCAST sont exécutées sans réponse.
+ * En Modbus, l'adresse esclave (rpi_modbus.h) joue ce rôle.
+ * Pas d'abonnement (SUB) sur un bus partagé : les nœuds ne parlent que
+ * lorsqu'ils sont interrogés.
+ */
+#define RPI_NODE_NONE           0u      /* liaison point à point, sans préfixe */
+#define RPI_NODE_BROADCAST      255u
+#define RPI_NODE_DEFAULT        RPI_NODE_NONE
+
+/* Broche DE (et /RE) du transceiver, pilotée par uart_tx : 1 pendant
+ * l'émission, 0 après le dernier bit de stop (interruption TC)
+ */
+#define RPI_RS485_DE_PORT       GPIOA
+#define RPI_RS485_DE_PIN        GPIO_PIN_8
+#define RPI_RS485_DE_CLK_ENABLE __HAL_RCC_GPIOA_CLK_ENABLE
+
+/* Négociation de débit (BAUD=) : sans BAUD_OK reçu au nouveau débit dans
+ * ce délai, le STM32 revient au débit précédent.
+ */
+#define RPI_BAUD_DEFAULT        115200u
+#define RPI_BAUD_CONFIRM_MS     1000u
+
+/* Synchronisation d'horloge, type NTP ("TIME=<t1>" -> "TIME=<t1>,<t2>,<t3>") :
+ *   t1 : heure du Pi à l'émission (µs, renvoyée telle quelle)
+ *   t2 : base de temps STM32 (timebase.h) à la livraison du bloc DMA qui
+ *        contient la fin de la requête, soit à la ligne IDLE, un caractère
+ *        après le terminateur ('\n' ou délimiteur 0x00). Correction côté
+ *        Pi : t2 - (longueur de la requête + 1) caractères (stm32_time.py).
+ *        Requête terminée pile sur la moitié / fin du buffer de réception :
+ *        bloc livré à ce moment, un caractère plus tôt.
+ *   t3 : base de temps STM32 juste avant l'émission de la réponse
+ * Le Pi note t4 à la réception et en déduit décalage et dérive ; les
+ * horodatages t_us (échantillons, flux, capture) sont les 32 bits bas de
+ * cette même base de temps.
+ */
+
+/* Registres Modbus. Les valeurs 32 bits occupent deux registres, mot de
+ * poids fort en premier. Tout le bloc d'entrée se lit en une requête 0x04
+ * (adresse 0, RPI_MB_IR_COUNT registres).
+ */
+typedef enum
+{
+    RPI_MB_IR_TEMP         = 0,    /* int32  0.01 °C */
+    RPI_MB_IR_PRESS        = 2,    /* uint32 Pa */
+    RPI_MB_IR_ANGLE        = 4,    /* int32  0.001° */
+    RPI_MB_IR_PERIOD       = 6,    /* uint32 période d'acquisition (ms) */
+    RPI_MB_IR_SEQ          = 8,    /* uint32 sample_seq */
+    RPI_MB_IR_TIME_US      = 10,   /* uint32 horodatage de l'échantillon (µs) */
+    RPI_MB_IR_I2C_BMP_FAIL = 12,   /* uint32 échecs I2C BMP280 */
+    RPI_MB_IR_I2C_IMU_FAIL = 14,   /* uint32 échecs I2C MPU9250 */
+    RPI_MB_IR_I2C_RECOVER  = 16,   /* uint32 recouvrements du bus I2C */
+    RPI_MB_IR_TX_OVERFLOW  = 18,   /* uint32 messages perdus en émission UART1 */
+    RPI_MB_IR_CMDQ_LOST    = 20,   /* uint32 commandes perdues (file pleine, trop longues) */
+    RPI_MB_IR_MB_FRAMES    = 22,   /* uint32 requêtes Modbus traitées */
+    RPI_MB_IR_MB_CRC       = 24,   /* uint32 trames Modbus rejetées */
+    RPI_MB_IR_MB_EXCEPT    = 26,   /* uint32 réponses d'exception */
+    RPI_MB_IR_COUNT        = 28
+} rpi_mb_input_reg_t;
+
+typedef enum
+{
+    RPI_MB_HR_K            = 0,    /* int32  K en 1/100 */
+    RPI_MB_HR_CTRL_REF     = 2,    /* int32  consigne de température (vanne et cadence), 0.01 °C */
+    RPI_MB_HR_ADDR         = 4,    /* uint16 adresse esclave (1..247) */
+    RPI_MB_HR_MODE         = 5,    /* uint16 rpi_mode_t : 0 = retour ASCII après la réponse */
+    RPI_MB_HR_COUNT        = 6
+} rpi_mb_holding_reg_t;
+
+typedef enum
+{
+    RPI_BIN_ERR_CMD = 1,   /* commande inconnue */
+    RPI_BIN_ERR_ARG = 2,   /* payload invalide */
+    RPI_BIN_ERR_CRC = 3,   /* trame corrompue (id 0x80) */
+    RPI_BIN_ERR_FLASH = 4  /* valeur appliquée mais non enregistrée (param.h) */
+} rpi_bin_err_t;
 
 /**
  * @brief Initialise le protocole UART vers Raspberry Pi.
- *        Lance la réception IT sur UART1.
+ *        Lance la réception DMA circulaire sur UART1 (uart_rx.h) : les
+ *        octets reçus construisent une ligne (ASCII) ou une trame
+ *        jusqu'au 0x00 (binaire).
  *
  * @param huart_rpi  UART vers Raspberry (ex: &huart1)
  * @param state      Pointeur vers l'état capteurs (SensorsApp_GetState())
  */
 void RpiProto_Init(UART_HandleTypeDef *huart_rpi, const sensors_state_t *state);
 
-/**
- * @brief À appeler depuis HAL_UART_RxCpltCallback() quand un byte est reçu sur UART1.
- */
-void RpiProto_OnRxByte(uint8_t ch);
-
 /**
  * @brief À appeler dans la boucle principale :
- *        traite une commande complète si disponible.
+ *        traite une commande complète si disponible,
+ *        puis pousse les canaux abonnés (SUB) si nécessaire.
  */
 void RpiProto_Task(void);
 
 int32_t RpiProto_GetK_centi(void);
 
+rpi_mode_t RpiProto_GetMode(void);
+
 
 #endif /* RPI_PROTOCOL_H_ */
 
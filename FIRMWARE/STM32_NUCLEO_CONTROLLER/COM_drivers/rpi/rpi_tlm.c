@@ -0,0 +1,103 @@
+/*
+ * rpi_tlm.c
+ *
+ *  Created on: Feb 2, 2026
+ *      Author: penel
+ */
+
+#include "rpi_tlm.h"
+#include "main.h"
+#include "../time/perf.h"
+
+/* Octets ajoutés au payload sur la ligne : id, len, crc16, COBS, 0x00 */
+#define TLM_FRAME_OVERHEAD     6u
+
+uint8_t RpiTlm_PutVarint(uint8_t *p, uint32_t v)
+{
+    uint8_t n = 0;
+
+    while (v >= 0x80u)
+    {
+        p[n++] = (uint8_t)(v | 0x80u);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+void RpiTlm_Init(rpi_tlm_enc_t *e, uint8_t n_ch, uint8_t batch)
+{
+    if (n_ch > RPI_TLM_CH_MAX)
+        n_ch = RPI_TLM_CH_MAX;
+    if (batch == 0u)
+        batch = 1u;
+    if (batch > RPI_TLM_BATCH_MAX)
+        batch = RPI_TLM_BATCH_MAX;
+
+    e->n_ch      = n_ch;
+    e->batch     = batch;
+    e->samples   = 0;
+    e->len       = 0;
+    e->has_prev  = 0;
+    e->since_key = 0;
+
+    e->stats.samples   = 0;
+    e->stats.frames    = 0;
+    e->stats.raw_bytes = 0;
+    e->stats.enc_bytes = 0;
+    e->stats.cycles    = 0;
+
+    /* Coût de codage en cycles (compteur DWT, perf.h) */
+    Perf_CounterEnable();
+}
+
+uint8_t RpiTlm_Add(rpi_tlm_enc_t *e, uint32_t seq, const int32_t *v)
+{
+    uint32_t t0 = Perf_Now();
+    uint32_t d;
+    uint8_t ch, full;
+
+    /* En-tête ; trame clé au démarrage puis à intervalle fixe */
+    if (e->samples == 0u)
+    {
+        if (e->since_key >= RPI_TLM_KEY_INTERVAL)
+            e->has_prev = 0;
+
+        e->buf[0] = e->has_prev ? 0u : RPI_TLM_KEY;
+        e->len    = (uint8_t)(1u + RpiTlm_PutVarint(&e->buf[1], seq));
+        if (!e->has_prev)
+            e->since_key = 0;
+    }
+
+    for (ch = 0; ch < e->n_ch; ch++)
+    {
+        /* Différence modulo 2^32 : pas de débordement signé */
+        d = e->has_prev ? (uint32_t)v[ch] - (uint32_t)e->prev[ch] : (uint32_t)v[ch];
+        e->len = (uint8_t)(e->len + RpiTlm_PutVarint(&e->buf[e->len], RpiTlm_Zigzag((int32_t)d)));
+        e->prev[ch] = v[ch];
+    }
+
+    e->has_prev = 1;
+    e->samples++;
+    e->since_key++;
+
+    /* Pleine si le prochain enregistrement risque de ne pas tenir */
+    full = (e->samples >= e->batch) ||
+           ((uint32_t)e->len + RPI_TLM_VARINT_MAX * e->n_ch > sizeof(e->buf));
+
+    e->stats.samples++;
+    e->stats.raw_bytes += TLM_FRAME_OVERHEAD + 4u + 4u * e->n_ch;
+    e->stats.cycles    += Perf_Now() - t0;
+    return full;
+}
+
+void RpiTlm_Sent(rpi_tlm_enc_t *e)
+{
+    if (e->samples == 0u)
+        return;
+
+    e->stats.frames++;
+    e->stats.enc_bytes += TLM_FRAME_OVERHEAD + e->len;
+    e->samples = 0;
+    e->len     = 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * rpi_tlm.h
+ *
+ *  Created on: Feb 2, 2026
+ *      Author: penel
+ */
+
+#ifndef RPI_TLM_H_
+#define RPI_TLM_H_
+
+#include <stdint.h>
+#include "rpi_frame.h"
+
+/*
+ * Télémétrie compressée (abonnement binaire, RPI_BIN_MSG_DATA_Z) :
+ *
+ *   flags | varint seq | enregistrement | enregistrement | ...
+ *
+ *  - enregistrement : un varint par canal : t_us (rpi_protocol.c) puis
+ *    les canaux abonnés (ordre T, P, A)
+ *  - valeur : zigzag(v - v précédent), modulo 2^32 ; dans une trame clé
+ *    (flags & RPI_TLM_KEY), le premier enregistrement est absolu
+ *  - seq : numéro du premier enregistrement de la trame, +1 par suivant
+ *  - varint : 7 bits par octet, poids faible en premier, bit 7 = suite
+ *
+ * Une trame clé au moins toutes les RPI_TLM_KEY_INTERVAL valeurs : après
+ * une trame perdue (trou dans seq), le décodeur reprend à la clé suivante.
+ */
+
+#define RPI_TLM_KEY            0x01u
+#define RPI_TLM_CH_MAX         4u
+#define RPI_TLM_BATCH_MAX      16u     /* enregistrements par trame */
+#define RPI_TLM_KEY_INTERVAL   64u
+#define RPI_TLM_VARINT_MAX     5u      /* uint32 */
+
+/* Trame en attente émise au plus tard après ce délai (abonnement lent) */
+#define RPI_TLM_MAX_AGE_MS     250u
+
+typedef struct
+{
+    uint32_t samples;      /* enregistrements codés */
+    uint32_t frames;       /* trames émises */
+    uint32_t raw_bytes;    /* octets sur la ligne en RPI_BIN_MSG_DATA */
+    uint32_t enc_bytes;    /* octets sur la ligne en RPI_BIN_MSG_DATA_Z */
+    uint32_t cycles;       /* cycles CPU de codage (DWT) */
+} rpi_tlm_stats_t;
+
+typedef struct
+{
+    uint8_t  n_ch;
+    uint8_t  batch;
+    uint8_t  samples;      /* enregistrements dans buf */
+    uint8_t  len;          /* octets utiles de buf */
+    uint8_t  has_prev;
+    uint16_t since_key;
+    int32_t  prev[RPI_TLM_CH_MAX];
+    uint8_t  buf[RPI_FRAME_PAYLOAD_MAX];
+    rpi_tlm_stats_t stats;
+} rpi_tlm_enc_t;
+
+static inline uint32_t RpiTlm_Zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+/* @return octets écrits (1..RPI_TLM_VARINT_MAX) */
+uint8_t RpiTlm_PutVarint(uint8_t *p, uint32_t v);
+
+/**
+ * @brief Remet le codeur à zéro (statistiques comprises) : la trame
+ *        suivante est une trame clé.
+ *
+ * @param n_ch   canaux par enregistrement (1..RPI_TLM_CH_MAX)
+ * @param batch  enregistrements par trame (1..RPI_TLM_BATCH_MAX)
+ */
+void RpiTlm_Init(rpi_tlm_enc_t *e, uint8_t n_ch, uint8_t batch);
+
+/**
+ * @brief Ajoute un enregistrement à la trame en cours.
+ *
+ * @return 1 si la trame (buf, len) est pleine : l'émettre puis appeler
+ *         RpiTlm_Sent().
+ */
+uint8_t RpiTlm_Add(rpi_tlm_enc_t *e, uint32_t seq, const int32_t *v);
+
+/**
+ * @brief Trame émise : la suivante repart de zéro.
+ */
+void RpiTlm_Sent(rpi_tlm_enc_t *e);
+
+#endif /* RPI_TLM_H_ */
@@ -19,13 +19,7 @@ static HAL_StatusTypeDef bmp280_read_regs(BMP280_HandleTypedef *dev,
                                           uint8_t *pData,
                                           uint16_t size)
 {
-    return HAL_I2C_Mem_Read(dev->hi2c,
-                            dev->i2c_addr,
-                            reg,
-                            I2C_MEMADD_SIZE_8BIT,
-                            pData,
-                            size,
-                            HAL_MAX_DELAY);
+    return I2CBus_MemRead(dev->hi2c, &dev->bus, reg, pData, size);
 }
 
 /**
@@ -35,13 +29,7 @@ static HAL_StatusTypeDef bmp280_write_reg(BMP280_HandleTypedef *dev,
                                           uint8_t reg,
                                           uint8_t value)
 {
-    return HAL_I2C_Mem_Write(dev->hi2c,
-                             dev->i2c_addr,
-                             reg,
-                             I2C_MEMADD_SIZE_8BIT,
-                             &value,
-                             1,
-                             HAL_MAX_DELAY);
+    return I2CBus_MemWrite(dev->hi2c, &dev->bus, reg, &value, 1);
 }
 
 /* --------------------------------------------------------------------------
@@ -152,6 +140,7 @@ HAL_StatusTypeDef BMP280_Init(BMP280_HandleTypedef *dev,
     dev->hi2c     = hi2c;
     dev->i2c_addr = i2c_addr;
     dev->t_fine   = 0;
+    I2CBus_DevInit(&dev->bus, i2c_addr);
 
     /* Vérification du chip ID */
     ret = BMP280_ReadID(dev, &id);
@@ -10,6 +10,7 @@
 
 #include "main.h"   // Contient normalement stm32f4xx_hal.h et les types HAL
 #include <stdint.h>
+#include "i2c_bus.h"
 
 /* --------------------------------------------------------------------------
  * Définitions de types entiers spécifiques BMP280
@@ -80,6 +81,7 @@ typedef struct
  *  - i2c_addr : adresse I2C (7 bits décalés à gauche, ex: 0x77<<1)
  *  - calib    : coefficients d'étalonnage (remplis une fois à l'init)
  *  - t_fine   : variable interne utilisée par la compensation (datasheet)
+ *  - bus      : compteurs d'erreurs / backoff I2C du composant
  */
 typedef struct
 {
@@ -87,6 +89,7 @@ typedef struct
     uint8_t            i2c_addr;
     BMP280_CalibData_t calib;
     BMP280_S32_t       t_fine;
+    i2c_bus_dev_t      bus;
 } BMP280_HandleTypedef;
 
 /* --------------------------------------------------------------------------
@@ -0,0 +1,252 @@
+/*
+ * i2c_bus.c
+ *
+ *  Created on: Jan 12, 2026
+ *      Author: penel
+ */
+
+#include "i2c_bus.h"
+#include "../log/trace.h"
+#include "../time/perf.h"
+
+/* Nombre total de déblocages du bus */
+static uint32_t s_recoveries = 0;
+
+/* --------------------------------------------------------------------------
+ * Fonctions internes
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief  Attente active courte (quelques µs) pour le bit-banging SCL/SDA.
+ *         Approximatif (~4 cycles par itération), suffisant à 100/400 kHz.
+ */
+static void i2c_bus_delay_us(uint32_t us)
+{
+    volatile uint32_t n = us * (SystemCoreClock / 4000000u);
+
+    while (n--)
+    {
+        __NOP();
+    }
+}
+
+/**
+ * @brief  Timeout (ms) d'une transaction registre de `size` octets.
+ *
+ *         Trame : adresse + registre + adresse (restart) + données,
+ *         soit (size + 3) octets de 9 bits (8 bits + ACK).
+ */
+static uint32_t i2c_bus_timeout_ms(const I2C_HandleTypeDef *hi2c, uint16_t size)
+{
+    uint32_t speed = hi2c->Init.ClockSpeed;
+    uint32_t bits  = ((uint32_t)size + 3u) * 9u;
+    uint32_t us;
+
+    if (speed == 0u)
+        speed = 100000u;
+
+    us = (bits * 1000u) / (speed / 1000u);
+
+    return (us + 999u) / 1000u + I2C_BUS_TIMEOUT_MARGIN_MS;
+}
+
+/**
+ * @brief  Retourne 1 si le composant est en backoff (transaction à sauter).
+ */
+static int i2c_bus_in_backoff(i2c_bus_dev_t *dev)
+{
+    if (dev->backoff_ms == 0u)
+        return 0;
+
+    if ((int32_t)(HAL_GetTick() - dev->retry_tick) >= 0)
+        return 0;
+
+    dev->skipped++;
+    return 1;
+}
+
+/**
+ * @brief  Mise à jour des compteurs après une transaction et, si le bus
+ *         semble bloqué, déclenchement du déblocage.
+ */
+static void i2c_bus_account(I2C_HandleTypeDef *hi2c,
+                            i2c_bus_dev_t *dev,
+                            HAL_StatusTypeDef ret)
+{
+    uint32_t err;
+
+    if (ret == HAL_OK)
+    {
+        dev->consec_fail = 0;
+        dev->backoff_ms  = 0;
+        return;
+    }
+
+    err = HAL_I2C_GetError(hi2c);
+
+    if (dev->consec_fail < 0xFFFFu)
+        dev->consec_fail++;
+    dev->total_fail++;
+
+    /* Backoff exponentiel : 10, 20, 40 ... ms, plafonné */
+    if (dev->backoff_ms == 0u)
+        dev->backoff_ms = I2C_BUS_BACKOFF_MIN_MS;
+    else if (dev->backoff_ms < I2C_BUS_BACKOFF_MAX_MS)
+        dev->backoff_ms *= 2u;
+
+    if (dev->backoff_ms > I2C_BUS_BACKOFF_MAX_MS)
+        dev->backoff_ms = I2C_BUS_BACKOFF_MAX_MS;
+
+    TRACE4("I2C echec adr=0x%02X ret=%u err=0x%X serie=%u",
+           dev->addr, ret, err, dev->consec_fail);
+
+    dev->retry_tick = HAL_GetTick() + dev->backoff_ms;
+
+    /* Un simple NACK (composant absent) ne bloque pas le bus.
+     * Timeout, bus occupé, erreur de bus ou perte d'arbitrage : on débloque.
+     */
+    if (ret == HAL_TIMEOUT || ret == HAL_BUSY ||
+        (err & (HAL_I2C_ERROR_BERR | HAL_I2C_ERROR_ARLO | HAL_I2C_ERROR_TIMEOUT)) != 0u)
+    {
+        dev->recoveries++;
+        (void)I2CBus_Recover(hi2c);
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * API
+ * -------------------------------------------------------------------------- */
+
+void I2CBus_DevInit(i2c_bus_dev_t *dev, uint16_t addr)
+{
+    dev->addr        = addr;
+    dev->consec_fail = 0;
+    dev->total_fail  = 0;
+    dev->recoveries  = 0;
+    dev->skipped     = 0;
+    dev->backoff_ms  = 0;
+    dev->retry_tick  = 0;
+}
+
+HAL_StatusTypeDef I2CBus_MemRead(I2C_HandleTypeDef *hi2c,
+                                 i2c_bus_dev_t *dev,
+                                 uint8_t reg,
+                                 uint8_t *pData,
+                                 uint16_t size)
+{
+    HAL_StatusTypeDef ret;
+
+    if (i2c_bus_in_backoff(dev))
+        return HAL_BUSY;
+
+    /* Bus déjà bloqué (SDA maintenue à 0) : inutile d'attendre les 25 ms
+     * internes de la HAL sur le flag BUSY, on débloque tout de suite.
+     */
+    if (__HAL_I2C_GET_FLAG(hi2c, I2C_FLAG_BUSY) != RESET)
+    {
+        ret = HAL_BUSY;
+    }
+    else
+    {
+        PERF_BEGIN(PERF_I2C);
+        ret = HAL_I2C_Mem_Read(hi2c,
+                               dev->addr,
+                               reg,
+                               I2C_MEMADD_SIZE_8BIT,
+                               pData,
+                               size,
+                               i2c_bus_timeout_ms(hi2c, size));
+        PERF_END(PERF_I2C);
+    }
+
+    i2c_bus_account(hi2c, dev, ret);
+    return ret;
+}
+
+HAL_StatusTypeDef I2CBus_MemWrite(I2C_HandleTypeDef *hi2c,
+                                  i2c_bus_dev_t *dev,
+                                  uint8_t reg,
+                                  uint8_t *pData,
+                                  uint16_t size)
+{
+    HAL_StatusTypeDef ret;
+
+    if (i2c_bus_in_backoff(dev))
+        return HAL_BUSY;
+
+    if (__HAL_I2C_GET_FLAG(hi2c, I2C_FLAG_BUSY) != RESET)
+    {
+        ret = HAL_BUSY;
+    }
+    else
+    {
+        PERF_BEGIN(PERF_I2C);
+        ret = HAL_I2C_Mem_Write(hi2c,
+                                dev->addr,
+                                reg,
+                                I2C_MEMADD_SIZE_8BIT,
+                                pData,
+                                size,
+                                i2c_bus_timeout_ms(hi2c, size));
+        PERF_END(PERF_I2C);
+    }
+
+    i2c_bus_account(hi2c, dev, ret);
+    return ret;
+}
+
+HAL_StatusTypeDef I2CBus_Recover(I2C_HandleTypeDef *hi2c)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+    uint32_t i;
+
+    s_recoveries++;
+    TRACE1("I2C deblocage n=%u", s_recoveries);
+
+    /* Libère les broches de la fonction alternative I2C */
+    (void)HAL_I2C_DeInit(hi2c);
+
+    __HAL_RCC_GPIOB_CLK_ENABLE();
+
+    HAL_GPIO_WritePin(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN, GPIO_PIN_SET);
+    HAL_GPIO_WritePin(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, GPIO_PIN_SET);
+
+    GPIO_InitStruct.Pin   = I2C_BUS_SCL_PIN;
+    GPIO_InitStruct.Mode  = GPIO_MODE_OUTPUT_OD;
+    GPIO_InitStruct.Pull  = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    HAL_GPIO_Init(I2C_BUS_SCL_PORT, &GPIO_InitStruct);
+
+    GPIO_InitStruct.Pin = I2C_BUS_SDA_PIN;
+    HAL_GPIO_Init(I2C_BUS_SDA_PORT, &GPIO_InitStruct);
+
+    /* 9 coups d'horloge : l'esclave termine l'octet en cours et relâche SDA */
+    for (i = 0; i < 9u; i++)
+    {
+        if (HAL_GPIO_ReadPin(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN) == GPIO_PIN_SET)
+            break;
+
+        HAL_GPIO_WritePin(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN, GPIO_PIN_RESET);
+        i2c_bus_delay_us(5);
+        HAL_GPIO_WritePin(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN, GPIO_PIN_SET);
+        i2c_bus_delay_us(5);
+    }
+
+    /* Condition STOP : SDA 0 -> 1 pendant que SCL = 1 */
+    HAL_GPIO_WritePin(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN, GPIO_PIN_RESET);
+    i2c_bus_delay_us(5);
+    HAL_GPIO_WritePin(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, GPIO_PIN_RESET);
+    i2c_bus_delay_us(5);
+    HAL_GPIO_WritePin(I2C_BUS_SCL_PORT, I2C_BUS_SCL_PIN, GPIO_PIN_SET);
+    i2c_bus_delay_us(5);
+    HAL_GPIO_WritePin(I2C_BUS_SDA_PORT, I2C_BUS_SDA_PIN, GPIO_PIN_SET);
+    i2c_bus_delay_us(5);
+
+    /* Réinitialisation complète (HAL_I2C_MspInit reconfigure les broches) */
+    return HAL_I2C_Init(hi2c);
+}
+
+uint32_t I2CBus_GetRecoveryCount(void)
+{
+    return s_recoveries;
+}
@@ -0,0 +1,104 @@
+/*
+ * i2c_bus.h
+ *
+ *  Created on: Jan 12, 2026
+ *      Author: penel
+ */
+
+#ifndef I2C_BUS_H_
+#define I2C_BUS_H_
+
+#include "main.h"
+#include <stdint.h>
+
+/* --------------------------------------------------------------------------
+ * Broches du bus I2C1 (voir HAL_I2C_MspInit) : utilisées pour le
+ * déblocage manuel du bus (9 coups d'horloge + STOP).
+ * -------------------------------------------------------------------------- */
+#define I2C_BUS_SCL_PORT          GPIOB
+#define I2C_BUS_SCL_PIN           GPIO_PIN_6
+#define I2C_BUS_SDA_PORT          GPIOB
+#define I2C_BUS_SDA_PIN           GPIO_PIN_7
+
+/* Marge ajoutée au temps théorique d'une transaction (ms).
+ * HAL_GetTick() a une résolution de 1 ms : 2 ms minimum garantissent
+ * au moins une milliseconde complète avant de déclarer un timeout.
+ */
+#define I2C_BUS_TIMEOUT_MARGIN_MS 2u
+
+/* Backoff exponentiel après échecs consécutifs : 10 ms, 20 ms, ... 5 s max */
+#define I2C_BUS_BACKOFF_MIN_MS    10u
+#define I2C_BUS_BACKOFF_MAX_MS    5000u
+
+/**
+ * @brief  État de santé d'un composant sur le bus I2C.
+ *
+ *  - addr          : adresse I2C (7 bits décalés à gauche, format HAL)
+ *  - consec_fail   : nombre d'échecs consécutifs (remis à 0 au 1er succès)
+ *  - total_fail    : nombre total d'échecs depuis le démarrage
+ *  - recoveries    : nombre de déblocages du bus déclenchés par ce composant
+ *  - skipped       : transactions non tentées car le composant est en backoff
+ *  - backoff_ms    : durée du backoff courant (0 = composant sain)
+ *  - retry_tick    : HAL_GetTick() à partir duquel on retente
+ */
+typedef struct
+{
+    uint16_t addr;
+    uint16_t consec_fail;
+    uint32_t total_fail;
+    uint32_t recoveries;
+    uint32_t skipped;
+    uint32_t backoff_ms;
+    uint32_t retry_tick;
+} i2c_bus_dev_t;
+
+/**
+ * @brief  Initialise l'état de santé d'un composant.
+ *
+ * @param  dev   Structure à initialiser.
+ * @param  addr  Adresse I2C au format HAL (ex: 0x77 << 1).
+ */
+void I2CBus_DevInit(i2c_bus_dev_t *dev, uint16_t addr);
+
+/**
+ * @brief  Lecture de registres avec timeout borné et gestion des erreurs.
+ *
+ *         Le timeout est calculé à partir de la longueur du transfert et de
+ *         la vitesse du bus. Si le composant est en backoff, la fonction
+ *         retourne HAL_BUSY immédiatement sans toucher au bus.
+ *
+ * @retval HAL_OK    Succès.
+ * @retval HAL_BUSY  Composant en backoff, transaction non tentée.
+ * @retval autre     Code d'erreur HAL de la transaction.
+ */
+HAL_StatusTypeDef I2CBus_MemRead(I2C_HandleTypeDef *hi2c,
+                                 i2c_bus_dev_t *dev,
+                                 uint8_t reg,
+                                 uint8_t *pData,
+                                 uint16_t size);
+
+/**
+ * @brief  Écriture de registres avec timeout borné (voir I2CBus_MemRead).
+ */
+HAL_StatusTypeDef I2CBus_MemWrite(I2C_HandleTypeDef *hi2c,
+                                  i2c_bus_dev_t *dev,
+                                  uint8_t reg,
+                                  uint8_t *pData,
+                                  uint16_t size);
+
+/**
+ * @brief  Débloque le bus : 9 coups d'horloge sur SCL (libère un esclave
+ *         qui maintient SDA à 0), génère un STOP puis réinitialise le
+ *         périphérique I2C.
+ *
+ * @param  hi2c  Handle I2C à réinitialiser.
+ * @return HAL_OK si le périphérique a été réinitialisé.
+ */
+HAL_StatusTypeDef I2CBus_Recover(I2C_HandleTypeDef *hi2c);
+
+/**
+ * @brief  Nombre total de déblocages du bus effectués.
+ */
+uint32_t I2CBus_GetRecoveryCount(void);
+
+#endif /* I2C_BUS_H_ */
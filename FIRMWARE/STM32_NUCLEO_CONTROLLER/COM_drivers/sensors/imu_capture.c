@@ -0,0 +1,332 @@
+/*
+ * imu_capture.c
+ *
+ *  Created on: Jan 19, 2026
+ *      Author: penel
+ */
+
+#include "imu_capture.h"
+#include "../time/timebase.h"
+
+/* Buffer circulaire des échantillons (pré + post trigger) */
+static mpu9250_raw_data_t s_buf[IMU_CAPTURE_DEPTH];
+
+/* Etat de la capture */
+static struct
+{
+    imu_capture_state_t state;
+    uint8_t  src_mask;
+    uint16_t pre_cfg;
+    uint16_t post_cfg;
+
+    uint16_t wr;          /* prochaine case écrite */
+    uint16_t filled;      /* cases valides (<= IMU_CAPTURE_DEPTH) */
+    uint16_t post_left;   /* échantillons post-trigger restant à acquérir */
+    uint16_t trig_idx;    /* case de l'échantillon du trigger */
+    uint16_t pre_avail;   /* échantillons pré-trigger réellement disponibles */
+
+    imu_capture_trig_t pending;
+    imu_capture_trig_t trig_src;
+    uint32_t trig_us;
+    uint32_t overflows;
+    uint8_t  resync;      /* FIFO à vider avant la prochaine lecture */
+
+    /* Seuil */
+    uint8_t  thr_enabled;
+    uint8_t  thr_axis;
+    int16_t  thr_level;
+    imu_capture_edge_t thr_edge;
+    uint8_t  prev_valid;
+    int16_t  prev_val;
+} s_cap =
+{
+    .state    = IMU_CAPTURE_IDLE,
+    .pre_cfg  = IMU_CAPTURE_PRE_DEFAULT,
+    .post_cfg = IMU_CAPTURE_POST_DEFAULT,
+    .pending  = IMU_CAPTURE_TRIG_NONE,
+    .trig_src = IMU_CAPTURE_TRIG_NONE,
+    .thr_edge = IMU_CAPTURE_EDGE_BOTH
+};
+
+/* --------------------------------------------------------------------------
+ * Fonctions internes
+ * -------------------------------------------------------------------------- */
+
+static int16_t cap_axis_value(const mpu9250_raw_data_t *s, uint8_t axis)
+{
+    switch (axis)
+    {
+    case IMU_AXIS_AX: return s->ax;
+    case IMU_AXIS_AY: return s->ay;
+    case IMU_AXIS_AZ: return s->az;
+    case IMU_AXIS_GX: return s->gx;
+    case IMU_AXIS_GY: return s->gy;
+    default:          return s->gz;
+    }
+}
+
+static uint8_t cap_src_bit(imu_capture_trig_t src)
+{
+    switch (src)
+    {
+    case IMU_CAPTURE_TRIG_CMD:       return IMU_CAPTURE_SRC_CMD;
+    case IMU_CAPTURE_TRIG_VALVE:     return IMU_CAPTURE_SRC_VALVE;
+    case IMU_CAPTURE_TRIG_THRESHOLD: return IMU_CAPTURE_SRC_THRESHOLD;
+    default:                         return 0;
+    }
+}
+
+/**
+ * @brief Teste le franchissement du seuil entre l'échantillon précédent
+ *        et l'échantillon courant.
+ */
+static int cap_threshold_crossed(const mpu9250_raw_data_t *s)
+{
+    int16_t v = cap_axis_value(s, s_cap.thr_axis);
+    int crossed = 0;
+
+    if (s_cap.prev_valid)
+    {
+        int rising  = (s_cap.prev_val <  s_cap.thr_level) && (v >= s_cap.thr_level);
+        int falling = (s_cap.prev_val >= s_cap.thr_level) && (v <  s_cap.thr_level);
+
+        if (s_cap.thr_edge == IMU_CAPTURE_EDGE_RISING)
+            crossed = rising;
+        else if (s_cap.thr_edge == IMU_CAPTURE_EDGE_FALLING)
+            crossed = falling;
+        else
+            crossed = rising || falling;
+    }
+
+    s_cap.prev_val   = v;
+    s_cap.prev_valid = 1;
+    return crossed;
+}
+
+/**
+ * @brief Range un échantillon et fait avancer la machine d'état.
+ *
+ * @param age_ms  Ancienneté de l'échantillon (ms) par rapport à HAL_GetTick().
+ */
+static void cap_store(const mpu9250_raw_data_t *s, uint32_t age_ms)
+{
+    if (s_cap.state == IMU_CAPTURE_ARMED)
+    {
+        if (s_cap.pending == IMU_CAPTURE_TRIG_NONE &&
+            s_cap.thr_enabled &&
+            (s_cap.src_mask & IMU_CAPTURE_SRC_THRESHOLD) != 0u &&
+            cap_threshold_crossed(s))
+        {
+            s_cap.pending = IMU_CAPTURE_TRIG_THRESHOLD;
+        }
+
+        if (s_cap.pending != IMU_CAPTURE_TRIG_NONE)
+        {
+            s_cap.trig_idx  = s_cap.wr;
+            s_cap.trig_src  = s_cap.pending;
+            s_cap.trig_us   = Timebase_Now32() - age_ms * 1000u;
+            s_cap.pending   = IMU_CAPTURE_TRIG_NONE;
+            s_cap.pre_avail = (s_cap.filled < s_cap.pre_cfg) ? s_cap.filled : s_cap.pre_cfg;
+            s_cap.post_left = s_cap.post_cfg;
+            s_cap.state     = IMU_CAPTURE_TRIGGERED;
+        }
+    }
+
+    s_buf[s_cap.wr] = *s;
+    s_cap.wr = (uint16_t)((s_cap.wr + 1u) % IMU_CAPTURE_DEPTH);
+    if (s_cap.filled < IMU_CAPTURE_DEPTH)
+        s_cap.filled++;
+
+    if (s_cap.state == IMU_CAPTURE_TRIGGERED)
+    {
+        if (--s_cap.post_left == 0u)
+            s_cap.state = IMU_CAPTURE_DONE;
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * API
+ * -------------------------------------------------------------------------- */
+
+HAL_StatusTypeDef ImuCapture_Config(uint16_t pre, uint16_t post)
+{
+    if (s_cap.state == IMU_CAPTURE_ARMED || s_cap.state == IMU_CAPTURE_TRIGGERED)
+        return HAL_ERROR;
+
+    if (post == 0u || (uint32_t)pre + post > IMU_CAPTURE_DEPTH)
+        return HAL_ERROR;
+
+    s_cap.pre_cfg  = pre;
+    s_cap.post_cfg = post;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef ImuCapture_SetThreshold(imu_axis_t axis, int16_t level,
+                                          imu_capture_edge_t edge)
+{
+    if ((unsigned)axis >= IMU_AXIS_COUNT)
+        return HAL_ERROR;
+
+    if (edge != IMU_CAPTURE_EDGE_RISING &&
+        edge != IMU_CAPTURE_EDGE_FALLING &&
+        edge != IMU_CAPTURE_EDGE_BOTH)
+        return HAL_ERROR;
+
+    s_cap.thr_axis    = (uint8_t)axis;
+    s_cap.thr_level   = level;
+    s_cap.thr_edge    = edge;
+    s_cap.thr_enabled = 1;
+    s_cap.prev_valid  = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef ImuCapture_Arm(uint8_t src_mask)
+{
+    if (s_cap.state == IMU_CAPTURE_ARMED || s_cap.state == IMU_CAPTURE_TRIGGERED)
+        return HAL_BUSY;
+
+    s_cap.src_mask   = src_mask;
+    s_cap.wr         = 0;
+    s_cap.filled     = 0;
+    s_cap.post_left  = 0;
+    s_cap.pre_avail  = 0;
+    s_cap.pending    = IMU_CAPTURE_TRIG_NONE;
+    s_cap.trig_src   = IMU_CAPTURE_TRIG_NONE;
+    s_cap.overflows  = 0;
+    s_cap.resync     = 0;
+    s_cap.prev_valid = 0;
+
+    if (mpu9250_fifo_start(MPU9250_SMPLRT_DIV_1KHZ) != HAL_OK)
+    {
+        s_cap.state = IMU_CAPTURE_IDLE;
+        return HAL_ERROR;
+    }
+
+    s_cap.state = IMU_CAPTURE_ARMED;
+    return HAL_OK;
+}
+
+void ImuCapture_Disarm(void)
+{
+    if (s_cap.state == IMU_CAPTURE_ARMED || s_cap.state == IMU_CAPTURE_TRIGGERED)
+        (void)mpu9250_fifo_stop();
+
+    s_cap.state = IMU_CAPTURE_IDLE;
+}
+
+void ImuCapture_Trigger(imu_capture_trig_t src)
+{
+    if (s_cap.state != IMU_CAPTURE_ARMED)
+        return;
+
+    if ((s_cap.src_mask & cap_src_bit(src)) == 0u)
+        return;
+
+    if (s_cap.pending == IMU_CAPTURE_TRIG_NONE)
+        s_cap.pending = src;
+}
+
+/**
+ * @brief FIFO désalignée (débordement ou lecture ratée) : vidage et
+ *        abandon des échantillons qui restaient à lire.
+ */
+static void cap_fifo_lost(void)
+{
+    s_cap.overflows++;
+
+    if (s_cap.state == IMU_CAPTURE_TRIGGERED)
+    {
+        /* Trou dans la fenêtre post-trigger : capture inutilisable */
+        (void)mpu9250_fifo_stop();
+        s_cap.state = IMU_CAPTURE_BROKEN;
+        return;
+    }
+
+    /* Armée : la fenêtre pré-trigger doit rester continue, elle repart de
+     * zéro ; un trigger en attente sera daté sur le premier échantillon
+     * lu après le vidage
+     */
+    s_cap.wr         = 0;
+    s_cap.filled     = 0;
+    s_cap.prev_valid = 0;
+    s_cap.resync     = 1;
+}
+
+void ImuCapture_Task(void)
+{
+    mpu9250_raw_data_t chunk[MPU9250_FIFO_READ_MAX];
+    uint16_t n, k, i;
+    uint8_t ovf;
+
+    if (s_cap.state != IMU_CAPTURE_ARMED && s_cap.state != IMU_CAPTURE_TRIGGERED)
+        return;
+
+    /* Vidage retenté à chaque passage tant que le bus le refuse */
+    if (s_cap.resync)
+    {
+        if (mpu9250_fifo_reset() != HAL_OK)
+            return;
+        s_cap.resync = 0;
+    }
+
+    if (mpu9250_fifo_count(&n, &ovf) != HAL_OK)
+        return;
+
+    if (ovf)
+    {
+        cap_fifo_lost();
+        return;
+    }
+
+    while (n > 0u && s_cap.state != IMU_CAPTURE_DONE)
+    {
+        k = (n > MPU9250_FIFO_READ_MAX) ? MPU9250_FIFO_READ_MAX : n;
+
+        if (mpu9250_fifo_read(chunk, k) != HAL_OK)
+        {
+            /* Nombre d'octets dépilés inconnu : plus aligné */
+            cap_fifo_lost();
+            return;
+        }
+
+        for (i = 0; i < k && s_cap.state != IMU_CAPTURE_DONE; i++)
+        {
+            /* 1 échantillon par ms : le dernier de la FIFO est le plus récent */
+            cap_store(&chunk[i], (uint32_t)(n - i - 1u) * (IMU_CAPTURE_PERIOD_US / 1000u));
+        }
+
+        n = (uint16_t)(n - k);
+    }
+
+    if (s_cap.state == IMU_CAPTURE_DONE)
+        (void)mpu9250_fifo_stop();
+}
+
+void ImuCapture_GetStatus(imu_capture_status_t *st)
+{
+    if (st == NULL)
+        return;
+
+    st->state     = s_cap.state;
+    st->trig_src  = s_cap.trig_src;
+    st->pre       = s_cap.pre_avail;
+    st->total     = (s_cap.state == IMU_CAPTURE_DONE) ?
+                    (uint16_t)(s_cap.pre_avail + s_cap.post_cfg) : 0u;
+    st->trig_us   = s_cap.trig_us;
+    st->overflows = s_cap.overflows;
+}
+
+HAL_StatusTypeDef ImuCapture_GetSample(uint16_t k, mpu9250_raw_data_t *out)
+{
+    uint16_t start;
+
+    if (s_cap.state != IMU_CAPTURE_DONE || out == NULL)
+        return HAL_ERROR;
+
+    if (k >= (uint16_t)(s_cap.pre_avail + s_cap.post_cfg))
+        return HAL_ERROR;
+
+    start = (uint16_t)((s_cap.trig_idx + IMU_CAPTURE_DEPTH - s_cap.pre_avail) % IMU_CAPTURE_DEPTH);
+    *out  = s_buf[(start + k) % IMU_CAPTURE_DEPTH];
+    return HAL_OK;
+}
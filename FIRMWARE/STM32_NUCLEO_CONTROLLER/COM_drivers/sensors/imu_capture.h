@@ -0,0 +1,137 @@
+/*
+ * imu_capture.h
+ *
+ *  Created on: Jan 19, 2026
+ *      Author: penel
+ */
+
+#ifndef IMU_CAPTURE_H_
+#define IMU_CAPTURE_H_
+
+#include "main.h"
+#include <stdint.h>
+#include "mpu9250.h"
+
+/* Profondeur totale du buffer (pré + post déclenchement).
+ * 1024 échantillons x 12 octets = 12 ko de RAM, soit ~1 s à 1 kHz.
+ */
+#define IMU_CAPTURE_DEPTH         1024u
+
+/* Configuration par défaut : 256 ms avant, 768 ms après le déclenchement */
+#define IMU_CAPTURE_PRE_DEFAULT   256u
+#define IMU_CAPTURE_POST_DEFAULT  768u
+
+/* Période d'échantillonnage pendant la capture (FIFO MPU9250 à 1 kHz) */
+#define IMU_CAPTURE_PERIOD_US     1000u
+
+/* État de la capture (façon oscilloscope) */
+typedef enum
+{
+    IMU_CAPTURE_IDLE      = 'I',  /* rien en cours, FIFO arrêtée */
+    IMU_CAPTURE_ARMED     = 'A',  /* remplissage continu de la fenêtre pré-trigger */
+    IMU_CAPTURE_TRIGGERED = 'T',  /* acquisition des échantillons post-trigger */
+    IMU_CAPTURE_DONE      = 'D',  /* capture figée, prête à être téléchargée */
+    IMU_CAPTURE_BROKEN    = 'E'   /* FIFO perdue après le trigger : trou dans la
+                                     fenêtre post, rien à télécharger */
+} imu_capture_state_t;
+
+/* Sources de déclenchement (lettres utilisées par le protocole) */
+typedef enum
+{
+    IMU_CAPTURE_TRIG_NONE      = '-',
+    IMU_CAPTURE_TRIG_CMD       = 'C',  /* commande protocole CAP_TRIG */
+    IMU_CAPTURE_TRIG_VALVE     = 'V',  /* commande d'angle envoyée sur le CAN */
+    IMU_CAPTURE_TRIG_THRESHOLD = 'S'   /* franchissement de seuil sur un axe */
+} imu_capture_trig_t;
+
+/* Masque des sources autorisées */
+#define IMU_CAPTURE_SRC_CMD        0x01u
+#define IMU_CAPTURE_SRC_VALVE      0x02u
+#define IMU_CAPTURE_SRC_THRESHOLD  0x04u
+
+/* Front du seuil */
+typedef enum
+{
+    IMU_CAPTURE_EDGE_RISING  = 'R',
+    IMU_CAPTURE_EDGE_FALLING = 'F',
+    IMU_CAPTURE_EDGE_BOTH    = 'B'
+} imu_capture_edge_t;
+
+/* Axes utilisables pour le seuil (ordre de mpu9250_raw_data_t) */
+typedef enum
+{
+    IMU_AXIS_AX = 0, IMU_AXIS_AY, IMU_AXIS_AZ,
+    IMU_AXIS_GX,     IMU_AXIS_GY, IMU_AXIS_GZ,
+    IMU_AXIS_COUNT
+} imu_axis_t;
+
+/* Résumé de l'état pour le protocole */
+typedef struct
+{
+    imu_capture_state_t state;
+    imu_capture_trig_t  trig_src;
+    uint16_t pre;          /* échantillons disponibles avant le trigger */
+    uint16_t total;        /* échantillons téléchargeables (pre + post) */
+    uint32_t trig_us;      /* Timebase (µs, 32 bits bas) du trigger */
+    uint32_t overflows;    /* débordements / lectures FIFO ratées (resynchronisations) */
+} imu_capture_status_t;
+
+/**
+ * @brief Configure la taille des fenêtres (capture arrêtée uniquement).
+ *
+ * @return HAL_ERROR si pre + post > IMU_CAPTURE_DEPTH, post == 0
+ *         ou capture en cours.
+ */
+HAL_StatusTypeDef ImuCapture_Config(uint16_t pre, uint16_t post);
+
+/**
+ * @brief Configure le déclenchement sur seuil (axe brut, en LSB).
+ */
+HAL_StatusTypeDef ImuCapture_SetThreshold(imu_axis_t axis, int16_t level,
+                                          imu_capture_edge_t edge);
+
+/**
+ * @brief Arme la capture : FIFO MPU9250 à 1 kHz, remplissage continu.
+ *
+ * @param src_mask  Sources de déclenchement acceptées (IMU_CAPTURE_SRC_*).
+ */
+HAL_StatusTypeDef ImuCapture_Arm(uint8_t src_mask);
+
+/**
+ * @brief Arrête la capture en cours (le contenu est perdu).
+ */
+void ImuCapture_Disarm(void);
+
+/**
+ * @brief Demande un déclenchement. Ignoré si la capture n'est pas armée
+ *        ou si la source n'est pas autorisée.
+ *        Le trigger est daté sur le prochain échantillon lu.
+ */
+void ImuCapture_Trigger(imu_capture_trig_t src);
+
+/**
+ * @brief À appeler dans la boucle principale : vide la FIFO du MPU9250
+ *        (au moins toutes les 40 ms à 1 kHz pour éviter le débordement).
+ *
+ * FIFO de 512 octets, pas un multiple des 12 octets d'un échantillon :
+ * après un débordement ou une lecture ratée la lecture n'est plus alignée.
+ * La FIFO est alors vidée et rien de ce qu'elle contenait n'est gardé :
+ * armée, la fenêtre pré-trigger repart de zéro ; déclenchée, la capture
+ * passe à IMU_CAPTURE_BROKEN.
+ */
+void ImuCapture_Task(void);
+
+/**
+ * @brief État courant de la capture.
+ */
+void ImuCapture_GetStatus(imu_capture_status_t *st);
+
+/**
+ * @brief Lit l'échantillon k d'une capture terminée (k = 0 : le plus ancien,
+ *        k = status.pre : l'échantillon du trigger).
+ *
+ * @return HAL_ERROR si la capture n'est pas terminée ou k hors limites.
+ */
+HAL_StatusTypeDef ImuCapture_GetSample(uint16_t k, mpu9250_raw_data_t *out);
+
+#endif /* IMU_CAPTURE_H_ */
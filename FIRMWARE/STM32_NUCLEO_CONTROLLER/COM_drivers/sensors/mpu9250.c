@@ -5,11 +5,14 @@
  *      Author: penel
  */
 #include "mpu9250.h"
-#include <stdio.h>
+#include "../log/log.h"
 
 /* On suppose que hi2c1 est défini dans main.c (ou i2c.c) */
 extern I2C_HandleTypeDef hi2c1;
 
+/* Compteurs d'erreurs / backoff I2C du composant */
+static i2c_bus_dev_t s_bus = { .addr = MPU9250_I2C_ADDR };
+
 /* ======================================================================= */
 /* Fonctions internes (statiques)                                         */
 /* ======================================================================= */
@@ -19,13 +22,7 @@ extern I2C_HandleTypeDef hi2c1;
  */
 static HAL_StatusTypeDef mpu9250_write_reg(uint8_t reg, uint8_t value)
 {
-    return HAL_I2C_Mem_Write(&hi2c1,
-                             MPU9250_I2C_ADDR,
-                             reg,
-                             I2C_MEMADD_SIZE_8BIT,
-                             &value,
-                             1,
-                             HAL_MAX_DELAY);
+    return I2CBus_MemWrite(&hi2c1, &s_bus, reg, &value, 1);
 }
 
 /**
@@ -33,13 +30,7 @@ static HAL_StatusTypeDef mpu9250_write_reg(uint8_t reg, uint8_t value)
  */
 static HAL_StatusTypeDef mpu9250_read_reg(uint8_t reg, uint8_t *value)
 {
-    return HAL_I2C_Mem_Read(&hi2c1,
-                            MPU9250_I2C_ADDR,
-                            reg,
-                            I2C_MEMADD_SIZE_8BIT,
-                            value,
-                            1,
-                            HAL_MAX_DELAY);
+    return I2CBus_MemRead(&hi2c1, &s_bus, reg, value, 1);
 }
 
 /**
@@ -47,13 +38,7 @@ static HAL_StatusTypeDef mpu9250_read_reg(uint8_t reg, uint8_t *value)
  */
 static HAL_StatusTypeDef mpu9250_read_multi(uint8_t reg, uint8_t *p_data, uint16_t size)
 {
-    return HAL_I2C_Mem_Read(&hi2c1,
-                            MPU9250_I2C_ADDR,
-                            reg,
-                            I2C_MEMADD_SIZE_8BIT,
-                            p_data,
-                            size,
-                            HAL_MAX_DELAY);
+    return I2CBus_MemRead(&hi2c1, &s_bus, reg, p_data, size);
 }
 
 /* ======================================================================= */
@@ -67,21 +52,21 @@ HAL_StatusTypeDef mpu9250_read_who_am_i(uint8_t *who_am_i)
     ret = mpu9250_read_reg(MPU9250_REG_WHO_AM_I, who_am_i);
     if (ret != HAL_OK)
     {
-        printf("MPU9250: Erreur I2C lecture WHO_AM_I (ret = %d)\r\n", ret);
+        LOG_E(LOG_MOD_MPU, "Erreur I2C lecture WHO_AM_I (ret = %d)", ret);
         return ret;
     }
 
-    printf("MPU9250 WHO_AM_I = 0x%02X\r\n", *who_am_i);
+    LOG_I(LOG_MOD_MPU, "WHO_AM_I = 0x%02X", *who_am_i);
 
     if (*who_am_i == MPU9250_WHO_AM_I_VALUE)
     {
-        printf("MPU9250 identifie correctement (0x%02X attendu)\r\n",
-               MPU9250_WHO_AM_I_VALUE);
+        LOG_I(LOG_MOD_MPU, "identifie correctement (0x%02X attendu)",
+              MPU9250_WHO_AM_I_VALUE);
     }
     else
     {
-        printf("MPU9250 WHO_AM_I inattendu (0x%02X attendu)\r\n",
-               MPU9250_WHO_AM_I_VALUE);
+        LOG_W(LOG_MOD_MPU, "WHO_AM_I inattendu (0x%02X attendu)",
+              MPU9250_WHO_AM_I_VALUE);
     }
 
     return HAL_OK;
@@ -93,6 +78,8 @@ HAL_StatusTypeDef mpu9250_init(void)
     uint8_t who_am_i = 0;
     uint8_t value;
 
+    I2CBus_DevInit(&s_bus, MPU9250_I2C_ADDR);
+
     /* Lecture et vérification du WHO_AM_I */
     ret = mpu9250_read_who_am_i(&who_am_i);
     if (ret != HAL_OK)
@@ -109,7 +96,7 @@ HAL_StatusTypeDef mpu9250_init(void)
     ret = mpu9250_write_reg(MPU9250_REG_PWR_MGMT_1, value);
     if (ret != HAL_OK)
     {
-        printf("MPU9250: Erreur I2C ecriture PWR_MGMT_1\r\n");
+        LOG_E(LOG_MOD_MPU, "Erreur I2C ecriture PWR_MGMT_1");
         return ret;
     }
 
@@ -120,7 +107,7 @@ HAL_StatusTypeDef mpu9250_init(void)
     ret = mpu9250_write_reg(MPU9250_REG_PWR_MGMT_2, value);
     if (ret != HAL_OK)
     {
-        printf("MPU9250: Erreur I2C ecriture PWR_MGMT_2\r\n");
+        LOG_E(LOG_MOD_MPU, "Erreur I2C ecriture PWR_MGMT_2");
         return ret;
     }
 
@@ -130,11 +117,11 @@ HAL_StatusTypeDef mpu9250_init(void)
      * Gyro_Output_Rate par défaut = 8 kHz -> ici on prend par exemple ~1 kHz
      * -> SMPLRT_DIV = 7
      */
-    value = 7;
+    value = MPU9250_SMPLRT_DIV_DEFAULT;
     ret = mpu9250_write_reg(MPU9250_REG_SMPLRT_DIV, value);
     if (ret != HAL_OK)
     {
-        printf("MPU9250: Erreur I2C ecriture SMPLRT_DIV\r\n");
+        LOG_E(LOG_MOD_MPU, "Erreur I2C ecriture SMPLRT_DIV");
         return ret;
     }
 
@@ -146,7 +133,7 @@ HAL_StatusTypeDef mpu9250_init(void)
     ret = mpu9250_write_reg(MPU9250_REG_CONFIG, value);
     if (ret != HAL_OK)
     {
-        printf("MPU9250: Erreur I2C ecriture CONFIG\r\n");
+        LOG_E(LOG_MOD_MPU, "Erreur I2C ecriture CONFIG");
         return ret;
     }
 
@@ -163,7 +150,7 @@ HAL_StatusTypeDef mpu9250_init(void)
     ret = mpu9250_write_reg(MPU9250_REG_GYRO_CONFIG, value);
     if (ret != HAL_OK)
     {
-        printf("MPU9250: Erreur I2C ecriture GYRO_CONFIG\r\n");
+        LOG_E(LOG_MOD_MPU, "Erreur I2C ecriture GYRO_CONFIG");
         return ret;
     }
 
@@ -180,7 +167,7 @@ HAL_StatusTypeDef mpu9250_init(void)
     ret = mpu9250_write_reg(MPU9250_REG_ACCEL_CONFIG, value);
     if (ret != HAL_OK)
     {
-        printf("MPU9250: Erreur I2C ecriture ACCEL_CONFIG\r\n");
+        LOG_E(LOG_MOD_MPU, "Erreur I2C ecriture ACCEL_CONFIG");
         return ret;
     }
 
@@ -191,11 +178,11 @@ HAL_StatusTypeDef mpu9250_init(void)
     ret = mpu9250_write_reg(MPU9250_REG_ACCEL_CONFIG2, value);
     if (ret != HAL_OK)
     {
-        printf("MPU9250: Erreur I2C ecriture ACCEL_CONFIG2\r\n");
+        LOG_E(LOG_MOD_MPU, "Erreur I2C ecriture ACCEL_CONFIG2");
         return ret;
     }
 
-    printf("MPU9250: initialisation terminee\r\n");
+    LOG_I(LOG_MOD_MPU, "initialisation terminee");
 
     /* Petit délai pour laisser les filtres / capteurs se stabiliser */
     HAL_Delay(100);
@@ -218,9 +205,14 @@ HAL_StatusTypeDef mpu9250_read_raw(mpu9250_raw_data_t *data)
      * Total : 14 octets (6 pour accel, 2 pour température, 6 pour gyro)
      */
     ret = mpu9250_read_multi(MPU9250_REG_ACCEL_XOUT_H, buf, 14);
+    if (ret == HAL_BUSY)
+    {
+        /* Composant en backoff : pas de transaction, pas de message */
+        return ret;
+    }
     if (ret != HAL_OK)
     {
-        printf("MPU9250: Erreur I2C lecture donnees brutes (ret = %d)\r\n", ret);
+        LOG_E(LOG_MOD_MPU, "Erreur I2C lecture donnees brutes (ret = %d)", ret);
         return ret;
     }
 
@@ -238,6 +230,119 @@ HAL_StatusTypeDef mpu9250_read_raw(mpu9250_raw_data_t *data)
     return HAL_OK;
 }
 
+/**
+ * @brief Décode un échantillon accéléro + gyro (big-endian).
+ *        buf[0..5] = accel X/Y/Z, buf[6..11] = gyro X/Y/Z
+ */
+static void mpu9250_decode_accel_gyro(const uint8_t *buf, mpu9250_raw_data_t *data)
+{
+    data->ax = (int16_t)((buf[0]  << 8) | buf[1]);
+    data->ay = (int16_t)((buf[2]  << 8) | buf[3]);
+    data->az = (int16_t)((buf[4]  << 8) | buf[5]);
+    data->gx = (int16_t)((buf[6]  << 8) | buf[7]);
+    data->gy = (int16_t)((buf[8]  << 8) | buf[9]);
+    data->gz = (int16_t)((buf[10] << 8) | buf[11]);
+}
+
+HAL_StatusTypeDef mpu9250_fifo_start(uint8_t smplrt_div)
+{
+    HAL_StatusTypeDef ret;
+
+    ret = mpu9250_write_reg(MPU9250_REG_SMPLRT_DIV, smplrt_div);
+    if (ret != HAL_OK)
+        return ret;
+
+    /* FIFO désactivée puis vidée avant de choisir les sources */
+    ret = mpu9250_write_reg(MPU9250_REG_USER_CTRL, MPU9250_USER_CTRL_FIFO_RST);
+    if (ret != HAL_OK)
+        return ret;
+
+    ret = mpu9250_write_reg(MPU9250_REG_FIFO_EN, MPU9250_FIFO_EN_ACCEL_GYRO);
+    if (ret != HAL_OK)
+        return ret;
+
+    return mpu9250_write_reg(MPU9250_REG_USER_CTRL, MPU9250_USER_CTRL_FIFO_EN);
+}
+
+HAL_StatusTypeDef mpu9250_fifo_stop(void)
+{
+    HAL_StatusTypeDef ret;
+
+    ret = mpu9250_write_reg(MPU9250_REG_FIFO_EN, 0x00);
+    if (ret != HAL_OK)
+        return ret;
+
+    ret = mpu9250_write_reg(MPU9250_REG_USER_CTRL, MPU9250_USER_CTRL_FIFO_RST);
+    if (ret != HAL_OK)
+        return ret;
+
+    return mpu9250_write_reg(MPU9250_REG_SMPLRT_DIV, MPU9250_SMPLRT_DIV_DEFAULT);
+}
+
+HAL_StatusTypeDef mpu9250_fifo_reset(void)
+{
+    HAL_StatusTypeDef ret;
+
+    /* FIFO_RST seul désactive aussi la FIFO (FIFO_EN = 0) */
+    ret = mpu9250_write_reg(MPU9250_REG_USER_CTRL, MPU9250_USER_CTRL_FIFO_RST);
+    if (ret != HAL_OK)
+        return ret;
+
+    return mpu9250_write_reg(MPU9250_REG_USER_CTRL, MPU9250_USER_CTRL_FIFO_EN);
+}
+
+HAL_StatusTypeDef mpu9250_fifo_count(uint16_t *n_samples, uint8_t *overflow)
+{
+    HAL_StatusTypeDef ret;
+    uint8_t buf[2];
+    uint8_t status;
+
+    if (n_samples == NULL || overflow == NULL)
+        return HAL_ERROR;
+
+    /* La lecture de INT_STATUS efface le flag de débordement */
+    ret = mpu9250_read_reg(MPU9250_REG_INT_STATUS, &status);
+    if (ret != HAL_OK)
+        return ret;
+
+    ret = mpu9250_read_multi(MPU9250_REG_FIFO_COUNTH, buf, 2);
+    if (ret != HAL_OK)
+        return ret;
+
+    *overflow  = (status & MPU9250_INT_FIFO_OFLOW) ? 1u : 0u;
+    *n_samples = (uint16_t)((((uint16_t)(buf[0] & 0x1Fu) << 8) | buf[1]) /
+                            MPU9250_FIFO_SAMPLE_BYTES);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef mpu9250_fifo_read(mpu9250_raw_data_t *samples, uint16_t n)
+{
+    HAL_StatusTypeDef ret;
+    uint8_t buf[MPU9250_FIFO_READ_MAX * MPU9250_FIFO_SAMPLE_BYTES];
+    uint16_t i;
+
+    if (samples == NULL || n == 0u || n > MPU9250_FIFO_READ_MAX)
+        return HAL_ERROR;
+
+    /* Lecture en rafale sur FIFO_R_W : le MPU9250 dépile un octet par lecture */
+    ret = mpu9250_read_multi(MPU9250_REG_FIFO_R_W, buf,
+                             (uint16_t)(n * MPU9250_FIFO_SAMPLE_BYTES));
+    if (ret != HAL_OK)
+        return ret;
+
+    for (i = 0; i < n; i++)
+    {
+        mpu9250_decode_accel_gyro(&buf[i * MPU9250_FIFO_SAMPLE_BYTES], &samples[i]);
+    }
+
+    return HAL_OK;
+}
+
+const i2c_bus_dev_t* mpu9250_get_bus_health(void)
+{
+    return &s_bus;
+}
+
 /* ======================================================================= */
 /* Conversions en entier fixe (sans float)                                 */
 /* ======================================================================= */
@@ -9,6 +9,7 @@
 
 #include "main.h"
 #include <stdint.h>
+#include "i2c_bus.h"
 
 /**
  * @brief Adresse I2C (7 bits) = 0x68 -> adresse HAL (8 bits) = 0x68 << 1
@@ -22,18 +23,43 @@
 #define MPU9250_REG_ACCEL_CONFIG  0x1Cu
 #define MPU9250_REG_ACCEL_CONFIG2 0x1Du
 
+#define MPU9250_REG_FIFO_EN       0x23u
 #define MPU9250_REG_INT_STATUS    0x3Au
 
 #define MPU9250_REG_ACCEL_XOUT_H  0x3Bu
 #define MPU9250_REG_TEMP_OUT_H    0x41u
 #define MPU9250_REG_GYRO_XOUT_H   0x43u
 
+#define MPU9250_REG_USER_CTRL     0x6Au
 #define MPU9250_REG_PWR_MGMT_1    0x6Bu
 #define MPU9250_REG_PWR_MGMT_2    0x6Cu
 
+#define MPU9250_REG_FIFO_COUNTH   0x72u
+#define MPU9250_REG_FIFO_R_W      0x74u
 #define MPU9250_REG_WHO_AM_I      0x75u
 #define MPU9250_WHO_AM_I_VALUE    0x71u   /* Valeur typique pour MPU-9250 */
 
+/* FIFO interne (512 octets) :
+ * - FIFO_EN   : accéléro + gyro X/Y/Z -> 12 octets par échantillon
+ * - USER_CTRL : FIFO_EN (bit 6), FIFO_RST (bit 2)
+ * - INT_STATUS: FIFO_OFLOW_INT (bit 4)
+ */
+#define MPU9250_FIFO_SIZE            512u
+#define MPU9250_FIFO_SAMPLE_BYTES    12u
+#define MPU9250_FIFO_EN_ACCEL_GYRO   0x78u
+#define MPU9250_USER_CTRL_FIFO_EN    0x40u
+#define MPU9250_USER_CTRL_FIFO_RST   0x04u
+#define MPU9250_INT_FIFO_OFLOW       0x10u
+
+/* Échantillons lus au maximum par transaction FIFO */
+#define MPU9250_FIFO_READ_MAX        16u
+
+/* SMPLRT_DIV : 7 en fonctionnement normal (125 Hz avec DLPF),
+ * 0 pour la capture (1 kHz avec DLPF)
+ */
+#define MPU9250_SMPLRT_DIV_DEFAULT   7u
+#define MPU9250_SMPLRT_DIV_1KHZ      0u
+
 /* Full scale utilisé dans ce driver :
  * - Gyro :  ±250 dps -> 131 LSB/(°/s)
  * - Accel : ±2 g     -> 16384 LSB/g
@@ -86,6 +112,46 @@ HAL_StatusTypeDef mpu9250_init(void);
  */
 HAL_StatusTypeDef mpu9250_read_raw(mpu9250_raw_data_t *data);
 
+/**
+ * @brief Démarre l'écriture des échantillons accéléro + gyro dans la FIFO
+ *        interne du MPU9250 (la FIFO est vidée au préalable).
+ *
+ * @param smplrt_div  Diviseur d'échantillonnage (0 -> 1 kHz avec DLPF).
+ * @return HAL_OK si la configuration s'est bien déroulée.
+ */
+HAL_StatusTypeDef mpu9250_fifo_start(uint8_t smplrt_div);
+
+/**
+ * @brief Arrête la FIFO et rétablit la cadence par défaut.
+ */
+HAL_StatusTypeDef mpu9250_fifo_stop(void);
+
+/**
+ * @brief Vide la FIFO et relance l'écriture (mêmes sources, même cadence).
+ *        Réaligne la lecture sur un début d'échantillon après un débordement
+ *        ou une lecture interrompue.
+ */
+HAL_StatusTypeDef mpu9250_fifo_reset(void);
+
+/**
+ * @brief Nombre d'échantillons complets présents dans la FIFO.
+ *
+ * @param[out] n_samples  Échantillons complets disponibles.
+ * @param[out] overflow   1 si la FIFO a débordé depuis la dernière lecture
+ *                        (des échantillons ont été perdus).
+ */
+HAL_StatusTypeDef mpu9250_fifo_count(uint16_t *n_samples, uint8_t *overflow);
+
+/**
+ * @brief Lit n échantillons (n <= MPU9250_FIFO_READ_MAX) dans la FIFO.
+ */
+HAL_StatusTypeDef mpu9250_fifo_read(mpu9250_raw_data_t *samples, uint16_t n);
+
+/**
+ * @brief Compteurs d'erreurs / backoff I2C du MPU9250.
+ */
+const i2c_bus_dev_t* mpu9250_get_bus_health(void);
+
 /**
  * @brief Conversion des données brutes d'accélération en milli-g (mg).
  *
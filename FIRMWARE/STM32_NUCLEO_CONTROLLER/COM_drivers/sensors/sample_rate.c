@@ -0,0 +1,98 @@
+/*
+ * sample_rate.c
+ *
+ *  Created on: Jan 16, 2026
+ *      Author: penel
+ */
+
+#include "sample_rate.h"
+
+static const uint32_t s_period_ms[] =
+{
+    [SAMPLE_RATE_FAST]   = SAMPLE_RATE_FAST_MS,
+    [SAMPLE_RATE_MEDIUM] = SAMPLE_RATE_MEDIUM_MS,
+    [SAMPLE_RATE_SLOW]   = SAMPLE_RATE_SLOW_MS
+};
+
+void SampleRate_Init(sample_rate_t *r)
+{
+    r->level      = SAMPLE_RATE_FAST;
+    r->has_ref    = 0;
+    r->calm       = 0;
+    r->ref_value  = 0;
+    r->ref_tick   = 0;
+    r->next_value = 0;
+    r->next_tick  = 0;
+    r->slope      = 0;
+}
+
+uint32_t SampleRate_Update(sample_rate_t *r, int32_t value, int32_t err_abs, uint32_t now)
+{
+    uint32_t dt;
+    int32_t  slope = 0;
+    uint8_t  windowed;
+
+    if (!r->has_ref)
+    {
+        r->has_ref    = 1;
+        r->ref_value  = value;
+        r->ref_tick   = now;
+        r->next_value = value;
+        r->next_tick  = now;
+    }
+
+    /* Pente en 0.01 °C/s contre la référence ; sur moins d'une fenêtre
+     * (démarrage), elle ne sert qu'à accélérer
+     */
+    dt = now - r->ref_tick;
+    windowed = (dt >= SAMPLE_RATE_SLOPE_WINDOW_MS);
+    if (dt > 0u)
+    {
+        slope = ((value - r->ref_value) * 1000) / (int32_t)dt;
+        if (slope < 0)
+            slope = -slope;
+    }
+    r->slope = slope;
+
+    /* Référence toujours vieille d'une à deux fenêtres */
+    if (now - r->next_tick >= SAMPLE_RATE_SLOPE_WINDOW_MS)
+    {
+        r->ref_value  = r->next_value;
+        r->ref_tick   = r->next_tick;
+        r->next_value = value;
+        r->next_tick  = now;
+    }
+
+    if (slope > SAMPLE_RATE_SLOPE_UP || err_abs > SAMPLE_RATE_ERR_UP)
+    {
+        /* Signal qui bouge : passage immédiat en cadence rapide */
+        r->level = SAMPLE_RATE_FAST;
+        r->calm  = 0;
+    }
+    else if (!windowed)
+    {
+        /* Pas encore de pente sur une fenêtre complète : cadence gardée */
+    }
+    else if (slope < SAMPLE_RATE_SLOPE_DOWN && err_abs < SAMPLE_RATE_ERR_DOWN)
+    {
+        /* Signal calme : on ralentit d'un cran après plusieurs confirmations */
+        if (++r->calm >= SAMPLE_RATE_CALM_COUNT)
+        {
+            r->calm = 0;
+            if (r->level < SAMPLE_RATE_SLOW)
+                r->level = (sample_rate_level_t)(r->level + 1);
+        }
+    }
+    else
+    {
+        /* Zone d'hystérésis : on garde la cadence courante */
+        r->calm = 0;
+    }
+
+    return s_period_ms[r->level];
+}
+
+uint32_t SampleRate_PeriodMs(const sample_rate_t *r)
+{
+    return s_period_ms[r->level];
+}
@@ -0,0 +1,85 @@
+/*
+ * sample_rate.h
+ *
+ *  Created on: Jan 16, 2026
+ *      Author: penel
+ */
+
+#ifndef SAMPLE_RATE_H_
+#define SAMPLE_RATE_H_
+
+#include <stdint.h>
+
+/* Périodes d'acquisition (ms) : lente quand le signal est stable,
+ * rapide dès qu'il bouge ou que l'erreur de régulation est grande.
+ */
+#define SAMPLE_RATE_SLOW_MS        1000u
+#define SAMPLE_RATE_MEDIUM_MS      250u
+#define SAMPLE_RATE_FAST_MS        50u
+
+/* Seuils de pente |dT/dt| en 0.01 °C/s.
+ * Montée si pente > UP, descente seulement si pente < DOWN (hystérésis).
+ */
+#define SAMPLE_RATE_SLOPE_UP       20   /* 0.20 °C/s */
+#define SAMPLE_RATE_SLOPE_DOWN     5    /* 0.05 °C/s */
+
+/* Pente mesurée contre un échantillon vieux d'au moins cette durée : un
+ * écart d'un LSB (0.01 °C) donne au plus 1 (0.01 °C/s), sous
+ * SAMPLE_RATE_SLOPE_DOWN quelle que soit la cadence. Sur un seul
+ * intervalle de 50 ms, il donnerait 20 : le bruit de quantification
+ * empêcherait de ralentir.
+ */
+#define SAMPLE_RATE_SLOPE_WINDOW_MS 1000u
+
+/* Seuils d'erreur de régulation |T - Tref| en 0.01 °C */
+#define SAMPLE_RATE_ERR_UP         150  /* 1.50 °C */
+#define SAMPLE_RATE_ERR_DOWN       100  /* 1.00 °C */
+
+/* Nombre d'échantillons calmes consécutifs avant de ralentir d'un cran */
+#define SAMPLE_RATE_CALM_COUNT     10u
+
+/* Niveaux de cadence */
+typedef enum
+{
+    SAMPLE_RATE_FAST   = 0,
+    SAMPLE_RATE_MEDIUM = 1,
+    SAMPLE_RATE_SLOW   = 2
+} sample_rate_level_t;
+
+/**
+ * @brief État de la politique d'acquisition adaptative.
+ */
+typedef struct
+{
+    sample_rate_level_t level;
+    uint8_t  has_ref;      /* 1 dès le premier échantillon */
+    uint8_t  calm;         /* échantillons calmes consécutifs */
+    int32_t  ref_value;    /* référence de pente : l'échantillon le plus */
+    uint32_t ref_tick;     /* récent vieux d'au moins la fenêtre */
+    int32_t  next_value;   /* future référence */
+    uint32_t next_tick;
+    int32_t  slope;        /* dernière pente mesurée (0.01 °C/s) */
+} sample_rate_t;
+
+/**
+ * @brief Démarre en cadence rapide (état inconnu au démarrage).
+ */
+void SampleRate_Init(sample_rate_t *r);
+
+/**
+ * @brief Prend en compte un nouvel échantillon et choisit la cadence suivante.
+ *
+ * @param r          État de la politique.
+ * @param value      Valeur mesurée (0.01 °C).
+ * @param err_abs    |erreur de régulation| (0.01 °C).
+ * @param now        HAL_GetTick() au moment de la mesure.
+ * @return Période jusqu'au prochain échantillon (ms).
+ */
+uint32_t SampleRate_Update(sample_rate_t *r, int32_t value, int32_t err_abs, uint32_t now);
+
+/**
+ * @brief Période courante (ms).
+ */
+uint32_t SampleRate_PeriodMs(const sample_rate_t *r);
+
+#endif /* SAMPLE_RATE_H_ */
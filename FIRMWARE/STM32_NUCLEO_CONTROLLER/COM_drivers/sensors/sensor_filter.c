@@ -0,0 +1,144 @@
+/*
+ * sensor_filter.c
+ *
+ *  Created on: Jan 14, 2026
+ *      Author: penel
+ */
+
+#include "sensor_filter.h"
+#include <string.h>
+
+/* --------------------------------------------------------------------------
+ * Fonctions internes : médiane (fenêtre triée)
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @brief Première position i telle que sorted[i] >= x (recherche dichotomique).
+ */
+static uint8_t filt_lower_bound(const int32_t *sorted, uint8_t n, int32_t x)
+{
+    uint8_t lo = 0, hi = n;
+
+    while (lo < hi)
+    {
+        uint8_t mid = (uint8_t)((lo + hi) >> 1);
+        if (sorted[mid] < x)
+            lo = (uint8_t)(mid + 1u);
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static void filt_sorted_remove(int32_t *sorted, uint8_t n, int32_t x)
+{
+    uint8_t i = filt_lower_bound(sorted, n, x);
+
+    /* x est forcément présent : il a été inséré auparavant */
+    memmove(&sorted[i], &sorted[i + 1u], (size_t)(n - i - 1u) * sizeof(int32_t));
+}
+
+static void filt_sorted_insert(int32_t *sorted, uint8_t n, int32_t x)
+{
+    uint8_t i = filt_lower_bound(sorted, n, x);
+
+    memmove(&sorted[i + 1u], &sorted[i], (size_t)(n - i) * sizeof(int32_t));
+    sorted[i] = x;
+}
+
+/* --------------------------------------------------------------------------
+ * API
+ * -------------------------------------------------------------------------- */
+
+HAL_StatusTypeDef SensorFilter_Config(sensor_filter_t *f,
+                                      sensor_filter_type_t type,
+                                      uint8_t param)
+{
+    switch (type)
+    {
+    case SENSOR_FILTER_NONE:
+        param = 0;
+        break;
+    case SENSOR_FILTER_EMA:
+        if (param < SENSOR_FILTER_EMA_SHIFT_MIN || param > SENSOR_FILTER_EMA_SHIFT_MAX)
+            return HAL_ERROR;
+        break;
+    case SENSOR_FILTER_MA:
+        if (param == 0u || param > SENSOR_FILTER_MA_MAX)
+            return HAL_ERROR;
+        break;
+    case SENSOR_FILTER_MEDIAN:
+        if (param == 0u || param > SENSOR_FILTER_MEDIAN_MAX)
+            return HAL_ERROR;
+        break;
+    default:
+        return HAL_ERROR;
+    }
+
+    f->type  = type;
+    f->param = param;
+    SensorFilter_Reset(f);
+
+    return HAL_OK;
+}
+
+void SensorFilter_Reset(sensor_filter_t *f)
+{
+    f->count = 0;
+    f->head  = 0;
+    f->acc   = 0;
+    f->sum   = 0;
+}
+
+int32_t SensorFilter_Apply(sensor_filter_t *f, int32_t x)
+{
+    int32_t old;
+
+    switch (f->type)
+    {
+    case SENSOR_FILTER_EMA:
+        /* acc += alpha * (x - acc), alpha = 1/2^param, en Q8 */
+        if (f->count == 0u)
+        {
+            f->acc   = x * (1 << SENSOR_FILTER_EMA_FRAC_BITS);
+            f->count = 1;
+        }
+        else
+        {
+            f->acc += (x * (1 << SENSOR_FILTER_EMA_FRAC_BITS) - f->acc) >> f->param;
+        }
+        return (f->acc + (1 << (SENSOR_FILTER_EMA_FRAC_BITS - 1))) >> SENSOR_FILTER_EMA_FRAC_BITS;
+
+    case SENSOR_FILTER_MA:
+        /* Somme courante : on retire le plus ancien, on ajoute le nouveau */
+        if (f->count == f->param)
+        {
+            f->sum -= f->ring[f->head];
+        }
+        else
+        {
+            f->count++;
+        }
+        f->ring[f->head] = x;
+        f->sum += x;
+        f->head = (uint8_t)((f->head + 1u) % f->param);
+        return f->sum / (int32_t)f->count;
+
+    case SENSOR_FILTER_MEDIAN:
+        if (f->count == f->param)
+        {
+            old = f->ring[f->head];
+            filt_sorted_remove(f->sorted, f->count, old);
+            f->count--;
+        }
+        f->ring[f->head] = x;
+        f->head = (uint8_t)((f->head + 1u) % f->param);
+        filt_sorted_insert(f->sorted, f->count, x);
+        f->count++;
+        return f->sorted[f->count / 2u];
+
+    case SENSOR_FILTER_NONE:
+    default:
+        return x;
+    }
+}
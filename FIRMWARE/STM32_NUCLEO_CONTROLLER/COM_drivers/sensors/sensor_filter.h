@@ -0,0 +1,85 @@
+/*
+ * sensor_filter.h
+ *
+ *  Created on: Jan 14, 2026
+ *      Author: penel
+ */
+
+#ifndef SENSOR_FILTER_H_
+#define SENSOR_FILTER_H_
+
+#include "main.h"
+#include <stdint.h>
+
+/* Tailles maximales des fenêtres (RAM statique, pas d'allocation) */
+#define SENSOR_FILTER_MA_MAX      16u   /* moyenne glissante */
+#define SENSOR_FILTER_MEDIAN_MAX  9u    /* médiane glissante (impaire conseillée) */
+
+/* Paramètre EMA : alpha = 1 / 2^shift */
+#define SENSOR_FILTER_EMA_SHIFT_MIN  1u
+#define SENSOR_FILTER_EMA_SHIFT_MAX  8u
+
+/* Format interne de l'accumulateur EMA : Q8 (valeur << 8) */
+#define SENSOR_FILTER_EMA_FRAC_BITS  8
+
+/**
+ * @brief Types de filtre disponibles.
+ *        Les lettres sont celles utilisées par le protocole Raspberry.
+ */
+typedef enum
+{
+    SENSOR_FILTER_NONE   = 'N',  /* valeur brute */
+    SENSOR_FILTER_EMA    = 'E',  /* IIR 1er ordre, alpha = 1/2^param */
+    SENSOR_FILTER_MA     = 'M',  /* moyenne glissante sur param échantillons */
+    SENSOR_FILTER_MEDIAN = 'D'   /* médiane glissante sur param échantillons */
+} sensor_filter_type_t;
+
+/**
+ * @brief État d'un filtre (un par canal).
+ *
+ *  - ring   : derniers échantillons dans l'ordre d'arrivée (MA et médiane)
+ *  - sorted : mêmes échantillons triés (médiane uniquement)
+ *  - sum    : somme courante de la fenêtre (MA)
+ *  - acc    : accumulateur EMA en Q8
+ */
+typedef struct
+{
+    sensor_filter_type_t type;
+    uint8_t  param;
+    uint8_t  count;
+    uint8_t  head;
+    int32_t  acc;
+    int32_t  sum;
+    int32_t  ring[SENSOR_FILTER_MA_MAX];
+    int32_t  sorted[SENSOR_FILTER_MEDIAN_MAX];
+} sensor_filter_t;
+
+/**
+ * @brief Configure (et réinitialise) un filtre.
+ *
+ * @param f      Filtre à configurer.
+ * @param type   Type de filtre.
+ * @param param  EMA : shift (1..8) ; MA : fenêtre (1..16) ;
+ *               médiane : fenêtre (1..9) ; ignoré pour NONE.
+ * @return HAL_OK, ou HAL_ERROR si le couple type/param est invalide
+ *         (le filtre n'est alors pas modifié).
+ */
+HAL_StatusTypeDef SensorFilter_Config(sensor_filter_t *f,
+                                      sensor_filter_type_t type,
+                                      uint8_t param);
+
+/**
+ * @brief Vide l'historique du filtre (la configuration est conservée).
+ */
+void SensorFilter_Reset(sensor_filter_t *f);
+
+/**
+ * @brief Ajoute un échantillon et retourne la valeur filtrée.
+ *
+ *        Coût par échantillon : O(1) pour EMA et MA,
+ *        O(log n) recherche + décalage borné par SENSOR_FILTER_MEDIAN_MAX
+ *        pour la médiane.
+ */
+int32_t SensorFilter_Apply(sensor_filter_t *f, int32_t x);
+
+#endif /* SENSOR_FILTER_H_ */
@@ -0,0 +1,136 @@
+/*
+ * sensor_stats.c
+ *
+ *  Created on: Jan 21, 2026
+ *      Author: penel
+ */
+
+#include "sensor_stats.h"
+
+/* --------------------------------------------------------------------------
+ * Fonctions internes
+ * -------------------------------------------------------------------------- */
+
+/* Division entière arrondie au plus proche (b > 0) */
+static int64_t stats_div_round(int64_t a, int64_t b)
+{
+    return (a >= 0) ? (a + b / 2) / b : -((-a + b / 2) / b);
+}
+
+/* Racine carrée entière (plancher) */
+static uint32_t stats_isqrt64(uint64_t v)
+{
+    uint64_t res = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    while (bit > v)
+        bit >>= 2;
+
+    while (bit != 0u)
+    {
+        if (v >= res + bit)
+        {
+            v  -= res + bit;
+            res = (res >> 1) + bit;
+        }
+        else
+        {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)res;
+}
+
+static void stats_reset(sensor_stats_t *s, uint32_t now)
+{
+    s->start_tick = now;
+    s->count      = 0;
+    s->min        = INT32_MAX;
+    s->max        = INT32_MIN;
+    s->mean_q     = 0;
+    s->m2_q       = 0;
+}
+
+/**
+ * @brief Publie la fenêtre courante dans s->last (si elle contient des
+ *        échantillons) puis en démarre une nouvelle.
+ */
+static void stats_close(sensor_stats_t *s, uint32_t now)
+{
+    uint64_t var_q16;
+
+    if (s->count > 0u)
+    {
+        var_q16 = (uint64_t)(s->m2_q / (int64_t)s->count);
+
+        s->last.seq++;
+        s->last.count    = s->count;
+        s->last.min      = s->min;
+        s->last.max      = s->max;
+        s->last.mean     = (int32_t)stats_div_round(s->mean_q, 1 << SENSOR_STATS_FRAC_BITS);
+        s->last.var      = (uint32_t)((var_q16 + (1u << (2 * SENSOR_STATS_FRAC_BITS - 1)))
+                                      >> (2 * SENSOR_STATS_FRAC_BITS));
+        /* sqrt(Q16) = Q8 */
+        s->last.std      = (stats_isqrt64(var_q16) + (1u << (SENSOR_STATS_FRAC_BITS - 1)))
+                           >> SENSOR_STATS_FRAC_BITS;
+        s->last.end_tick = now;
+    }
+
+    /* Fenêtres alignées : la suivante démarre à la fin théorique de celle-ci */
+    if ((now - s->start_tick) < 2u * s->window_ms)
+        stats_reset(s, s->start_tick + s->window_ms);
+    else
+        stats_reset(s, now);
+}
+
+/* --------------------------------------------------------------------------
+ * API
+ * -------------------------------------------------------------------------- */
+
+void SensorStats_Init(sensor_stats_t *s, uint32_t window_ms, uint32_t now)
+{
+    s->window_ms = window_ms;
+    s->last.seq  = 0;
+    s->last.count = 0;
+    stats_reset(s, now);
+}
+
+int SensorStats_SetWindow(sensor_stats_t *s, uint32_t window_ms, uint32_t now)
+{
+    if (window_ms < SENSOR_STATS_WINDOW_MIN_MS || window_ms > SENSOR_STATS_WINDOW_MAX_MS)
+        return -1;
+
+    s->window_ms = window_ms;
+    stats_reset(s, now);
+    return 0;
+}
+
+void SensorStats_Poll(sensor_stats_t *s, uint32_t now)
+{
+    if ((now - s->start_tick) >= s->window_ms)
+        stats_close(s, now);
+}
+
+void SensorStats_Add(sensor_stats_t *s, int32_t x, uint32_t now)
+{
+    int64_t x_q, delta;
+
+    SensorStats_Poll(s, now);
+
+    x_q = (int64_t)x * (1 << SENSOR_STATS_FRAC_BITS);
+
+    /* Welford :
+     *   n     = n + 1
+     *   delta = x - mean
+     *   mean  = mean + delta / n
+     *   M2    = M2 + delta * (x - mean)
+     */
+    s->count++;
+    delta      = x_q - s->mean_q;
+    s->mean_q += stats_div_round(delta, (int64_t)s->count);
+    s->m2_q   += delta * (x_q - s->mean_q);
+
+    if (x < s->min) s->min = x;
+    if (x > s->max) s->max = x;
+}
@@ -0,0 +1,85 @@
+/*
+ * sensor_stats.h
+ *
+ *  Created on: Jan 21, 2026
+ *      Author: penel
+ */
+
+#ifndef SENSOR_STATS_H_
+#define SENSOR_STATS_H_
+
+#include <stdint.h>
+
+/* Format interne de la moyenne Welford : Q8 (valeur << 8) */
+#define SENSOR_STATS_FRAC_BITS   8
+
+/* Bornes de la longueur de fenêtre (ms) */
+#define SENSOR_STATS_WINDOW_MIN_MS   100u
+#define SENSOR_STATS_WINDOW_MAX_MS   3600000u   /* 1 h */
+
+/**
+ * @brief Résultat d'une fenêtre terminée.
+ *
+ *  - seq      : numéro de fenêtre (0 = aucune fenêtre terminée)
+ *  - count    : nombre d'échantillons
+ *  - min/max  : extrêmes (unité du canal)
+ *  - mean     : moyenne arrondie (unité du canal)
+ *  - var      : variance de population arrondie (unité du canal au carré)
+ *  - std      : écart-type arrondi (unité du canal)
+ *  - end_tick : HAL_GetTick() à la clôture
+ */
+typedef struct
+{
+    uint32_t seq;
+    uint32_t count;
+    int32_t  min;
+    int32_t  max;
+    int32_t  mean;
+    uint32_t var;
+    uint32_t std;
+    uint32_t end_tick;
+} sensor_stats_window_t;
+
+/**
+ * @brief Agrégateur à fenêtre fixe (tumbling window) par l'algorithme de
+ *        Welford, en virgule fixe.
+ *
+ *  - mean_q : moyenne courante en Q8
+ *  - m2_q   : somme des carrés des écarts en Q16
+ */
+typedef struct
+{
+    uint32_t window_ms;
+    uint32_t start_tick;
+    uint32_t count;
+    int32_t  min;
+    int32_t  max;
+    int64_t  mean_q;
+    int64_t  m2_q;
+    sensor_stats_window_t last;
+} sensor_stats_t;
+
+/**
+ * @brief Initialise l'agrégateur et démarre une fenêtre.
+ */
+void SensorStats_Init(sensor_stats_t *s, uint32_t window_ms, uint32_t now);
+
+/**
+ * @brief Change la longueur de fenêtre (la fenêtre en cours est abandonnée).
+ *
+ * @return 0 si OK, -1 si la longueur est hors bornes.
+ */
+int SensorStats_SetWindow(sensor_stats_t *s, uint32_t window_ms, uint32_t now);
+
+/**
+ * @brief Ajoute un échantillon. Si la fenêtre est écoulée, elle est d'abord
+ *        clôturée (résultat dans s->last) et une nouvelle fenêtre démarre.
+ */
+void SensorStats_Add(sensor_stats_t *s, int32_t x, uint32_t now);
+
+/**
+ * @brief Clôture la fenêtre si elle est écoulée, même sans nouvel échantillon.
+ */
+void SensorStats_Poll(sensor_stats_t *s, uint32_t now);
+
+#endif /* SENSOR_STATS_H_ */
@@ -6,33 +6,67 @@
  */
 
 #include "sensors_app.h"
-#include <stdio.h>
+#include "../time/timebase.h"
+#include "../log/log.h"
 
 /* Handles capteurs */
 static BMP280_HandleTypedef s_bmp;
 static mpu9250_raw_data_t   s_imu;
 
+/* Conditionnement : un filtre par canal, appliqué avant publication */
+static sensor_filter_t s_filter[SENSORS_CH_COUNT];
+
+/* Configuration par défaut : EMA alpha = 1/4 sur T et P, angle brut */
+#define SENSORS_DEFAULT_EMA_SHIFT  2u
+
+/* Agrégats par fenêtre fixe, calculés sur les valeurs publiées */
+static sensor_stats_t s_stats[SENSORS_CH_COUNT][SENSORS_STATS_SLOTS];
+
+/* Acquisition adaptative */
+static sample_rate_t s_rate;
+static uint32_t      s_next_sample_tick = 0;
+static int32_t       s_ref_centi = 0;
+
 /* Etat global */
 static sensors_state_t s_state =
 {
     .temp_centi  = 0,
     .press_pa    = 0,
-    .angle_milli = 0
+    .angle_milli = 0,
+    .period_ms   = SAMPLE_RATE_FAST_MS,
+    .sample_seq  = 0,
+    .sample_tick = 0,
+    .sample_us   = 0
 };
 
 HAL_StatusTypeDef SensorsApp_Init(I2C_HandleTypeDef *hi2c)
 {
-    printf("\r\n=== Init capteurs ===\r\n");
+    uint32_t ch;
+
+    LOG_I(LOG_MOD_SENS, "=== Init capteurs ===");
+
+    (void)SensorFilter_Config(&s_filter[SENSORS_CH_TEMP],  SENSOR_FILTER_EMA, SENSORS_DEFAULT_EMA_SHIFT);
+    (void)SensorFilter_Config(&s_filter[SENSORS_CH_PRESS], SENSOR_FILTER_EMA, SENSORS_DEFAULT_EMA_SHIFT);
+    (void)SensorFilter_Config(&s_filter[SENSORS_CH_ANGLE], SENSOR_FILTER_NONE, 0);
+
+    SampleRate_Init(&s_rate);
+    s_next_sample_tick = HAL_GetTick();
+
+    for (ch = 0; ch < SENSORS_CH_COUNT; ch++)
+    {
+        SensorStats_Init(&s_stats[ch][0], SENSORS_STATS_DEFAULT_0_MS, s_next_sample_tick);
+        SensorStats_Init(&s_stats[ch][1], SENSORS_STATS_DEFAULT_1_MS, s_next_sample_tick);
+    }
 
     if (BMP280_Init(&s_bmp, hi2c, BMP280_I2C_ADDR_DEFAULT) != HAL_OK)
     {
-        printf("Erreur init BMP280\r\n");
+        LOG_E(LOG_MOD_SENS, "Erreur init BMP280");
         return HAL_ERROR;
     }
 
     if (mpu9250_init() != HAL_OK)
     {
-        printf("Erreur init MPU9250\r\n");
+        LOG_E(LOG_MOD_SENS, "Erreur init MPU9250");
         /* On ne bloque pas forcément : à toi de décider */
         return HAL_ERROR;
     }
@@ -45,25 +79,128 @@ void SensorsApp_Update(void)
     uint32_t raw_temp, raw_press;
     BMP280_S32_t T;
     BMP280_U32_t P;
+    int32_t err;
+    uint32_t ch, slot;
+    uint8_t published = 0;
+    uint32_t now = HAL_GetTick();
+    /* Instant de la lecture ; entretient aussi l'extension 64 bits */
+    uint32_t t_us = (uint32_t)Timebase_Now();
+
+    /* Clôture des fenêtres écoulées, même en cadence lente */
+    for (ch = 0; ch < SENSORS_CH_COUNT; ch++)
+        for (slot = 0; slot < SENSORS_STATS_SLOTS; slot++)
+            SensorStats_Poll(&s_stats[ch][slot], now);
+
+    /* Pas encore l'heure : aucun accès bus */
+    if ((int32_t)(now - s_next_sample_tick) < 0)
+        return;
 
     if (BMP280_ReadRaw(&s_bmp, &raw_temp, &raw_press) == HAL_OK)
     {
         T = BMP280_Compensate_T_int32(&s_bmp, (BMP280_S32_t)raw_temp);
         P = BMP280_Compensate_P_int32(&s_bmp, (BMP280_S32_t)raw_press);
 
-        s_state.temp_centi = (int32_t)T;
-        s_state.press_pa   = (uint32_t)P;
+        s_state.temp_centi = SensorFilter_Apply(&s_filter[SENSORS_CH_TEMP], (int32_t)T);
+        s_state.press_pa   = (uint32_t)SensorFilter_Apply(&s_filter[SENSORS_CH_PRESS], (int32_t)P);
+
+        err = s_state.temp_centi - s_ref_centi;
+        if (err < 0)
+            err = -err;
+
+        s_state.period_ms = SampleRate_Update(&s_rate, s_state.temp_centi, err, now);
+        published = 1;
+
+        for (slot = 0; slot < SENSORS_STATS_SLOTS; slot++)
+        {
+            SensorStats_Add(&s_stats[SENSORS_CH_TEMP][slot],  s_state.temp_centi, now);
+            SensorStats_Add(&s_stats[SENSORS_CH_PRESS][slot], (int32_t)s_state.press_pa, now);
+        }
     }
 
+    s_next_sample_tick = now + s_state.period_ms;
+
     if (mpu9250_read_raw(&s_imu) == HAL_OK)
     {
         /* TODO: calcul angle (plus tard) */
-        s_state.angle_milli = 0;
+        s_state.angle_milli = SensorFilter_Apply(&s_filter[SENSORS_CH_ANGLE], 0);
+
+        for (slot = 0; slot < SENSORS_STATS_SLOTS; slot++)
+            SensorStats_Add(&s_stats[SENSORS_CH_ANGLE][slot], s_state.angle_milli, now);
+        published = 1;
+    }
+
+    /* Nouvelle publication : le protocole reconstruit ses réponses en cache */
+    if (published)
+    {
+        s_state.sample_tick = now;
+        s_state.sample_us   = t_us;
+        s_state.sample_seq++;
     }
 }
 
+void SensorsApp_SetControlRef(int32_t ref_centi)
+{
+    s_ref_centi = ref_centi;
+}
+
+int32_t SensorsApp_GetControlRef(void)
+{
+    return s_ref_centi;
+}
+
+HAL_StatusTypeDef SensorsApp_SetFilter(sensors_channel_t ch,
+                                       sensor_filter_type_t type,
+                                       uint8_t param)
+{
+    if ((unsigned)ch >= SENSORS_CH_COUNT)
+        return HAL_ERROR;
+
+    return SensorFilter_Config(&s_filter[ch], type, param);
+}
+
+HAL_StatusTypeDef SensorsApp_GetFilter(sensors_channel_t ch,
+                                       sensor_filter_type_t *type,
+                                       uint8_t *param)
+{
+    if ((unsigned)ch >= SENSORS_CH_COUNT || type == NULL || param == NULL)
+        return HAL_ERROR;
+
+    *type  = s_filter[ch].type;
+    *param = s_filter[ch].param;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef SensorsApp_SetStatsWindow(sensors_channel_t ch, uint8_t slot,
+                                            uint32_t window_ms)
+{
+    if ((unsigned)ch >= SENSORS_CH_COUNT || slot >= SENSORS_STATS_SLOTS)
+        return HAL_ERROR;
+
+    if (SensorStats_SetWindow(&s_stats[ch][slot], window_ms, HAL_GetTick()) != 0)
+        return HAL_ERROR;
+
+    return HAL_OK;
+}
+
+const sensor_stats_window_t* SensorsApp_GetStats(sensors_channel_t ch, uint8_t slot,
+                                                 uint32_t *window_ms)
+{
+    if ((unsigned)ch >= SENSORS_CH_COUNT || slot >= SENSORS_STATS_SLOTS)
+        return NULL;
+
+    if (window_ms != NULL)
+        *window_ms = s_stats[ch][slot].window_ms;
+
+    return &s_stats[ch][slot].last;
+}
+
 const sensors_state_t* SensorsApp_GetState(void)
 {
     return &s_state;
 }
 
+const i2c_bus_dev_t* SensorsApp_GetBmpBusHealth(void)
+{
+    return &s_bmp.bus;
+}
+
@@ -12,13 +12,36 @@
 #include <stdint.h>
 #include "bmp280.h"
 #include "mpu9250.h"
+#include "sensor_filter.h"
+#include "sample_rate.h"
+#include "sensor_stats.h"
 
-/* Etat capteurs disponible pour le protocole */
+/* Canaux conditionnés (un filtre par canal) */
+typedef enum
+{
+    SENSORS_CH_TEMP  = 0,   /* temp_centi  */
+    SENSORS_CH_PRESS = 1,   /* press_pa    */
+    SENSORS_CH_ANGLE = 2,   /* angle_milli */
+    SENSORS_CH_COUNT
+} sensors_channel_t;
+
+/* Statistiques glissantes : 2 fenêtres indépendantes par canal
+ * (par défaut 1 s et 1 min)
+ */
+#define SENSORS_STATS_SLOTS          2u
+#define SENSORS_STATS_DEFAULT_0_MS   1000u
+#define SENSORS_STATS_DEFAULT_1_MS   60000u
+
+/* Etat capteurs disponible pour le protocole (valeurs filtrées) */
 typedef struct
 {
     volatile int32_t  temp_centi;   /* Température en 0.01°C */
     volatile uint32_t press_pa;     /* Pression en Pa */
     volatile int32_t  angle_milli;  /* Angle en 0.001° (placeholder) */
+    volatile uint32_t period_ms;    /* Période d'acquisition courante (ms) */
+    volatile uint32_t sample_seq;   /* Incrémenté à chaque publication (T/P et/ou angle) */
+    volatile uint32_t sample_tick;  /* HAL_GetTick() de la dernière publication */
+    volatile uint32_t sample_us;    /* Timebase (µs, 32 bits bas) de la lecture publiée */
 } sensors_state_t;
 
 /**
@@ -31,14 +54,65 @@ HAL_StatusTypeDef SensorsApp_Init(I2C_HandleTypeDef *hi2c);
 
 /**
  * @brief Met à jour les valeurs globales (T, P, angle).
- *        À appeler périodiquement dans la boucle.
+ *        À appeler à chaque tour de boucle : l'acquisition n'a lieu que
+ *        lorsque la période adaptative (sample_rate.h) est écoulée.
  */
 void SensorsApp_Update(void);
 
+/**
+ * @brief Consigne de température (0.01 °C) utilisée pour calculer
+ *        l'erreur de régulation qui pilote la cadence d'acquisition.
+ */
+void SensorsApp_SetControlRef(int32_t ref_centi);
+int32_t SensorsApp_GetControlRef(void);
+
+/**
+ * @brief Configure le filtre d'un canal (voir SensorFilter_Config).
+ *        L'historique du canal est remis à zéro.
+ *
+ * @return HAL_OK, ou HAL_ERROR si canal / type / paramètre invalide.
+ */
+HAL_StatusTypeDef SensorsApp_SetFilter(sensors_channel_t ch,
+                                       sensor_filter_type_t type,
+                                       uint8_t param);
+
+/**
+ * @brief Lit la configuration du filtre d'un canal.
+ *
+ * @return HAL_OK, ou HAL_ERROR si canal invalide.
+ */
+HAL_StatusTypeDef SensorsApp_GetFilter(sensors_channel_t ch,
+                                       sensor_filter_type_t *type,
+                                       uint8_t *param);
+
+/**
+ * @brief Change la longueur d'une fenêtre de statistiques
+ *        (la fenêtre en cours est abandonnée).
+ *
+ * @return HAL_OK, ou HAL_ERROR si canal / slot / longueur invalide.
+ */
+HAL_StatusTypeDef SensorsApp_SetStatsWindow(sensors_channel_t ch, uint8_t slot,
+                                            uint32_t window_ms);
+
+/**
+ * @brief Dernière fenêtre terminée d'un canal (seq = 0 : aucune encore).
+ *
+ * @param window_ms  Longueur de fenêtre configurée (peut être NULL).
+ * @return pointeur stable, ou NULL si canal / slot invalide.
+ */
+const sensor_stats_window_t* SensorsApp_GetStats(sensors_channel_t ch, uint8_t slot,
+                                                 uint32_t *window_ms);
+
 /**
  * @brief Accès à l’état courant des capteurs (pointeur stable).
  */
 const sensors_state_t* SensorsApp_GetState(void);
 
+/**
+ * @brief Compteurs d'erreurs / backoff I2C du BMP280
+ *        (pour le MPU9250 : mpu9250_get_bus_health()).
+ */
+const i2c_bus_dev_t* SensorsApp_GetBmpBusHealth(void);
+
 #endif /* SENSORS_APP_H_ */
 
@@ -0,0 +1,108 @@
+/*
+ * perf.c
+ *
+ *  Created on: Feb 11, 2026
+ *      Author: penel
+ */
+
+#include "perf.h"
+#include <string.h>
+
+/* Ordre de perf_probe_t */
+static const char *const s_names[PERF_COUNT] =
+{
+    [PERF_LOOP]       = "LOOP",
+    [PERF_SENSORS]    = "SENS",
+    [PERF_IMUCAP]     = "IMUCAP",
+    [PERF_RPI]        = "RPI",
+    [PERF_VALVE]      = "VALVE",
+    [PERF_I2C]        = "I2C",
+    [PERF_CAN]        = "CAN",
+    [PERF_FLASH]      = "FLASH",
+    [PERF_SYSTICK]    = "SYSTICK",
+    [PERF_USART1]     = "USART1",
+    [PERF_USART2]     = "USART2",
+    [PERF_DMA_PI_RX]  = "DMA_PIRX",
+    [PERF_DMA_PI_TX]  = "DMA_PITX",
+    [PERF_DMA_DBG_TX] = "DMA_DBGTX",
+    [PERF_TIM7]       = "TIM7",
+};
+
+/* min à 0xFFFFFFFF tant que la sonde est vide */
+static perf_stats_t s_probes[PERF_COUNT];
+
+void Perf_CounterEnable(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void Perf_Init(void)
+{
+    Perf_CounterEnable();
+    Perf_Reset();
+}
+
+void Perf_Record(perf_probe_t p, uint32_t cycles)
+{
+    perf_stats_t *s = &s_probes[p];
+    uint32_t bin = (cycles > 1u) ? 31u - __CLZ(cycles) : 0u;
+
+    if (bin >= PERF_HIST_BINS)
+        bin = PERF_HIST_BINS - 1u;
+
+    s->count++;
+    s->sum += cycles;
+    if (cycles < s->min)
+        s->min = cycles;
+    if (cycles > s->max)
+        s->max = cycles;
+    s->hist[bin]++;
+}
+
+HAL_StatusTypeDef Perf_Get(perf_probe_t p, perf_stats_t *out)
+{
+    uint32_t primask;
+
+    if (p >= PERF_COUNT)
+        return HAL_ERROR;
+
+    /* Sondes d'interruption : pas de mise à jour pendant la copie */
+    primask = __get_PRIMASK();
+    __disable_irq();
+    *out = s_probes[p];
+    __set_PRIMASK(primask);
+
+    if (out->count == 0u)
+        out->min = 0u;
+    return HAL_OK;
+}
+
+void Perf_Reset(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t i;
+
+    __disable_irq();
+    memset(s_probes, 0, sizeof(s_probes));
+    for (i = 0; i < PERF_COUNT; i++)
+        s_probes[i].min = 0xFFFFFFFFu;
+    __set_PRIMASK(primask);
+}
+
+const char *Perf_Name(perf_probe_t p)
+{
+    return (p < PERF_COUNT) ? s_names[p] : NULL;
+}
+
+perf_probe_t Perf_Find(const char *name, size_t len)
+{
+    uint32_t i;
+
+    for (i = 0; i < PERF_COUNT; i++)
+    {
+        if (strlen(s_names[i]) == len && strncmp(s_names[i], name, len) == 0)
+            return (perf_probe_t)i;
+    }
+    return PERF_COUNT;
+}
@@ -0,0 +1,130 @@
+/*
+ * perf.h
+ *
+ *  Created on: Feb 11, 2026
+ *      Author: penel
+ */
+
+#ifndef PERF_H_
+#define PERF_H_
+
+#include "main.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Profilage en cycles CPU (compteur DWT du Cortex-M4) : où passe le temps
+ * de la boucle principale et des interruptions.
+ *
+ * Chaque sonde mesure la durée d'une portion de code entre PERF_BEGIN()
+ * et PERF_END() et accumule nombre, minimum, maximum, somme et un
+ * histogramme log2 : la case k compte les durées de [2^k ; 2^(k+1)[
+ * cycles (case 0 : 0 ou 1 cycle, dernière case : tout ce qui dépasse).
+ *
+ *  - une sonde n'est mise à jour que depuis un seul contexte (boucle
+ *    principale ou une interruption donnée) : pas de verrou à l'écriture
+ *  - durées brutes : une sonde de la boucle principale inclut le temps des
+ *    interruptions survenues pendant la mesure
+ *  - coût d'une mesure : une vingtaine de cycles
+ *
+ * Lecture par le Raspberry Pi (GET_PERF, remise à zéro PERF_RST) ;
+ * python/stm32_perf.py affiche et compare deux relevés.
+ */
+
+/* 0 : PERF_BEGIN() / PERF_END() ne génèrent aucun code */
+#ifndef PERF_ENABLE
+#define PERF_ENABLE         1
+#endif
+
+/* 2^24 cycles : 200 ms à 84 MHz, plus long que la boucle */
+#define PERF_HIST_BINS      24u
+
+typedef enum
+{
+    PERF_LOOP = 0,      /* un tour de boucle, hors HAL_Delay() */
+    PERF_SENSORS,       /* SensorsApp_Update() */
+    PERF_IMUCAP,        /* ImuCapture_Task() */
+    PERF_RPI,           /* RpiProto_Task() */
+    PERF_VALVE,         /* ValveControl_Update() */
+    PERF_I2C,           /* transaction I2C (I2CBus_MemRead/MemWrite) */
+    PERF_CAN,           /* envoi d'une trame CAN au moteur */
+    PERF_FLASH,         /* écriture d'un paramètre (FlashEe_Write) */
+    PERF_SYSTICK,       /* interruptions */
+    PERF_USART1,
+    PERF_USART2,
+    PERF_DMA_PI_RX,
+    PERF_DMA_PI_TX,
+    PERF_DMA_DBG_TX,
+    PERF_TIM7,
+    PERF_COUNT
+} perf_probe_t;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;                       /* cycles ; 0 si count == 0 */
+    uint32_t max;
+    uint64_t sum;
+    uint32_t hist[PERF_HIST_BINS];
+} perf_stats_t;
+
+/**
+ * @brief Active le compteur de cycles DWT (sans toucher aux sondes).
+ *        Sans effet s'il tourne déjà.
+ */
+void Perf_CounterEnable(void);
+
+/**
+ * @brief Active le compteur et remet les sondes à zéro.
+ */
+void Perf_Init(void);
+
+/**
+ * @brief Compteur de cycles, tous contextes.
+ */
+static inline uint32_t Perf_Now(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief Ajoute une durée (cycles) à une sonde. Appelée par PERF_END().
+ */
+void Perf_Record(perf_probe_t p, uint32_t cycles);
+
+/**
+ * @brief Copie cohérente des compteurs d'une sonde.
+ *
+ * @return HAL_ERROR si la sonde n'existe pas
+ */
+HAL_StatusTypeDef Perf_Get(perf_probe_t p, perf_stats_t *out);
+
+/**
+ * @brief Remet toutes les sondes à zéro.
+ */
+void Perf_Reset(void);
+
+/**
+ * @brief Nom court d'une sonde ("LOOP", "I2C"...), NULL si inconnue.
+ */
+const char *Perf_Name(perf_probe_t p);
+
+/**
+ * @brief Sonde d'après son nom (len caractères) ; PERF_COUNT si inconnu.
+ */
+perf_probe_t Perf_Find(const char *name, size_t len);
+
+#if PERF_ENABLE
+
+/* Une seule paire par sonde et par bloc */
+#define PERF_BEGIN(p)       const uint32_t perf_t0_##p = Perf_Now()
+#define PERF_END(p)         Perf_Record((p), Perf_Now() - perf_t0_##p)
+
+#else
+
+#define PERF_BEGIN(p)       ((void)0)
+#define PERF_END(p)         ((void)0)
+
+#endif /* PERF_ENABLE */
+
+#endif /* PERF_H_ */
@@ -0,0 +1,68 @@
+/*
+ * timebase.c
+ *
+ *  Created on: Feb 6, 2026
+ *      Author: penel
+ */
+
+#include "timebase.h"
+
+/* Extension 64 bits : tours complets de TIM2 et dernière valeur lue */
+static uint32_t s_wraps = 0;
+static uint32_t s_last  = 0;
+
+/* Horloge des timers APB1 : x2 si APB1 est divisé */
+static uint32_t tb_timer_clock(void)
+{
+    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1)
+        return 2u * pclk1;
+    return pclk1;
+}
+
+HAL_StatusTypeDef Timebase_Init(void)
+{
+    uint32_t clk = tb_timer_clock();
+
+    if (clk % TIMEBASE_HZ != 0u)
+        return HAL_ERROR;
+
+    TIMEBASE_CLK_ENABLE();
+    TIMEBASE_TIM->CR1  = 0;
+    TIMEBASE_TIM->PSC  = clk / TIMEBASE_HZ - 1u;
+    TIMEBASE_TIM->ARR  = 0xFFFFFFFFu;
+    TIMEBASE_TIM->CNT  = 0;
+    TIMEBASE_TIM->EGR  = TIM_EGR_UG;    /* charge PSC */
+    TIMEBASE_TIM->SR   = 0;
+    TIMEBASE_TIM->DIER = 0;
+    TIMEBASE_TIM->CR1  = TIM_CR1_CEN;
+
+    s_wraps = 0;
+    s_last  = 0;
+    return HAL_OK;
+}
+
+uint64_t Timebase_Now(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t cnt;
+    uint64_t t;
+
+    __disable_irq();
+    cnt = TIMEBASE_TIM->CNT;
+    if (cnt < s_last)
+        s_wraps++;
+    s_last = cnt;
+    t = ((uint64_t)s_wraps << 32) | cnt;
+    __set_PRIMASK(primask);
+
+    return t;
+}
+
+uint64_t Timebase_Extend(uint32_t t32)
+{
+    uint64_t now = Timebase_Now();
+
+    return now - (uint32_t)((uint32_t)now - t32);
+}
@@ -0,0 +1,59 @@
+/*
+ * timebase.h
+ *
+ *  Created on: Feb 6, 2026
+ *      Author: penel
+ */
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+#include "main.h"
+#include <stdint.h>
+
+/*
+ * Base de temps des horodatages (échantillons, événements, synchronisation
+ * avec le Raspberry Pi) : microsecondes depuis Timebase_Init().
+ *
+ *  - TIM2 (32 bits) à 1 MHz, libre : les 32 bits bas se lisent
+ *    directement, utilisables en interruption (Timebase_Now32)
+ *  - extension à 64 bits en logiciel : Timebase_Now() doit être appelée au
+ *    moins une fois par tour de TIM2 (71 min) ; SensorsApp_Update() le
+ *    fait à chaque passage
+ *
+ * Le STM32 ne corrige pas son horloge : le Raspberry Pi estime décalage et
+ * dérive par l'échange "TIME=" (t1 Pi, t2/t3 STM32, t4 Pi, voir
+ * rpi_protocol.h) et convertit lui-même les horodatages en heure murale
+ * (python/stm32_time.py). Les horodatages restent ainsi monotones, sans
+ * saut lors d'une nouvelle estimation.
+ */
+
+#define TIMEBASE_TIM            TIM2
+#define TIMEBASE_CLK_ENABLE     __HAL_RCC_TIM2_CLK_ENABLE
+#define TIMEBASE_HZ             1000000u
+
+/**
+ * @brief Lance TIM2 à 1 MHz (configuré par registres, pas de périphérique
+ *        CubeMX). À appeler avant tout horodatage.
+ */
+HAL_StatusTypeDef Timebase_Init(void);
+
+/**
+ * @brief 32 bits bas de la base de temps (µs), tous contextes.
+ */
+static inline uint32_t Timebase_Now32(void)
+{
+    return TIMEBASE_TIM->CNT;
+}
+
+/**
+ * @brief Base de temps complète (µs, 64 bits).
+ */
+uint64_t Timebase_Now(void);
+
+/**
+ * @brief Valeur 64 bits d'un horodatage 32 bits passé (moins de 71 min).
+ */
+uint64_t Timebase_Extend(uint32_t t32);
+
+#endif /* TIMEBASE_H_ */
@@ -0,0 +1,119 @@
+/*
+ * uart_baud.c
+ *
+ *  Created on: Jan 28, 2026
+ *      Author: penel
+ */
+
+#include "uart_baud.h"
+#include "uart_tx.h"
+#include "uart_rx.h"
+
+/* Emission du dernier message avant changement de débit */
+#define UART_BAUD_FLUSH_TIMEOUT_MS  100u
+
+/* --------------------------------------------------------------------------
+ * Fonctions internes
+ * -------------------------------------------------------------------------- */
+
+static uint32_t baud_pclk(const UART_HandleTypeDef *huart)
+{
+    if (huart->Instance == USART1 || huart->Instance == USART6)
+        return HAL_RCC_GetPCLK2Freq();
+    return HAL_RCC_GetPCLK1Freq();
+}
+
+/**
+ * @brief Broches RTS/CTS de USART1 (AF7). HAL_UART_MspInit n'est pas
+ *        rappelé par HAL_UART_Init sur un UART déjà initialisé : elles sont
+ *        configurées ici, et remises en analogique sans contrôle de flux.
+ */
+static HAL_StatusTypeDef baud_flow_pins(const UART_HandleTypeDef *huart, uint32_t hw_flow)
+{
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    if (hw_flow == UART_HWCONTROL_NONE)
+    {
+        if (huart->Instance == USART1 && huart->Init.HwFlowCtl != UART_HWCONTROL_NONE)
+            HAL_GPIO_DeInit(GPIOA, GPIO_PIN_11 | GPIO_PIN_12);
+        return HAL_OK;
+    }
+
+    if (huart->Instance != USART1 || hw_flow != UART_HWCONTROL_RTS_CTS)
+        return HAL_ERROR;
+
+    /**USART1 GPIO Configuration
+    PA11     ------> USART1_CTS
+    PA12     ------> USART1_RTS
+    */
+    __HAL_RCC_GPIOA_CLK_ENABLE();
+    GPIO_InitStruct.Pin = GPIO_PIN_11 | GPIO_PIN_12;
+    GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+    GPIO_InitStruct.Pull = GPIO_PULLUP;   /* CTS actif bas : pas d'émission si fil absent */
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+    GPIO_InitStruct.Alternate = GPIO_AF7_USART1;
+    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+    return HAL_OK;
+}
+
+/* --------------------------------------------------------------------------
+ * API
+ * -------------------------------------------------------------------------- */
+
+uint32_t UartBaud_Actual(const UART_HandleTypeDef *huart, uint32_t baud)
+{
+    uint32_t pclk = baud_pclk(huart);
+    uint32_t brr, div, actual, err;
+
+    if (baud == 0u || !IS_UART_BAUDRATE(baud))
+        return 0;
+
+    /* Diviseur en 1/16 (OVER16) ou 1/8 (OVER8) de bit, comme UART_SetConfig() */
+    if (huart->Init.OverSampling == UART_OVERSAMPLING_8)
+    {
+        brr = UART_BRR_SAMPLING8(pclk, baud);
+        div = ((brr >> 4) << 3) + (brr & 0x7u);
+    }
+    else
+    {
+        brr = UART_BRR_SAMPLING16(pclk, baud);
+        div = brr;
+    }
+
+    if (div == 0u)
+        return 0;
+
+    actual = (pclk + div / 2u) / div;
+    err    = (actual > baud) ? actual - baud : baud - actual;
+    if ((uint64_t)err * 1000u > (uint64_t)baud * UART_BAUD_MAX_ERR_PERMILLE)
+        return 0;
+
+    return actual;
+}
+
+HAL_StatusTypeDef UartBaud_Set(UART_HandleTypeDef *huart, uint32_t baud, uint32_t hw_flow)
+{
+    HAL_StatusTypeDef st;
+
+    if (huart == NULL || UartBaud_Actual(huart, baud) == 0u)
+        return HAL_ERROR;
+
+    if (hw_flow != UART_HWCONTROL_NONE &&
+        (huart->Instance != USART1 || hw_flow != UART_HWCONTROL_RTS_CTS))
+        return HAL_ERROR;
+
+    /* Dernière réponse envoyée à l'ancien débit */
+    (void)UartTx_Flush(huart, UART_BAUD_FLUSH_TIMEOUT_MS);
+
+    UartRx_Stop(huart);
+
+    if (baud_flow_pins(huart, hw_flow) != HAL_OK)
+        return HAL_ERROR;
+
+    huart->Init.BaudRate  = baud;
+    huart->Init.HwFlowCtl = hw_flow;
+    st = HAL_UART_Init(huart);
+
+    (void)UartRx_Resume(huart);
+    return st;
+}
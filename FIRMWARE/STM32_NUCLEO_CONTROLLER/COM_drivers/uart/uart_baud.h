@@ -0,0 +1,38 @@
+/*
+ * uart_baud.h
+ *
+ *  Created on: Jan 28, 2026
+ *      Author: penel
+ */
+
+#ifndef UART_BAUD_H_
+#define UART_BAUD_H_
+
+#include "main.h"
+#include <stdint.h>
+
+/* Ecart toléré entre débit demandé et débit obtenu (BRR) : 2 % */
+#define UART_BAUD_MAX_ERR_PERMILLE  20u
+
+/**
+ * @brief Débit réellement obtenu pour `baud`, calculé depuis l'horloge du
+ *        bus de l'UART (PCLK2 pour USART1/6, PCLK1 sinon) et du
+ *        suréchantillonnage configuré.
+ *
+ * @return débit effectif (bauds), 0 si l'écart dépasse 2 %.
+ */
+uint32_t UartBaud_Actual(const UART_HandleTypeDef *huart, uint32_t baud);
+
+/**
+ * @brief Change débit et contrôle de flux d'un UART en fonctionnement :
+ *        attend la fin d'émission (uart_tx.h), arrête la réception DMA
+ *        (octets déjà reçus remis au traitement), reconfigure l'UART puis
+ *        relance la réception (uart_rx.h).
+ *
+ * @param hw_flow  UART_HWCONTROL_NONE ou UART_HWCONTROL_RTS_CTS
+ *                 (USART1 uniquement : CTS = PA11, RTS = PA12)
+ * @return HAL_ERROR si débit hors tolérance ou contrôle de flux indisponible.
+ */
+HAL_StatusTypeDef UartBaud_Set(UART_HandleTypeDef *huart, uint32_t baud, uint32_t hw_flow);
+
+#endif /* UART_BAUD_H_ */
@@ -0,0 +1,168 @@
+/*
+ * uart_rx.c
+ *
+ *  Created on: Jan 27, 2026
+ *      Author: penel
+ */
+
+#include "uart_rx.h"
+
+/* Port de réception : le DMA écrit en boucle dans buf, on remet au
+ * traitement la zone [last, pos) à chaque événement.
+ */
+typedef struct
+{
+    UART_HandleTypeDef *huart;
+    uart_rx_handler_t handler;
+    uint8_t  buf[UART_RX_BUF_SIZE];
+    uint16_t last;
+    uart_rx_stats_t stats;
+} uart_rx_port_t;
+
+static uart_rx_port_t s_ports[UART_RX_MAX_PORTS];
+
+/* --------------------------------------------------------------------------
+ * Fonctions internes
+ * -------------------------------------------------------------------------- */
+
+static uart_rx_port_t *rx_find(const UART_HandleTypeDef *huart)
+{
+    uint32_t i;
+
+    for (i = 0; i < UART_RX_MAX_PORTS; i++)
+    {
+        if (huart != NULL && s_ports[i].huart == huart)
+            return &s_ports[i];
+    }
+    return NULL;
+}
+
+/* Bloc vide transmis seulement pour signaler la ligne au repos */
+static void rx_deliver(uart_rx_port_t *p, uint16_t from, uint16_t to, uint8_t idle)
+{
+    if (to > from || idle)
+    {
+        p->handler(&p->buf[from], (uint16_t)(to - from), idle);
+        p->stats.bytes += (uint32_t)(to - from);
+    }
+}
+
+static void rx_event(uart_rx_port_t *p, uint16_t pos, uint8_t idle)
+{
+    p->stats.events++;
+
+    if (pos >= p->last)
+    {
+        rx_deliver(p, p->last, pos, idle);
+    }
+    else
+    {
+        /* Evénement de fin de buffer manqué : le DMA a déjà rebouclé */
+        rx_deliver(p, p->last, UART_RX_BUF_SIZE, 0);
+        rx_deliver(p, 0, pos, idle);
+    }
+
+    p->last = (pos == UART_RX_BUF_SIZE) ? 0u : pos;
+}
+
+static HAL_StatusTypeDef rx_arm(uart_rx_port_t *p)
+{
+    p->last = 0;
+    return HAL_UARTEx_ReceiveToIdle_DMA(p->huart, p->buf, UART_RX_BUF_SIZE);
+}
+
+/* --------------------------------------------------------------------------
+ * API
+ * -------------------------------------------------------------------------- */
+
+HAL_StatusTypeDef UartRx_Start(UART_HandleTypeDef *huart, uart_rx_handler_t handler)
+{
+    uart_rx_port_t *p = rx_find(huart);
+    uint32_t i;
+
+    if (huart == NULL || handler == NULL)
+        return HAL_ERROR;
+
+    for (i = 0; i < UART_RX_MAX_PORTS && p == NULL; i++)
+    {
+        if (s_ports[i].huart == NULL)
+            p = &s_ports[i];
+    }
+    if (p == NULL)
+        return HAL_ERROR;
+
+    p->huart   = huart;
+    p->handler = handler;
+    p->stats.bytes  = 0;
+    p->stats.events = 0;
+    p->stats.errors = 0;
+
+    return rx_arm(p);
+}
+
+void UartRx_OnEvent(UART_HandleTypeDef *huart, uint16_t pos)
+{
+    uart_rx_port_t *p = rx_find(huart);
+    uint8_t idle;
+
+    if (p == NULL || pos > UART_RX_BUF_SIZE)
+        return;
+
+    idle = (HAL_UARTEx_GetRxEventType(huart) == HAL_UART_RXEVENT_IDLE);
+
+    /* IDLE juste après la fin de buffer : le HAL donne Size = taille du
+     * buffer, le DMA est en fait revenu en 0
+     */
+    if (pos == UART_RX_BUF_SIZE && idle)
+        pos = 0;
+
+    rx_event(p, pos, idle);
+}
+
+void UartRx_OnError(UART_HandleTypeDef *huart)
+{
+    uart_rx_port_t *p = rx_find(huart);
+
+    /* Erreur côté émission uniquement : la réception continue */
+    if (p == NULL || huart->RxState != HAL_UART_STATE_READY)
+        return;
+
+    p->stats.errors++;
+
+    /* Octets déjà écrits par le DMA avant l'arrêt ; l'erreur termine le bloc */
+    rx_event(p, (uint16_t)(UART_RX_BUF_SIZE - __HAL_DMA_GET_COUNTER(huart->hdmarx)), 1);
+
+    (void)rx_arm(p);
+}
+
+void UartRx_Stop(UART_HandleTypeDef *huart)
+{
+    uart_rx_port_t *p = rx_find(huart);
+
+    if (p == NULL)
+        return;
+
+    (void)HAL_UART_AbortReceive(huart);
+    rx_event(p, (uint16_t)(UART_RX_BUF_SIZE - __HAL_DMA_GET_COUNTER(huart->hdmarx)), 1);
+}
+
+HAL_StatusTypeDef UartRx_Resume(UART_HandleTypeDef *huart)
+{
+    uart_rx_port_t *p = rx_find(huart);
+
+    if (p == NULL)
+        return HAL_ERROR;
+
+    return rx_arm(p);
+}
+
+HAL_StatusTypeDef UartRx_GetStats(UART_HandleTypeDef *huart, uart_rx_stats_t *st)
+{
+    uart_rx_port_t *p = rx_find(huart);
+
+    if (p == NULL || st == NULL)
+        return HAL_ERROR;
+
+    *st = p->stats;
+    return HAL_OK;
+}
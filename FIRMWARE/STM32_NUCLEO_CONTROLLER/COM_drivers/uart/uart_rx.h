@@ -0,0 +1,74 @@
+/*
+ * uart_rx.h
+ *
+ *  Created on: Jan 27, 2026
+ *      Author: penel
+ */
+
+#ifndef UART_RX_H_
+#define UART_RX_H_
+
+#include "main.h"
+#include <stdint.h>
+
+/* Buffer DMA circulaire de réception, par UART.
+ * Un événement (moitié, fin de buffer ou ligne IDLE) arrive au plus tous
+ * les UART_RX_BUF_SIZE / 2 octets : 11 ms à 115200 bauds.
+ */
+#define UART_RX_BUF_SIZE   256u
+
+/* Nombre d'UART gérés */
+#define UART_RX_MAX_PORTS  1u
+
+/**
+ * @brief Traitement des octets reçus, appelé en interruption avec des
+ *        blocs contigus, dans l'ordre d'arrivée.
+ *
+ * @param idle  1 : dernier bloc avant la ligne au repos (IDLE, ou
+ *              réception arrêtée sur erreur / UartRx_Stop), éventuellement
+ *              vide ; 0 : bloc coupé par le DMA (moitié / fin de buffer),
+ *              la suite peut arriver
+ */
+typedef void (*uart_rx_handler_t)(const uint8_t *data, uint16_t len, uint8_t idle);
+
+/* Compteurs d'un port */
+typedef struct
+{
+    uint32_t bytes;     /* octets remis au traitement */
+    uint32_t events;    /* événements DMA / IDLE */
+    uint32_t errors;    /* erreurs UART (ORE, FE, NE...) -> réception relancée */
+} uart_rx_stats_t;
+
+/**
+ * @brief Lance la réception DMA circulaire avec détection de ligne IDLE
+ *        (hdmarx en mode DMA_CIRCULAR lié dans HAL_UART_MspInit).
+ */
+HAL_StatusTypeDef UartRx_Start(UART_HandleTypeDef *huart, uart_rx_handler_t handler);
+
+/**
+ * @brief À appeler depuis HAL_UARTEx_RxEventCallback().
+ *
+ * @param pos  Position d'écriture du DMA dans le buffer (paramètre Size du HAL).
+ */
+void UartRx_OnEvent(UART_HandleTypeDef *huart, uint16_t pos);
+
+/**
+ * @brief À appeler depuis HAL_UART_ErrorCallback() : le HAL a arrêté le
+ *        DMA de réception, on la relance.
+ */
+void UartRx_OnError(UART_HandleTypeDef *huart);
+
+/**
+ * @brief Arrête la réception (ex: avant un changement de débit) ; les
+ *        octets déjà écrits par le DMA sont remis au traitement.
+ */
+void UartRx_Stop(UART_HandleTypeDef *huart);
+
+/**
+ * @brief Relance la réception après UartRx_Stop(), compteurs conservés.
+ */
+HAL_StatusTypeDef UartRx_Resume(UART_HandleTypeDef *huart);
+
+HAL_StatusTypeDef UartRx_GetStats(UART_HandleTypeDef *huart, uart_rx_stats_t *st);
+
+#endif /* UART_RX_H_ */
@@ -0,0 +1,251 @@
+/*
+ * uart_tx.c
+ *
+ *  Created on: Jan 26, 2026
+ *      Author: penel
+ */
+
+#include "uart_tx.h"
+
+/* Port d'émission : buffer circulaire vidé par DMA.
+ *
+ *  [tail, tail + dma_len) : bloc en cours d'émission par le DMA
+ *  [tail + dma_len, head) : en attente
+ *
+ * head n'est avancé que par les producteurs, tail / dma_len que par
+ * la fin de DMA ; les deux côtés passent en section critique.
+ */
+typedef struct
+{
+    UART_HandleTypeDef *huart;
+    uint8_t  buf[UART_TX_BUF_SIZE];
+    volatile uint16_t head;
+    volatile uint16_t tail;
+    volatile uint16_t dma_len;
+    uint16_t high_water;
+    uint32_t overflows;
+    GPIO_TypeDef *de_port;              /* RS-485, NULL si absent */
+    uint16_t      de_pin;
+} uart_tx_port_t;
+
+static uart_tx_port_t s_ports[UART_TX_MAX_PORTS];
+
+/* --------------------------------------------------------------------------
+ * Fonctions internes
+ * -------------------------------------------------------------------------- */
+
+static uart_tx_port_t *tx_find(const UART_HandleTypeDef *huart)
+{
+    uint32_t i;
+
+    for (i = 0; i < UART_TX_MAX_PORTS; i++)
+    {
+        if (huart != NULL && s_ports[i].huart == huart)
+            return &s_ports[i];
+    }
+    return NULL;
+}
+
+static uint16_t tx_used(const uart_tx_port_t *p)
+{
+    return (uint16_t)((p->head + UART_TX_BUF_SIZE - p->tail) % UART_TX_BUF_SIZE);
+}
+
+/* Copie en tête de buffer (place déjà vérifiée, section critique) */
+static void tx_copy(uart_tx_port_t *p, const uint8_t *data, uint16_t len)
+{
+    uint16_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        p->buf[p->head] = data[i];
+        p->head = (uint16_t)((p->head + 1u) % UART_TX_BUF_SIZE);
+    }
+}
+
+/**
+ * @brief Lance le DMA sur le plus grand bloc contigu en attente.
+ *        Appelée en section critique.
+ */
+static void tx_kick(uart_tx_port_t *p)
+{
+    uint16_t n;
+
+    /* Transfert interrompu par une erreur UART : le HAL est revenu à READY
+     * sans appeler TxCplt, on considère le bloc comme perdu.
+     */
+    if (p->dma_len != 0u && p->huart->gState == HAL_UART_STATE_READY)
+    {
+        p->tail    = (uint16_t)((p->tail + p->dma_len) % UART_TX_BUF_SIZE);
+        p->dma_len = 0;
+    }
+
+    if (p->dma_len != 0u)
+        return;
+
+    /* Plus rien à émettre : appelé depuis TxCplt (TC), ligne libérée */
+    if (p->head == p->tail)
+    {
+        if (p->de_port != NULL)
+            p->de_port->BSRR = (uint32_t)p->de_pin << 16;
+        return;
+    }
+
+    if (p->de_port != NULL)
+        p->de_port->BSRR = p->de_pin;
+
+    /* Bloc contigu : jusqu'à head, ou jusqu'à la fin du buffer */
+    n = (p->head > p->tail) ? (uint16_t)(p->head - p->tail)
+                            : (uint16_t)(UART_TX_BUF_SIZE - p->tail);
+
+    if (HAL_UART_Transmit_DMA(p->huart, &p->buf[p->tail], n) == HAL_OK)
+        p->dma_len = n;
+}
+
+/* --------------------------------------------------------------------------
+ * API
+ * -------------------------------------------------------------------------- */
+
+HAL_StatusTypeDef UartTx_Init(UART_HandleTypeDef *huart)
+{
+    uart_tx_port_t *p = tx_find(huart);
+    uint32_t i;
+
+    if (huart == NULL)
+        return HAL_ERROR;
+
+    /* Nouveau port : première case libre */
+    for (i = 0; i < UART_TX_MAX_PORTS && p == NULL; i++)
+    {
+        if (s_ports[i].huart == NULL)
+            p = &s_ports[i];
+    }
+    if (p == NULL)
+        return HAL_ERROR;
+
+    p->head       = 0;
+    p->tail       = 0;
+    p->dma_len    = 0;
+    p->high_water = 0;
+    p->overflows  = 0;
+    p->de_port    = NULL;
+    p->de_pin     = 0;
+    p->huart      = huart;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef UartTx_SetDriverEnable(UART_HandleTypeDef *huart,
+                                         GPIO_TypeDef *port, uint16_t pin)
+{
+    uart_tx_port_t *p = tx_find(huart);
+    uint32_t primask;
+
+    if (p == NULL)
+        return HAL_ERROR;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    p->de_port = port;
+    p->de_pin  = pin;
+    __set_PRIMASK(primask);
+    return HAL_OK;
+}
+
+uint16_t UartTx_Write(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t len)
+{
+    return UartTx_Write2(huart, data, len, NULL, 0);
+}
+
+uint16_t UartTx_Write2(UART_HandleTypeDef *huart,
+                       const uint8_t *data1, uint16_t len1,
+                       const uint8_t *data2, uint16_t len2)
+{
+    uart_tx_port_t *p = tx_find(huart);
+    uint32_t primask;
+    uint16_t used;
+
+    if (data2 == NULL)
+        len2 = 0;
+    if (p == NULL || data1 == NULL || (uint32_t)len1 + len2 == 0u)
+        return 0;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    used = tx_used(p);
+
+    /* Une case reste toujours vide pour distinguer plein / vide */
+    if ((uint32_t)used + len1 + len2 > UART_TX_BUF_SIZE - 1u)
+    {
+        p->overflows++;
+        __set_PRIMASK(primask);
+        return 0;
+    }
+
+    tx_copy(p, data1, len1);
+    tx_copy(p, data2, len2);
+
+    used = (uint16_t)(used + len1 + len2);
+    if (used > p->high_water)
+        p->high_water = used;
+
+    tx_kick(p);
+
+    __set_PRIMASK(primask);
+    return (uint16_t)(len1 + len2);
+}
+
+HAL_StatusTypeDef UartTx_Flush(UART_HandleTypeDef *huart, uint32_t timeout_ms)
+{
+    uart_tx_port_t *p = tx_find(huart);
+    uint32_t start = HAL_GetTick();
+
+    if (p == NULL)
+        return HAL_ERROR;
+
+    while (p->head != p->tail)
+    {
+        if ((HAL_GetTick() - start) >= timeout_ms)
+            return HAL_TIMEOUT;
+    }
+
+    /* Dernier octet sorti du registre à décalage */
+    while (__HAL_UART_GET_FLAG(huart, UART_FLAG_TC) == RESET)
+    {
+        if ((HAL_GetTick() - start) >= timeout_ms)
+            return HAL_TIMEOUT;
+    }
+    return HAL_OK;
+}
+
+void UartTx_OnTxCplt(UART_HandleTypeDef *huart)
+{
+    uart_tx_port_t *p = tx_find(huart);
+    uint32_t primask;
+
+    if (p == NULL)
+        return;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    p->tail    = (uint16_t)((p->tail + p->dma_len) % UART_TX_BUF_SIZE);
+    p->dma_len = 0;
+    tx_kick(p);
+
+    __set_PRIMASK(primask);
+}
+
+HAL_StatusTypeDef UartTx_GetStats(UART_HandleTypeDef *huart, uart_tx_stats_t *st)
+{
+    uart_tx_port_t *p = tx_find(huart);
+
+    if (p == NULL || st == NULL)
+        return HAL_ERROR;
+
+    st->size       = UART_TX_BUF_SIZE - 1u;
+    st->used       = tx_used(p);
+    st->high_water = p->high_water;
+    st->overflows  = p->overflows;
+    return HAL_OK;
+}
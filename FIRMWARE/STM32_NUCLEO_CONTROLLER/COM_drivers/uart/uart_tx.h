@@ -0,0 +1,87 @@
+/*
+ * uart_tx.h
+ *
+ *  Created on: Jan 26, 2026
+ *      Author: penel
+ */
+
+#ifndef UART_TX_H_
+#define UART_TX_H_
+
+#include "main.h"
+#include <stdint.h>
+
+/* Taille du buffer circulaire d'émission, par UART */
+#define UART_TX_BUF_SIZE   1024u
+
+/* Nombre d'UART gérés (USART1 : Raspberry Pi, USART2 : debug) */
+#define UART_TX_MAX_PORTS  2u
+
+/* Compteurs d'un port */
+typedef struct
+{
+    uint16_t size;        /* capacité utile (octets) */
+    uint16_t used;        /* octets en attente (DMA en cours compris) */
+    uint16_t high_water;  /* remplissage maximal observé */
+    uint32_t overflows;   /* messages rejetés faute de place */
+} uart_tx_stats_t;
+
+/**
+ * @brief Associe un buffer d'émission à un UART dont le DMA TX est déjà
+ *        configuré (hdmatx lié dans HAL_UART_MspInit).
+ *
+ * @return HAL_ERROR si plus de port libre.
+ */
+HAL_StatusTypeDef UartTx_Init(UART_HandleTypeDef *huart);
+
+/**
+ * @brief Copie un message dans le buffer et lance le DMA si besoin.
+ *        Ne bloque jamais : si la place manque, le message entier est
+ *        rejeté (compteur overflows) pour ne pas couper une ligne / trame.
+ *        Utilisable depuis une interruption.
+ *
+ * @return nombre d'octets acceptés (len ou 0).
+ */
+uint16_t UartTx_Write(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Comme UartTx_Write, pour un message en deux parties (ex: en-tête
+ *        + corps) : les deux sont acceptées ou rejetées ensemble.
+ *
+ * @return nombre d'octets acceptés (len1 + len2 ou 0).
+ */
+uint16_t UartTx_Write2(UART_HandleTypeDef *huart,
+                       const uint8_t *data1, uint16_t len1,
+                       const uint8_t *data2, uint16_t len2);
+
+/**
+ * @brief Broche DE d'un transceiver RS-485 (DE et /RE reliés) : mise à 1
+ *        au lancement d'une émission, remise à 0 dans l'interruption de
+ *        fin d'émission (TC, dernier bit de stop sorti) quand le buffer
+ *        est vide. La broche doit être configurée en sortie, à 0.
+ *
+ * @return HAL_ERROR si UART non initialisé.
+ */
+HAL_StatusTypeDef UartTx_SetDriverEnable(UART_HandleTypeDef *huart,
+                                         GPIO_TypeDef *port, uint16_t pin);
+
+/**
+ * @brief Attend que tout le buffer soit émis (ex: avant un changement de
+ *        débit ou un reset). Hors interruption uniquement.
+ *
+ * @return HAL_TIMEOUT si le buffer n'est pas vide à l'échéance.
+ */
+HAL_StatusTypeDef UartTx_Flush(UART_HandleTypeDef *huart, uint32_t timeout_ms);
+
+/**
+ * @brief À appeler depuis HAL_UART_TxCpltCallback() : libère le bloc
+ *        émis et enchaîne le suivant.
+ */
+void UartTx_OnTxCplt(UART_HandleTypeDef *huart);
+
+/**
+ * @brief Compteurs d'un port (HAL_ERROR si UART non initialisé).
+ */
+HAL_StatusTypeDef UartTx_GetStats(UART_HandleTypeDef *huart, uart_tx_stats_t *st);
+
+#endif /* UART_TX_H_ */
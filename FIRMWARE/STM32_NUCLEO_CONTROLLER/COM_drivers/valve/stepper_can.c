@@ -6,6 +6,8 @@
  */
 
 #include "stepper_can.h"
+#include "../log/trace.h"
+#include "../time/perf.h"
 
 /* Handle CAN global (fourni par CubeMX) */
 extern CAN_HandleTypeDef hcan1;
@@ -20,6 +22,9 @@ static HAL_StatusTypeDef StepperCAN_SendStd(uint16_t std_id,
 {
     CAN_TxHeaderTypeDef txh;
     uint32_t tx_mailbox;
+    uint32_t d = 0;
+    HAL_StatusTypeDef st;
+    uint8_t i;
 
     txh.StdId = std_id;
     txh.ExtId = 0;
@@ -28,7 +33,16 @@ static HAL_StatusTypeDef StepperCAN_SendStd(uint16_t std_id,
     txh.DLC   = dlc;
     txh.TransmitGlobalTime = DISABLE;
 
-    return HAL_CAN_AddTxMessage(&hcan1, &txh, (uint8_t*)data, &tx_mailbox);
+    PERF_BEGIN(PERF_CAN);
+    st = HAL_CAN_AddTxMessage(&hcan1, &txh, (uint8_t*)data, &tx_mailbox);
+    PERF_END(PERF_CAN);
+
+    /* 4 premiers octets de données (les trames du moteur en ont au plus 3) */
+    for (i = 0; i < dlc && i < 4u; i++)
+        d |= (uint32_t)data[i] << (24u - 8u * i);
+    TRACE4("CAN tx id=0x%03X dlc=%u d=%08X st=%u", std_id, dlc, d, st);
+
+    return st;
 }
 
 /* ------------------- API ------------------- */
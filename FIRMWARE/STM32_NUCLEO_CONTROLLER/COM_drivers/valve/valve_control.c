@@ -7,25 +7,35 @@
 
 #include "valve_control.h"
 #include "stepper_can.h"
-
-/* Reference temperature: 25.00 °C (in centi-degrees) */
-#define T_REF_CENTI      2500
+#include "../sensors/imu_capture.h"
+#include "../log/trace.h"
 
 /* Mechanical saturation of the valve */
 #define ANGLE_LIMIT_DEG  90   /* range: [-90 ; +90] */
 
 static int32_t s_last_angle = 999; /* valeur impossible pour forcer 1er envoi */
 static int32_t s_last_cmd = 9999;
+static int32_t s_ref_centi = VALVE_T_REF_CENTI;
 
 void ValveControl_Init(void)
 {
     s_last_angle = 999; /* force 1ère commande */
 }
 
+void ValveControl_SetRef(int32_t ref_centi)
+{
+    s_ref_centi = ref_centi;
+}
+
+int32_t ValveControl_GetRef(void)
+{
+    return s_ref_centi;
+}
+
 void ValveControl_Update(int32_t temp_centi, int32_t k_centi)
 {
     /* Temperature error relative to reference (in 0.01 °C) */
-    int32_t err_centi = temp_centi - T_REF_CENTI;
+    int32_t err_centi = temp_centi - s_ref_centi;
 
     /* Proportional control law (integer arithmetic only):
      *
@@ -48,6 +58,7 @@ void ValveControl_Update(int32_t temp_centi, int32_t k_centi)
         return;
 
     s_last_cmd = angle_deg;
+    TRACE3("vanne T=%d K=%d angle=%d", temp_centi, k_centi, angle_deg);
 
     /* Send command to the stepper motor */
     if (angle_deg < 0)
@@ -60,4 +71,7 @@ void ValveControl_Update(int32_t temp_centi, int32_t k_centi)
         /* Positive or zero angle */
         StepperCAN_SetAngle((uint8_t)(angle_deg), STEPPER_SIGN_POS);
     }
+
+    /* The valve is about to move: freeze the IMU response if a capture is armed */
+    ImuCapture_Trigger(IMU_CAPTURE_TRIG_VALVE);
 }
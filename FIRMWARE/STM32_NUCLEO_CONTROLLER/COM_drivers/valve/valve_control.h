@@ -11,16 +11,29 @@
 #include "main.h"
 #include <stdint.h>
 
+/* Default reference temperature: 25.00 °C (in centi-degrees),
+ * replaced at boot by the stored setpoint (PARAM_CTRL_REF)
+ */
+#define VALVE_T_REF_CENTI  2500
+
 /**
  * @brief Initialise le contrôleur de vanne (position initiale, etc.).
  */
 void ValveControl_Init(void);
 
+/**
+ * @brief Consigne de température (0.01 °C) de la régulation. La même
+ *        valeur est donnée à SensorsApp_SetControlRef() : la cadence
+ *        d'acquisition suit l'erreur réellement régulée.
+ */
+void ValveControl_SetRef(int32_t ref_centi);
+int32_t ValveControl_GetRef(void);
+
 /**
  * @brief Calcule l’angle cible (0..90°) à partir de T et K, puis pilote le moteur.
  *
  * @param temp_centi  Température en 0.01°C (ex: 2500 = 25.00°C)
- * @param k_centi     K en 0.01°C (ex: 100 = 1.00°C) => bande [25-K, 25+K]
+ * @param k_centi     K en 0.01°C (ex: 100 = 1.00°C) => bande [ref-K, ref+K]
  */
 void ValveControl_Update(int32_t temp_centi, int32_t k_centi);
 
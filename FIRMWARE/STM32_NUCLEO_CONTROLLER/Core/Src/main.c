@@ -27,6 +27,13 @@
 #include "rpi_protocol.h"
 #include "stepper_can.h"
 #include "valve_control.h"
+#include "imu_capture.h"
+#include "uart_tx.h"
+#include "uart_rx.h"
+#include "param.h"
+#include "timebase.h"
+#include "perf.h"
+#include "log.h"
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
@@ -40,6 +47,12 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+/* Période de la boucle principale (ms).
+ * L'acquisition BMP280 a sa propre cadence (sample_rate.h) ; la boucle doit
+ * tourner assez vite pour vider la FIFO du MPU9250 pendant une capture
+ * (512 octets = ~42 ms à 1 kHz).
+ */
+#define MAIN_LOOP_PERIOD_MS  10u
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -54,15 +67,18 @@ I2C_HandleTypeDef hi2c1;
 
 UART_HandleTypeDef huart1;
 UART_HandleTypeDef huart2;
+DMA_HandleTypeDef hdma_usart1_rx;
+DMA_HandleTypeDef hdma_usart1_tx;
+DMA_HandleTypeDef hdma_usart2_tx;
 
 /* USER CODE BEGIN PV */
-static uint8_t uart1_rx_byte;
 
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
+static void MX_DMA_Init(void);
 static void MX_USART2_UART_Init(void);
 static void MX_CAN1_Init(void);
 static void MX_I2C1_Init(void);
@@ -105,20 +121,38 @@ int main(void)
 
 	/* Initialize all configured peripherals */
 	MX_GPIO_Init();
+	MX_DMA_Init();
 	MX_USART2_UART_Init();
 	MX_CAN1_Init();
 	MX_I2C1_Init();
 	MX_USART1_UART_Init();
 	/* USER CODE BEGIN 2 */
 
+	/* Emission UART par DMA (console et protocole) : avant toute trace */
+	(void)UartTx_Init(&huart2);
+	(void)UartTx_Init(&huart1);
+	(void)Log_Init(&huart2);
+
+	/* Base de temps µs des horodatages (TIM2, traces comprises) */
+	if (Timebase_Init() != HAL_OK)
+		LOG_E(LOG_MOD_MAIN, "Erreur base de temps TIM2");
+
+	/* Réglages enregistrés en flash (K, consigne, adresses) */
+	(void)Param_Init();
+
+	/* Profilage en cycles (DWT) : boucle, pilotes, interruptions */
+	Perf_Init();
+
 	/* Capteurs */
 	(void)SensorsApp_Init(&hi2c1);
+	SensorsApp_SetControlRef((int32_t)Param_Get(PARAM_CTRL_REF));
+	ValveControl_SetRef((int32_t)Param_Get(PARAM_CTRL_REF));
 
-	printf("\r\n=== Init CAN (500 kbit/s) ===\r\n");
+	LOG_I(LOG_MOD_CAN, "=== Init CAN (500 kbit/s) ===");
 
 	if (StepperCAN_Init(&hcan1) != HAL_OK)
 	{
-		printf("Erreur init CAN\r\n");
+		LOG_E(LOG_MOD_CAN, "Erreur init CAN");
 	}
 	else
 	{
@@ -130,7 +164,7 @@ int main(void)
 		StepperCAN_SetZero();
 		HAL_Delay(200);  /* laisse le temps à la carte moteur */
 
-		printf("CAN OK - Position moteur remise à zero\r\n");
+		LOG_I(LOG_MOD_CAN, "CAN OK - Position moteur remise à zero");
 	}
 
 	/* Protocole Raspberry (UART1) */
@@ -145,14 +179,27 @@ int main(void)
 	while (1)
 	{
 		const sensors_state_t *st = SensorsApp_GetState();
+		PERF_BEGIN(PERF_LOOP);
 
+		PERF_BEGIN(PERF_SENSORS);
 		SensorsApp_Update();
+		PERF_END(PERF_SENSORS);
+
+		PERF_BEGIN(PERF_IMUCAP);
+		ImuCapture_Task();
+		PERF_END(PERF_IMUCAP);
+
+		PERF_BEGIN(PERF_RPI);
 		RpiProto_Task();
+		PERF_END(PERF_RPI);
 
 		/* Contrôle vanne selon T et K */
+		PERF_BEGIN(PERF_VALVE);
 		ValveControl_Update(st->temp_centi, RpiProto_GetK_centi());
+		PERF_END(PERF_VALVE);
 
-		HAL_Delay(50);
+		PERF_END(PERF_LOOP);
+		HAL_Delay(MAIN_LOOP_PERIOD_MS);
 
 		/* USER CODE END WHILE */
 
@@ -261,7 +308,7 @@ static void MX_I2C1_Init(void)
 
 	/* USER CODE END I2C1_Init 1 */
 	hi2c1.Instance = I2C1;
-	hi2c1.Init.ClockSpeed = 100000;
+	hi2c1.Init.ClockSpeed = 400000;
 	hi2c1.Init.DutyCycle = I2C_DUTYCYCLE_2;
 	hi2c1.Init.OwnAddress1 = 0;
 	hi2c1.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
@@ -345,6 +392,29 @@ static void MX_USART2_UART_Init(void)
 
 }
 
+/**
+ * Enable DMA controller clock
+ */
+static void MX_DMA_Init(void)
+{
+
+	/* DMA controller clock enable */
+	__HAL_RCC_DMA1_CLK_ENABLE();
+	__HAL_RCC_DMA2_CLK_ENABLE();
+
+	/* DMA interrupt init */
+	/* DMA1_Stream6_IRQn interrupt configuration */
+	HAL_NVIC_SetPriority(DMA1_Stream6_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(DMA1_Stream6_IRQn);
+	/* DMA2_Stream2_IRQn interrupt configuration */
+	HAL_NVIC_SetPriority(DMA2_Stream2_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(DMA2_Stream2_IRQn);
+	/* DMA2_Stream7_IRQn interrupt configuration */
+	HAL_NVIC_SetPriority(DMA2_Stream7_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(DMA2_Stream7_IRQn);
+
+}
+
 /**
  * @brief GPIO Initialization Function
  * @param None
@@ -385,13 +455,22 @@ static void MX_GPIO_Init(void)
 }
 
 /* USER CODE BEGIN 4 */
-void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
 {
-	if (huart->Instance == USART1)
-	{
-		RpiProto_OnRxByte(uart1_rx_byte);
-		HAL_UART_Receive_IT(&huart1, &uart1_rx_byte, 1);
-	}
+	/* Réception DMA circulaire : moitié, fin de buffer ou ligne IDLE */
+	UartRx_OnEvent(huart, Size);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+	/* ORE / FE / NE : le HAL a arrêté le DMA de réception */
+	UartRx_OnError(huart);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+	/* Fin d'un bloc DMA : enchaîne le suivant du buffer d'émission */
+	UartTx_OnTxCplt(huart);
 }
 
 /* USER CODE END 4 */
@@ -0,0 +1,1020 @@
+/*
+ * host_harness.c
+ *
+ *  Created on: Feb 8, 2026
+ *      Author: penel
+ */
+
+/*
+ * Banc du protocole Raspberry Pi sur Linux (voir host_port.h).
+ *
+ *   host_harness [-n <commandes>] [-f <entrées fuzz>] [-s <graine>]
+ *                [-r <flux enregistré>]... [-v]
+ *   host_harness -p <descripteur>
+ *
+ * Scénarios, résultats sur stdout en "<scénario>.<mesure>=<valeur>" :
+ *  - throughput : commandes ASCII, binaires et Modbus générées, puis flux
+ *    enregistrés (-r : octets bruts envoyés par le Pi, voir streams/)
+ *    -> commandes/s ; dispatch : file de commandes pleine à chaque tour,
+ *    coût de Proto_FindCommand / Proto_DispatchCommand et des réponses
+ *  - latency    : rafales de N commandes étiquetées dans un seul bloc DMA
+ *    -> tours de boucle (1 ms) avant que chaque réponse soit sortie sur la
+ *    ligne, commandes perdues
+ *  - overflow   : réponses plus rapides que la ligne (115200 bauds),
+ *    lignes trop longues -> rejets comptés, jamais de ligne tronquée
+ *  - modbus     : requêtes RTU de 13 octets à 9600 bauds, octet par octet
+ *    au rythme de la ligne, fin de trame par TIM7 seul -> chaque position
+ *    dans le buffer DMA, y compris à cheval sur la moitié ou la fin,
+ *    répondue (split_lost=0)
+ *  - fuzz       : octets aléatoires et commandes mutées dans les trois
+ *    modes -> sortie ASCII toujours en lignes complètes, puis le
+ *    protocole doit encore répondre (alive=1)
+ *  - rx         : uart_rx.c derrière le DMA circulaire simulé, blocs de
+ *    taille aléatoire, événements moitié / fin de buffer / IDLE manqués,
+ *    ORE au milieu des commandes -> octets remis au traitement
+ *    inchangés (bytes_lost=0), chaque commande TIME=<n> répondue avec
+ *    son n (cmds_lost=0)
+ *
+ * -p : pas de scénario, le protocole sert le côté maître d'un
+ * pseudo-terminal (descripteur hérité, python/modbus_pty_test.py) en temps
+ * réel ; 2 ms sans octet reçu = fin de trame Modbus (TIM7). Fin quand
+ * l'autre côté est fermé.
+ */
+
+#include "host_port.h"
+#include "rpi_protocol.h"
+#include "rpi_frame.h"
+#include "rpi_cmdq.h"
+#include "rpi_modbus.h"
+#include "param.h"
+#include "sensors_app.h"
+#include "uart_tx.h"
+#include "uart_rx.h"
+#include "log.h"
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Tour de boucle principale simulé et débit de la ligne vers le Pi */
+#define HH_LOOP_US          1000u
+#define HH_LINE_BITS        10u         /* start + 8 bits + stop */
+
+#define HH_LATENCY_MAX_LOOPS 50u
+#define HH_MAX_STREAMS      8
+
+/* Silence de fin de trame en service sur pseudo-terminal (t3.5 = 1750 µs) */
+#define HH_PTY_SILENCE_MS   2
+
+static uint64_t s_rng = 0x2545F4914F6CDD1DULL;
+
+static uint32_t hh_rand(void)
+{
+    /* xorshift64* */
+    s_rng ^= s_rng >> 12;
+    s_rng ^= s_rng << 25;
+    s_rng ^= s_rng >> 27;
+    return (uint32_t)((s_rng * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static double hh_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void hh_metric(const char *scenario, const char *name, double v)
+{
+    fprintf(stdout, "%s.%s=%.10g\n", scenario, name, v);
+}
+
+/* Démarrage comme main.c : paramètres, protocole, un premier échantillon */
+static void hh_boot(uint16_t tx_size)
+{
+    uint8_t sink[256];
+
+    Host_Reset(tx_size);
+    (void)Log_Init(&huart2);
+    (void)Param_Init();
+    RpiProto_Init(&huart1, SensorsApp_GetState());
+    Host_PublishSample(2345, 101325, 12500);
+    while (Host_TxRead(sink, sizeof(sink)) > 0u)
+        ;
+}
+
+static void hh_send_str(const char *s)
+{
+    Host_Rx((const uint8_t *)s, strlen(s));
+}
+
+/* Un tour de boucle : traitement, temps écoulé, ligne vidée au débit courant */
+static void hh_loop(uint8_t line_limited)
+{
+    RpiProto_Task();
+    Host_AdvanceUs(HH_LOOP_US);
+    if (line_limited)
+        Host_TxDrain(huart1.Init.BaudRate / HH_LINE_BITS * HH_LOOP_US / 1000000u);
+    else
+        Host_TxDrain(UINT32_MAX);
+}
+
+/* Lignes ASCII reçues par le Pi : découpage sur '\n', ligne incomplète gardée */
+typedef struct
+{
+    char     buf[4096];
+    size_t   len;
+    uint32_t lines;
+    uint32_t bad;           /* octet non imprimable ou ligne sans '\r' final */
+} hh_lines_t;
+
+static void hh_lines_feed(hh_lines_t *l, void (*on_line)(const char *line, void *ctx), void *ctx)
+{
+    uint8_t rx[512];
+    size_t n, i;
+
+    while ((n = Host_TxRead(rx, sizeof(rx))) > 0u)
+    {
+        for (i = 0; i < n; i++)
+        {
+            uint8_t c = rx[i];
+
+            if (c == '\n')
+            {
+                if (l->len == 0u || l->buf[l->len - 1u] != '\r')
+                    l->bad++;
+                else
+                    l->len--;
+                l->buf[l->len] = '\0';
+                l->lines++;
+                if (on_line != NULL)
+                    on_line(l->buf, ctx);
+                l->len = 0;
+                continue;
+            }
+            if ((c < 0x20u || c > 0x7Eu) && c != '\r')
+                l->bad++;
+            if (l->len < sizeof(l->buf) - 1u)
+                l->buf[l->len++] = (char)c;
+            else
+                l->bad++;
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Débit
+ * -------------------------------------------------------------------------- */
+
+static const char *const s_ascii_mix[] =
+{
+    "GET_T\r\n", "GET_P\r\n", "GET_A\r\n", "GET_K\r\n", "GET_ALL\r\n",
+    "GET_ALL=TP\r\n", "SET_K=1234\r\n", "GET_R\r\n", "GET_I2C\r\n",
+    "GET_TX\r\n", "GET_Q\r\n", "GET_F=T\r\n", "PAR_GET=K\r\n",
+    "TIME=1700000000000000\r\n", "#17:GET_T\r\n", "#65535:GET_ALL\r\n",
+    "BAD_CMD\r\n", "GET_T=1\r\n",
+};
+#define HH_ASCII_MIX_N  (sizeof(s_ascii_mix) / sizeof(s_ascii_mix[0]))
+
+static double hh_rate(uint32_t n, double t0)
+{
+    double dt = hh_seconds() - t0;
+
+    return (dt > 0.0) ? (double)n / dt : 0.0;
+}
+
+static void hh_throughput_ascii(uint32_t n)
+{
+    hh_lines_t l = {0};
+    uint32_t i;
+    double t0;
+
+    hh_boot(UART_TX_BUF_SIZE);
+    t0 = hh_seconds();
+    for (i = 0; i < n; i++)
+    {
+        hh_send_str(s_ascii_mix[i % HH_ASCII_MIX_N]);
+        hh_loop(0);
+        hh_lines_feed(&l, NULL, NULL);
+    }
+    hh_metric("throughput", "ascii_cmds_per_s", hh_rate(n, t0));
+    hh_metric("throughput", "ascii_replies", l.lines);
+    hh_metric("throughput", "ascii_bad_lines", l.bad);
+}
+
+/* Même mélange que bench_protocol.py : début, milieu et fin de table */
+static const char *const s_dispatch_mix[RPI_CMDQ_DEPTH] =
+{
+    "GET_T\r\n", "GET_P\r\n", "GET_K\r\n", "GET_R\r\n", "GET_Q\r\n",
+    "GET_F=T\r\n", "CAP_STAT\r\n", "HELP=GET_T\r\n",
+};
+
+static void hh_dispatch_line(const char *line, void *ctx)
+{
+    uint32_t *ok = ctx;
+
+    if (strncmp(line, "ERR=", 4) != 0)
+        (*ok)++;
+}
+
+/* Dispatcher seul : une file pleine par bloc DMA, ligne sans limite de débit */
+static void hh_throughput_dispatch(uint32_t n)
+{
+    char batch[RPI_CMDQ_DEPTH * 16u];
+    hh_lines_t l = {0};
+    uint32_t i, ok = 0;
+    size_t len = 0;
+    double t0;
+
+    for (i = 0; i < RPI_CMDQ_DEPTH; i++)
+    {
+        memcpy(&batch[len], s_dispatch_mix[i], strlen(s_dispatch_mix[i]));
+        len += strlen(s_dispatch_mix[i]);
+    }
+
+    hh_boot(UART_TX_BUF_SIZE);
+    n = (n + RPI_CMDQ_DEPTH - 1u) / RPI_CMDQ_DEPTH;
+    t0 = hh_seconds();
+    for (i = 0; i < n; i++)
+    {
+        Host_Rx((const uint8_t *)batch, len);
+        hh_loop(0);
+        hh_lines_feed(&l, hh_dispatch_line, &ok);
+    }
+    hh_metric("throughput", "dispatch_cmds_per_s", hh_rate(n * RPI_CMDQ_DEPTH, t0));
+    hh_metric("throughput", "dispatch_lost", (double)(n * RPI_CMDQ_DEPTH - ok));
+}
+
+static void hh_throughput_bin(uint32_t n)
+{
+    uint8_t frames[6][RPI_FRAME_ENC_MAX];
+    size_t  flen[6];
+    uint8_t k[4] = { 0xD2, 0x04, 0, 0 };
+    uint8_t t1[8] = { 0 };
+    uint8_t mask = 0x0F;
+    uint8_t rx[512];
+    uint32_t i, replies = 0;
+    size_t r, j;
+    double t0;
+
+    hh_boot(UART_TX_BUF_SIZE);
+    hh_send_str("MODE=BIN\r\n");
+    hh_loop(0);
+    while (Host_TxRead(rx, sizeof(rx)) > 0u)
+        ;
+
+    flen[0] = RpiFrame_Encode(RPI_BIN_CMD_GET_T, NULL, 0, frames[0]);
+    flen[1] = RpiFrame_Encode(RPI_BIN_CMD_GET_ALL, NULL, 0, frames[1]);
+    flen[2] = RpiFrame_Encode(RPI_BIN_CMD_GET_ALL, &mask, 1, frames[2]);
+    flen[3] = RpiFrame_Encode(RPI_BIN_CMD_SET_K, k, 4, frames[3]);
+    flen[4] = RpiFrame_Encode(RPI_BIN_CMD_TIME, t1, 8, frames[4]);
+    flen[5] = RpiFrame_Encode(RPI_BIN_CMD_GET_R, NULL, 0, frames[5]);
+
+    t0 = hh_seconds();
+    for (i = 0; i < n; i++)
+    {
+        Host_Rx(frames[i % 6u], flen[i % 6u]);
+        hh_loop(0);
+        while ((r = Host_TxRead(rx, sizeof(rx))) > 0u)
+        {
+            for (j = 0; j < r; j++)
+                replies += (rx[j] == 0u);
+        }
+    }
+    hh_metric("throughput", "bin_cmds_per_s", hh_rate(n, t0));
+    hh_metric("throughput", "bin_replies", replies);
+}
+
+static size_t hh_modbus_adu(uint8_t *out, uint8_t addr, uint8_t fc, uint16_t a, uint16_t b)
+{
+    uint16_t crc;
+
+    out[0] = addr;
+    out[1] = fc;
+    out[2] = (uint8_t)(a >> 8);
+    out[3] = (uint8_t)a;
+    out[4] = (uint8_t)(b >> 8);
+    out[5] = (uint8_t)b;
+    crc = RpiModbus_Crc16(out, 6);
+    out[6] = (uint8_t)crc;
+    out[7] = (uint8_t)(crc >> 8);
+    return 8;
+}
+
+static void hh_throughput_modbus(uint32_t n)
+{
+    uint8_t adu[3][8];
+    uint8_t rx[512];
+    uint8_t addr;
+    uint32_t i, bytes = 0;
+    size_t r;
+    double t0;
+
+    hh_boot(UART_TX_BUF_SIZE);
+    hh_send_str("MODE=MODBUS\r\n");
+    hh_loop(0);
+    while (Host_TxRead(rx, sizeof(rx)) > 0u)
+        ;
+
+    addr = RpiModbus_GetAddress();
+    (void)hh_modbus_adu(adu[0], addr, 0x04, 0, RPI_MB_IR_COUNT);
+    (void)hh_modbus_adu(adu[1], addr, 0x03, 0, RPI_MB_HR_COUNT);
+    (void)hh_modbus_adu(adu[2], addr, 0x06, RPI_MB_HR_K + 1u, 1234);
+
+    t0 = hh_seconds();
+    for (i = 0; i < n; i++)
+    {
+        Host_Rx(adu[i % 3u], 8);
+        Host_ModbusSilence();
+        hh_loop(0);
+        while ((r = Host_TxRead(rx, sizeof(rx))) > 0u)
+            bytes += (uint32_t)r;
+    }
+    hh_metric("throughput", "modbus_cmds_per_s", hh_rate(n, t0));
+    hh_metric("throughput", "modbus_reply_bytes", bytes);
+}
+
+/* Flux enregistré : rejoué par blocs de 64 octets (IDLE), un tour de boucle
+ * par bloc, jusqu'à `n` blocs
+ */
+/* Requêtes coupées par le DMA (moitié / fin de buffer) à 9600 bauds */
+#define HH_MB_SLOW_BAUD     9600u
+#define HH_MB_CHAR_US       ((11u * 1000000u + HH_MB_SLOW_BAUD - 1u) / HH_MB_SLOW_BAUD)
+#define HH_MB_WRITE_LEN     13u     /* 0x10, deux registres ; premier avec la
+                                       * demi-taille du buffer : toutes les coupures */
+
+static void hh_modbus_split(uint32_t n)
+{
+    static const char mode[] = "MODE=MODBUS\r\n";
+    uint8_t adu[HH_MB_WRITE_LEN];
+    uint8_t rx[64];
+    uint8_t addr;
+    uint32_t i, j, pos, split = 0, ok = 0;
+    uint16_t crc;
+    size_t r, got;
+
+    hh_boot(UART_TX_BUF_SIZE);
+    huart1.Init.BaudRate = HH_MB_SLOW_BAUD;
+    hh_send_str(mode);
+    hh_loop(0);
+    while (Host_TxRead(rx, sizeof(rx)) > 0u)
+        ;
+    Host_AdvanceUs(10000u);
+
+    addr = RpiModbus_GetAddress();
+    pos  = sizeof(mode) - 1u;
+    for (i = 0; i < n; i++)
+    {
+        uint32_t k = 100u + i;
+
+        adu[0] = addr;
+        adu[1] = 0x10;
+        adu[2] = 0; adu[3] = RPI_MB_HR_K;
+        adu[4] = 0; adu[5] = 2;
+        adu[6] = 4;
+        adu[7] = (uint8_t)(k >> 24); adu[8]  = (uint8_t)(k >> 16);
+        adu[9] = (uint8_t)(k >> 8);  adu[10] = (uint8_t)k;
+        crc = RpiModbus_Crc16(adu, 11);
+        adu[11] = (uint8_t)crc;
+        adu[12] = (uint8_t)(crc >> 8);
+
+        if ((pos % (UART_RX_BUF_SIZE / 2u)) + HH_MB_WRITE_LEN > UART_RX_BUF_SIZE / 2u)
+            split++;
+        pos += HH_MB_WRITE_LEN;
+
+        /* Octet par octet, écrit par le DMA à la fin de son bit de stop :
+         * moitié / fin de buffer signalées au passage, IDLE un caractère
+         * après le dernier octet
+         */
+        for (j = 0; j < HH_MB_WRITE_LEN; j++)
+        {
+            Host_RxDma(&adu[j], 1, HOST_RX_EV_HT | HOST_RX_EV_TC);
+            Host_AdvanceUs(HH_MB_CHAR_US);
+            RpiProto_Task();
+        }
+        Host_RxIdle();
+
+        /* Silence t3.5, traitement, réponse (écho adresse + quantité) */
+        got = 0;
+        for (j = 0; j < 20u; j++)
+        {
+            Host_AdvanceUs(500u);
+            RpiProto_Task();
+            Host_TxDrain(UINT32_MAX);
+            if ((r = Host_TxRead(&rx[got], sizeof(rx) - got)) > 0u)
+                got += r;
+        }
+        if (got == 8u && rx[0] == addr && rx[1] == 0x10 && memcmp(&rx[2], &adu[2], 4) == 0 &&
+            RpiModbus_Crc16(rx, 6) == (uint16_t)(rx[6] | (rx[7] << 8)) &&
+            RpiProto_GetK_centi() == (int32_t)k)
+            ok++;
+    }
+    hh_metric("modbus", "split_frames", split);
+    hh_metric("modbus", "split_lost", (double)(n - ok));
+}
+
+static void hh_throughput_recorded(const char *path, unsigned idx, uint32_t n)
+{
+    hh_lines_t l = {0};
+    uint8_t sink[256];
+    uint8_t *data;
+    long size;
+    size_t pos = 0, chunk;
+    uint32_t i, blocks = 0;
+    char name[48];
+    double t0;
+    FILE *f = fopen(path, "rb");
+
+    if (f == NULL || fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) <= 0)
+    {
+        fprintf(stderr, "flux illisible : %s\n", path);
+        if (f != NULL)
+            fclose(f);
+        return;
+    }
+    rewind(f);
+    data = malloc((size_t)size);
+    if (data == NULL || fread(data, 1, (size_t)size, f) != (size_t)size)
+    {
+        fclose(f);
+        free(data);
+        return;
+    }
+    fclose(f);
+
+    hh_boot(UART_TX_BUF_SIZE);
+    t0 = hh_seconds();
+    for (i = 0; i < n; i++)
+    {
+        chunk = (size_t)size - pos;
+        if (chunk > 64u)
+            chunk = 64u;
+        Host_Rx(&data[pos], chunk);
+        pos = (pos + chunk) % (size_t)size;
+        blocks++;
+        hh_loop(0);
+        if (RpiProto_GetMode() == RPI_MODE_ASCII)
+            hh_lines_feed(&l, NULL, NULL);
+        else
+            while (Host_TxRead(sink, sizeof(sink)) > 0u)
+                ;
+    }
+
+    snprintf(name, sizeof(name), "rec%u_bytes_per_s", idx);
+    hh_metric("throughput", name, hh_rate(blocks, t0) * 64.0);
+    snprintf(name, sizeof(name), "rec%u_replies", idx);
+    hh_metric("throughput", name, l.lines);
+    free(data);
+}
+
+/* --------------------------------------------------------------------------
+ * Latence
+ * -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    uint32_t loop;
+    uint32_t seen[RPI_CMDQ_DEPTH * 4u];
+} hh_latency_ctx_t;
+
+static void hh_latency_line(const char *line, void *ctx)
+{
+    hh_latency_ctx_t *c = ctx;
+    unsigned long tag;
+    char *end;
+
+    if (line[0] != '#')
+        return;
+    tag = strtoul(&line[1], &end, 10);
+    if (*end == ':' && tag < sizeof(c->seen) / sizeof(c->seen[0]) && c->seen[tag] == 0u)
+        c->seen[tag] = c->loop;
+}
+
+static void hh_latency(void)
+{
+    static const unsigned bursts[] = { 1, 4, RPI_CMDQ_DEPTH, RPI_CMDQ_DEPTH + 4u, RPI_CMDQ_DEPTH * 2u };
+    hh_latency_ctx_t c;
+    hh_lines_t l;
+    char cmd[2048];
+    char name[48];
+    unsigned b, i, len, got, sum, max;
+
+    for (b = 0; b < sizeof(bursts) / sizeof(bursts[0]); b++)
+    {
+        hh_boot(UART_TX_BUF_SIZE);
+        memset(&c, 0, sizeof(c));
+        memset(&l, 0, sizeof(l));
+
+        /* Rafale dans un seul bloc DMA, ligne au débit réel */
+        len = 0;
+        for (i = 0; i < bursts[b]; i++)
+            len += (unsigned)snprintf(&cmd[len], sizeof(cmd) - len, "#%u:GET_ALL\r\n", i);
+        hh_send_str(cmd);
+
+        for (c.loop = 1; c.loop <= HH_LATENCY_MAX_LOOPS; c.loop++)
+        {
+            hh_loop(1);
+            hh_lines_feed(&l, hh_latency_line, &c);
+        }
+
+        got = sum = max = 0;
+        for (i = 0; i < bursts[b]; i++)
+        {
+            if (c.seen[i] == 0u)
+                continue;
+            got++;
+            sum += c.seen[i];
+            if (c.seen[i] > max)
+                max = c.seen[i];
+        }
+        snprintf(name, sizeof(name), "burst%u_mean_loops", bursts[b]);
+        hh_metric("latency", name, got ? (double)sum / got : 0.0);
+        snprintf(name, sizeof(name), "burst%u_max_loops", bursts[b]);
+        hh_metric("latency", name, max);
+        snprintf(name, sizeof(name), "burst%u_lost", bursts[b]);
+        hh_metric("latency", name, bursts[b] - got);
+    }
+}
+
+/* --------------------------------------------------------------------------
+ * Débordements
+ * -------------------------------------------------------------------------- */
+
+static void hh_overflow(void)
+{
+    hh_lines_t l = {0};
+    host_tx_stats_t tx;
+    rpi_cmdq_stats_t q;
+    char longline[RPI_CMDQ_SLOT_LEN * 2u + 3u];
+    uint32_t i, sent = 0;
+
+    hh_boot(UART_TX_BUF_SIZE);
+
+    /* Réponses longues plus vite que 115200 bauds : rejet par message */
+    for (i = 0; i < 200u; i++)
+    {
+        hh_send_str("HELP\r\nGET_S\r\nPAR_LIST\r\n");
+        sent += 3u;
+        hh_loop(1);
+        hh_lines_feed(&l, NULL, NULL);
+    }
+
+    /* Ligne plus longue qu'une case de la file */
+    memset(longline, 'A', sizeof(longline) - 3u);
+    memcpy(&longline[sizeof(longline) - 3u], "\r\n", 3);
+    hh_send_str(longline);
+
+    /* File de commandes pleine : plus de RPI_CMDQ_DEPTH commandes par tour */
+    for (i = 0; i < RPI_CMDQ_DEPTH * 2u; i++)
+        hh_send_str("GET_T\r\n");
+    sent += RPI_CMDQ_DEPTH * 2u;
+
+    for (i = 0; i < 2000u; i++)
+    {
+        hh_loop(1);
+        hh_lines_feed(&l, NULL, NULL);
+    }
+
+    Host_GetTxStats(&tx);
+    RpiCmdQ_GetStats(&q);
+    hh_metric("overflow", "commands", sent);
+    hh_metric("overflow", "replies", l.lines);
+    hh_metric("overflow", "tx_rejected", tx.overflows);
+    hh_metric("overflow", "tx_high_water", tx.high_water);
+    hh_metric("overflow", "cmdq_full", q.overflows);
+    hh_metric("overflow", "cmdq_too_long", q.too_long);
+    hh_metric("overflow", "bad_lines", l.bad);
+}
+
+/* --------------------------------------------------------------------------
+ * Fuzz
+ * -------------------------------------------------------------------------- */
+
+static const char *const s_fuzz_dict[] =
+{
+    "GET_T", "GET_ALL=TPAK", "SET_K=", "SET_F=T,E,3", "SET_W=P,1,500", "CAP_CFG=256,768",
+    "CAP_READ=0,8", "CAP_ARM=CVS", "SUB=TPA,10", "UNSUB", "BAUD=921600", "BAUD_OK",
+    "NODE=3", "NODE=0", "PAR_SET=K,100", "PAR_GET=", "TIME=", "MODE=BIN", "MODE=MODBUS,7",
+    "HELP=", "LOG", "LOG=*,D", "LOG=MPU,", "TRC", "GET_PERF", "GET_PERF=I2C", "PERF_RST",
+    "#", "@3:", "@255:", "#65536:", "\r", "\n", ",", "=",
+};
+#define HH_FUZZ_DICT_N  (sizeof(s_fuzz_dict) / sizeof(s_fuzz_dict[0]))
+
+static size_t hh_fuzz_input(uint8_t *buf, size_t size)
+{
+    size_t len = 0, n, i;
+    uint32_t kind = hh_rand() % 4u;
+
+    if (kind == 0u)
+    {
+        /* Octets aléatoires */
+        n = 1u + hh_rand() % 80u;
+        for (i = 0; i < n && len < size; i++)
+            buf[len++] = (uint8_t)hh_rand();
+        return len;
+    }
+
+    if (kind == 1u && RpiProto_GetMode() == RPI_MODE_BIN)
+    {
+        /* Trame valide, id et payload aléatoires */
+        uint8_t payload[RPI_FRAME_PAYLOAD_MAX];
+
+        n = hh_rand() % (RPI_FRAME_PAYLOAD_MAX + 1u);
+        for (i = 0; i < n; i++)
+            payload[i] = (uint8_t)hh_rand();
+        if (Param_Get(PARAM_NODE) != RPI_NODE_NONE && (hh_rand() & 1u))
+            buf[len++] = (uint8_t)Param_Get(PARAM_NODE);
+        return len + RpiFrame_Encode((uint8_t)(hh_rand() % 0x12u), payload, (uint8_t)n, &buf[len]);
+    }
+
+    if (kind == 2u && RpiProto_GetMode() == RPI_MODE_MODBUS)
+    {
+        /* ADU bien formée, fonction / registres aléatoires */
+        return hh_modbus_adu(buf, (hh_rand() & 1u) ? RpiModbus_GetAddress() : 0u,
+                             (uint8_t)(hh_rand() % 0x12u),
+                             (uint16_t)(hh_rand() % 40u), (uint16_t)(hh_rand() % 40u));
+    }
+
+    /* Mots du protocole assemblés puis mutés */
+    n = 1u + hh_rand() % 4u;
+    for (i = 0; i < n; i++)
+    {
+        const char *w = s_fuzz_dict[hh_rand() % HH_FUZZ_DICT_N];
+        size_t wl = strlen(w);
+
+        if (len + wl + 12u >= size)
+            break;
+        memcpy(&buf[len], w, wl);
+        len += wl;
+        if (hh_rand() & 1u)
+            len += (size_t)snprintf((char *)&buf[len], size - len, "%d", (int)hh_rand());
+    }
+    n = hh_rand() % 3u;
+    for (i = 0; i < n && len > 0u; i++)
+        buf[hh_rand() % len] = (uint8_t)hh_rand();
+    if (len + 2u <= size && (hh_rand() % 8u) != 0u)
+    {
+        buf[len++] = '\r';
+        buf[len++] = '\n';
+    }
+    return len;
+}
+
+/* Retour en ASCII depuis le mode atteint par le fuzz (écriture de
+ * RPI_MB_HR_MODE, ou trame MODE_ASCII précédée de l'adresse du nœud)
+ */
+static void hh_to_ascii(void)
+{
+    uint8_t buf[RPI_FRAME_ENC_MAX + 2u];
+    uint8_t node = (uint8_t)Param_Get(PARAM_NODE);
+    size_t n;
+
+    if (RpiProto_GetMode() == RPI_MODE_MODBUS)
+    {
+        Host_ModbusSilence();           /* termine une trame en cours */
+        n = hh_modbus_adu(buf, RpiModbus_GetAddress(), 0x06, RPI_MB_HR_MODE, RPI_MODE_ASCII);
+        Host_Rx(buf, n);
+        Host_ModbusSilence();
+        hh_loop(0);
+    }
+    if (RpiProto_GetMode() == RPI_MODE_BIN)
+    {
+        buf[0] = 0;                     /* termine une trame en cours */
+        n = 1;
+        if (node != RPI_NODE_NONE)
+            buf[n++] = node;
+        n += RpiFrame_Encode(RPI_BIN_CMD_MODE_ASCII, NULL, 0, &buf[n]);
+        Host_Rx(buf, n);
+        hh_loop(0);
+    }
+}
+
+/* Après le fuzz : GET_T doit encore répondre */
+typedef struct
+{
+    uint8_t ok;
+} hh_alive_ctx_t;
+
+static void hh_alive_line(const char *line, void *ctx)
+{
+    const char *p = line;
+
+    if (p[0] == '@')
+    {
+        p = strchr(p, ':');
+        p = (p != NULL) ? p + 1 : line;
+    }
+    if (strncmp(p, "T=", 2) == 0)
+        ((hh_alive_ctx_t *)ctx)->ok = 1;
+}
+
+static uint8_t hh_alive(void)
+{
+    hh_alive_ctx_t c = {0};
+    hh_lines_t l = {0};
+    uint8_t buf[64];
+    uint8_t node = (uint8_t)Param_Get(PARAM_NODE);
+    char cmd[32];
+    unsigned i;
+
+    hh_to_ascii();
+
+    /* Débit non confirmé (BAUD=) : retour au précédent */
+    for (i = 0; i < 1500u; i++)
+        hh_loop(0);
+    while (Host_TxRead(buf, sizeof(buf)) > 0u)
+        ;
+
+    if (node != RPI_NODE_NONE)
+        snprintf(cmd, sizeof(cmd), "\r\n@%u:GET_T\r\n", node);
+    else
+        snprintf(cmd, sizeof(cmd), "\r\nGET_T\r\n");
+    hh_send_str(cmd);
+    hh_loop(0);
+    hh_lines_feed(&l, hh_alive_line, &c);
+
+    return (uint8_t)(c.ok && RpiProto_GetMode() == RPI_MODE_ASCII);
+}
+
+static void hh_fuzz(uint32_t n)
+{
+    hh_lines_t l = {0};
+    uint8_t buf[512];
+    uint32_t i, bytes = 0, switches = 0;
+    rpi_mode_t mode;
+    size_t len;
+
+    hh_boot(UART_TX_BUF_SIZE);
+    mode = RpiProto_GetMode();
+
+    for (i = 0; i < n; i++)
+    {
+        len = hh_fuzz_input(buf, sizeof(buf));
+        Host_Rx(buf, len);
+        bytes += (uint32_t)len;
+        if (RpiProto_GetMode() == RPI_MODE_MODBUS && (hh_rand() & 1u))
+            Host_ModbusSilence();
+        if ((hh_rand() % 16u) == 0u)
+            Host_PublishSample((int32_t)(hh_rand() % 5000u), 90000u + hh_rand() % 20000u,
+                               (int32_t)(hh_rand() % 360000u));
+
+        hh_loop(hh_rand() & 1u);
+        if ((hh_rand() % 256u) == 0u)
+            hh_to_ascii();          /* revisite les trois modes */
+
+        /* Sortie ASCII vérifiée ; en binaire / Modbus, seulement vidée */
+        if (RpiProto_GetMode() == RPI_MODE_ASCII && mode == RPI_MODE_ASCII)
+            hh_lines_feed(&l, NULL, NULL);
+        else
+        {
+            while (Host_TxRead(buf, sizeof(buf)) > 0u)
+                ;
+            l.len = 0;          /* ligne coupée par le changement de mode */
+        }
+        if (RpiProto_GetMode() != mode)
+        {
+            mode = RpiProto_GetMode();
+            switches++;
+        }
+    }
+
+    hh_metric("fuzz", "inputs", n);
+    hh_metric("fuzz", "bytes", bytes);
+    hh_metric("fuzz", "mode_switches", switches);
+    hh_metric("fuzz", "ascii_lines", l.lines);
+    hh_metric("fuzz", "bad_lines", l.bad);
+    hh_metric("fuzz", "alive", hh_alive());
+}
+
+/* --------------------------------------------------------------------------
+ * Réception DMA (uart_rx.c)
+ * -------------------------------------------------------------------------- */
+
+/* Un bloc de la ligne en morceaux aléatoires : événements HT / TC / IDLE
+ * manqués au hasard, ORE entre deux morceaux. Jamais plus de
+ * UART_RX_BUF_SIZE - 1 octets sans événement (au-delà, perte réelle) ; le
+ * dernier morceau signale tout, la ligne reste ensuite au repos.
+ */
+static void hh_rx_mangled(const uint8_t *data, size_t len, uint32_t *errors)
+{
+    size_t n, room;
+    uint8_t ev;
+
+    while (len > 0u)
+    {
+        n    = 1u + hh_rand() % 48u;
+        room = UART_RX_BUF_SIZE - 1u - Host_RxUnreported();
+        ev   = (uint8_t)(hh_rand() & HOST_RX_EV_ALL);
+        if (n >= len || n >= room)
+        {
+            n  = (n > len) ? len : n;
+            n  = (n > room) ? room : n;
+            ev = HOST_RX_EV_ALL;
+        }
+
+        Host_RxDma(data, n, ev);
+        data += n;
+        len  -= n;
+
+        if (len > 0u && (hh_rand() % 16u) == 0u)
+        {
+            Host_RxError();
+            (*errors)++;
+        }
+    }
+}
+
+/* Flux attendu par le traitement de réception substitué au protocole */
+static const uint8_t *s_rx_expect;
+static size_t   s_rx_expect_len;
+static size_t   s_rx_got;
+static uint32_t s_rx_bad;
+
+static void hh_rx_sink(const uint8_t *data, uint16_t len, uint8_t idle)
+{
+    uint16_t i;
+
+    for (i = 0; i < len; i++, s_rx_got++)
+    {
+        if (s_rx_got >= s_rx_expect_len || data[i] != s_rx_expect[s_rx_got])
+            s_rx_bad++;
+    }
+}
+
+typedef struct
+{
+    uint32_t next;          /* n attendu dans la prochaine réponse TIME= */
+    uint32_t ok;
+} hh_rx_ctx_t;
+
+static void hh_rx_line(const char *line, void *ctx)
+{
+    hh_rx_ctx_t *c = ctx;
+    unsigned long t1;
+    char *end;
+
+    if (strncmp(line, "TIME=", 5) != 0)
+        return;
+    t1 = strtoul(&line[5], &end, 10);
+    if (*end == ',' && t1 == c->next)
+        c->ok++;
+    c->next = (uint32_t)t1 + 1u;
+}
+
+static void hh_rx(uint32_t n)
+{
+    hh_rx_ctx_t c = {0};
+    hh_lines_t l = {0};
+    uart_rx_stats_t st;
+    uint8_t *stream;
+    uint32_t i, errors = 0;
+    size_t pos, len;
+    char cmd[32];
+
+    /* Octets bruts : traitement du protocole remplacé par une comparaison */
+    hh_boot(UART_TX_BUF_SIZE);
+    stream = malloc(n);
+    if (stream == NULL)
+        return;
+    for (i = 0; i < n; i++)
+        stream[i] = (uint8_t)hh_rand();
+    s_rx_expect = stream;
+    s_rx_expect_len = n;
+    s_rx_got = 0;
+    s_rx_bad = 0;
+    (void)UartRx_Start(&huart1, hh_rx_sink);
+
+    for (pos = 0; pos < n; pos += len)
+    {
+        len = 1u + hh_rand() % (UART_RX_BUF_SIZE * 2u);
+        if (len > n - pos)
+            len = n - pos;
+        hh_rx_mangled(&stream[pos], len, &errors);
+    }
+    (void)UartRx_GetStats(&huart1, &st);
+    free(stream);
+
+    hh_metric("rx", "bytes", (double)s_rx_got);
+    hh_metric("rx", "events", st.events);
+    hh_metric("rx", "errors", errors);
+    hh_metric("rx", "bytes_lost", (double)(n - (s_rx_got < n ? s_rx_got : n)) + s_rx_bad);
+
+    /* Protocole complet : commandes coupées n'importe où, ORE compris */
+    hh_boot(UART_TX_BUF_SIZE);
+    for (i = 0; i < n / 16u; i++)
+    {
+        len = (size_t)snprintf(cmd, sizeof(cmd), "TIME=%lu\r\n", (unsigned long)i);
+        hh_rx_mangled((const uint8_t *)cmd, len, &errors);
+        hh_loop(0);
+        hh_lines_feed(&l, hh_rx_line, &c);
+    }
+    hh_metric("rx", "cmds", n / 16u);
+    hh_metric("rx", "cmds_lost", n / 16u - c.ok);
+    hh_metric("rx", "bad_lines", l.bad);
+}
+
+/* --------------------------------------------------------------------------
+ * Service sur pseudo-terminal
+ * -------------------------------------------------------------------------- */
+
+static int hh_serve(int fd)
+{
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    uint8_t buf[512];
+    uint8_t rx_pending = 0;
+    double last = hh_seconds(), now;
+    ssize_t n;
+    size_t r, off;
+    int ready;
+
+    hh_boot(UART_TX_BUF_SIZE);
+    for (;;)
+    {
+        ready = poll(&pfd, 1, HH_PTY_SILENCE_MS);
+        if (ready < 0)
+            return 1;
+        if (ready > 0)
+        {
+            /* POLLHUP seul : plus d'esclave ouvert */
+            if ((pfd.revents & POLLIN) == 0)
+                return 0;
+            n = read(fd, buf, sizeof(buf));
+            if (n <= 0)
+                return 0;
+            Host_Rx(buf, (size_t)n);
+            rx_pending = 1;
+        }
+        else if (rx_pending)
+        {
+            Host_ModbusSilence();
+            rx_pending = 0;
+        }
+
+        now = hh_seconds();
+        Host_AdvanceUs((uint32_t)((now - last) * 1e6));
+        last = now;
+
+        RpiProto_Task();
+        Host_TxDrain(UINT32_MAX);
+        while ((r = Host_TxRead(buf, sizeof(buf))) > 0u)
+        {
+            for (off = 0; off < r; off += (size_t)n)
+            {
+                n = write(fd, &buf[off], r - off);
+                if (n <= 0)
+                    return 1;
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *streams[HH_MAX_STREAMS];
+    unsigned n_streams = 0, i;
+    uint32_t n_cmds = 200000u, n_fuzz = 200000u;
+    int a;
+
+    for (a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "-n") == 0 && a + 1 < argc)
+            n_cmds = (uint32_t)strtoul(argv[++a], NULL, 0);
+        else if (strcmp(argv[a], "-f") == 0 && a + 1 < argc)
+            n_fuzz = (uint32_t)strtoul(argv[++a], NULL, 0);
+        else if (strcmp(argv[a], "-s") == 0 && a + 1 < argc)
+            s_rng = strtoull(argv[++a], NULL, 0) * 0x9E3779B97F4A7C15ULL + 1u;
+        else if (strcmp(argv[a], "-r") == 0 && a + 1 < argc && n_streams < HH_MAX_STREAMS)
+            streams[n_streams++] = argv[++a];
+        else if (strcmp(argv[a], "-v") == 0)
+            host_verbose = 1;
+        else if (strcmp(argv[a], "-p") == 0 && a + 1 < argc)
+            return hh_serve(atoi(argv[++a]));
+        else
+        {
+            fprintf(stderr, "usage: %s [-n cmds] [-f fuzz] [-s graine] [-r flux]... [-v] | -p fd\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (n_cmds > 0u)
+    {
+        hh_throughput_ascii(n_cmds);
+        hh_throughput_dispatch(n_cmds);
+        hh_throughput_bin(n_cmds);
+        hh_throughput_modbus(n_cmds);
+        for (i = 0; i < n_streams; i++)
+            hh_throughput_recorded(streams[i], i, n_cmds);
+        hh_latency();
+        hh_overflow();
+        hh_modbus_split(UART_RX_BUF_SIZE);
+    }
+    if (n_fuzz > 0u)
+    {
+        hh_fuzz(n_fuzz);
+        hh_rx(n_fuzz);
+    }
+
+    return 0;
+}
@@ -0,0 +1,533 @@
+/*
+ * host_port.c
+ *
+ *  Created on: Feb 8, 2026
+ *      Author: penel
+ */
+
+#include "host_port.h"
+#include "uart_tx.h"
+#include "uart_rx.h"
+#include "uart_baud.h"
+#include "sensors_app.h"
+#include "imu_capture.h"
+#include "i2c_bus.h"
+#include "mpu9250.h"
+#include "flash_ee.h"
+#include "rpi_modbus.h"
+#include "../COM_drivers/valve/valve_control.h"
+#include <string.h>
+
+/* Périphériques en RAM (host_port.h) */
+uint32_t       host_primask = 0;
+TIM_TypeDef    host_tim2;
+TIM_TypeDef    host_tim7;
+RCC_TypeDef    host_rcc;
+GPIO_TypeDef   host_gpioa;
+DWT_Type       host_dwt;
+CoreDebug_Type host_coredebug;
+
+UART_HandleTypeDef huart1;
+UART_HandleTypeDef huart2;
+
+/* Horloge CPU de la carte (HSI 16 MHz, PLL : 84 MHz), pour GET_PERF */
+uint32_t SystemCoreClock = 84000000u;
+
+uint8_t  host_verbose = 0;
+uint32_t host_debug_lines = 0;
+
+/* Horloges : HAL_GetTick() suit TIM2 (µs) */
+static uint64_t s_now_us = 0;
+
+/* --------------------------------------------------------------------------
+ * UART simulé : émission vers un buffer lu par le banc ; réception par le
+ * vrai uart_rx.c derrière un DMA circulaire simulé (NDTR, événements
+ * moitié / fin de buffer / IDLE du HAL)
+ * -------------------------------------------------------------------------- */
+
+static uint8_t  s_tx[HOST_TX_BUF_SIZE];
+static uint16_t s_tx_size = UART_TX_BUF_SIZE;
+static uint16_t s_tx_used = 0;     /* octets "sur la ligne" (pas encore drainés) */
+static size_t   s_tx_rd = 0, s_tx_wr = 0;
+static host_tx_stats_t s_tx_stats;
+
+static DMA_Stream_TypeDef s_rx_stream;
+static DMA_HandleTypeDef  s_hdma_rx = { .Instance = &s_rx_stream };
+static uint8_t *s_rx_buf = NULL;       /* NULL : DMA arrêté */
+static uint16_t s_rx_size = 0;
+static uint16_t s_rx_pos = 0;          /* prochaine case écrite par le DMA */
+static size_t   s_rx_unreported = 0;   /* octets écrits depuis le dernier événement */
+
+static void host_tx_copy(const uint8_t *data, uint16_t len)
+{
+    uint16_t i;
+
+    for (i = 0; i < len; i++)
+        s_tx[(s_tx_wr++) % HOST_TX_BUF_SIZE] = data[i];
+}
+
+HAL_StatusTypeDef UartTx_Init(UART_HandleTypeDef *huart)
+{
+    return HAL_OK;
+}
+
+uint16_t UartTx_Write2(UART_HandleTypeDef *huart,
+                       const uint8_t *data1, uint16_t len1,
+                       const uint8_t *data2, uint16_t len2)
+{
+    uint16_t len = (uint16_t)(len1 + len2);
+
+    /* Console (USART2) : jamais pleine */
+    if (huart != &huart1)
+    {
+        host_debug_lines++;
+        if (host_verbose)
+        {
+            fwrite(data1, 1, len1, stderr);
+            if (data2 != NULL)
+                fwrite(data2, 1, len2, stderr);
+        }
+        return len;
+    }
+
+    if ((uint32_t)s_tx_used + len > s_tx_size)
+    {
+        s_tx_stats.overflows++;
+        return 0;
+    }
+
+    host_tx_copy(data1, len1);
+    host_tx_copy(data2, len2);
+    s_tx_used = (uint16_t)(s_tx_used + len);
+    if (s_tx_used > s_tx_stats.high_water)
+        s_tx_stats.high_water = s_tx_used;
+    s_tx_stats.bytes += len;
+    s_tx_stats.writes++;
+    return len;
+}
+
+uint16_t UartTx_Write(UART_HandleTypeDef *huart, const uint8_t *data, uint16_t len)
+{
+    return UartTx_Write2(huart, data, len, NULL, 0);
+}
+
+HAL_StatusTypeDef UartTx_SetDriverEnable(UART_HandleTypeDef *huart,
+                                         GPIO_TypeDef *port, uint16_t pin)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef UartTx_Flush(UART_HandleTypeDef *huart, uint32_t timeout_ms)
+{
+    if (huart == &huart1)
+        s_tx_used = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef UartTx_GetStats(UART_HandleTypeDef *huart, uart_tx_stats_t *st)
+{
+    memset(st, 0, sizeof(*st));
+    if (huart != &huart1)
+        return HAL_OK;
+
+    st->size       = s_tx_size;
+    st->used       = s_tx_used;
+    st->high_water = s_tx_stats.high_water;
+    st->overflows  = s_tx_stats.overflows;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    if (huart != &huart1 || pData == NULL || Size == 0u)
+        return HAL_ERROR;
+
+    huart->hdmarx  = &s_hdma_rx;
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    s_rx_buf  = pData;
+    s_rx_size = Size;
+    s_rx_pos  = 0;
+    s_rx_unreported  = 0;
+    s_rx_stream.NDTR = Size;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart)
+{
+    /* NDTR garde le nombre d'octets restants, comme sur cible */
+    s_rx_buf = NULL;
+    huart->RxState = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+/* HAL_UARTEx_RxEventCallback() de main.c, type d'événement renseigné
+ * avant l'appel comme dans HAL_UART_IRQHandler / UART_DMARxHalfCplt
+ */
+static void host_rx_event(HAL_UART_RxEventTypeTypeDef type, uint16_t size)
+{
+    s_rx_unreported = 0;
+    huart1.RxEventType = type;
+    UartRx_OnEvent(&huart1, size);
+}
+
+HAL_UART_RxEventTypeTypeDef HAL_UARTEx_GetRxEventType(UART_HandleTypeDef *huart)
+{
+    return huart->RxEventType;
+}
+
+uint32_t UartBaud_Actual(const UART_HandleTypeDef *huart, uint32_t baud)
+{
+    return baud;
+}
+
+HAL_StatusTypeDef UartBaud_Set(UART_HandleTypeDef *huart, uint32_t baud, uint32_t hw_flow)
+{
+    huart->Init.BaudRate  = baud;
+    huart->Init.HwFlowCtl = hw_flow;
+    return HAL_OK;
+}
+
+/* --------------------------------------------------------------------------
+ * HAL
+ * -------------------------------------------------------------------------- */
+
+uint32_t HAL_GetTick(void)
+{
+    return (uint32_t)(s_now_us / 1000u);
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+    return 42000000u;   /* APB1 = SYSCLK / 2 sur cible */
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority) {}
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn) {}
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn) {}
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init) {}
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {}
+
+/* --------------------------------------------------------------------------
+ * Capteurs, capture IMU, bus I2C : valeurs fixées par le banc
+ * -------------------------------------------------------------------------- */
+
+static sensors_state_t s_state;
+static int32_t s_ctrl_ref = 0;
+static sensor_filter_type_t s_filter_type[SENSORS_CH_COUNT];
+static uint8_t s_filter_param[SENSORS_CH_COUNT];
+static uint32_t s_window_ms[SENSORS_CH_COUNT][SENSORS_STATS_SLOTS];
+static const sensor_stats_window_t s_no_stats;
+static i2c_bus_dev_t s_bus;
+
+const sensors_state_t* SensorsApp_GetState(void)
+{
+    return &s_state;
+}
+
+void SensorsApp_SetControlRef(int32_t ref_centi)
+{
+    s_ctrl_ref = ref_centi;
+}
+
+int32_t SensorsApp_GetControlRef(void)
+{
+    return s_ctrl_ref;
+}
+
+/* Vanne : consigne seule, pas de CAN sur le banc */
+static int32_t s_valve_ref = VALVE_T_REF_CENTI;
+
+void ValveControl_SetRef(int32_t ref_centi)
+{
+    s_valve_ref = ref_centi;
+}
+
+int32_t ValveControl_GetRef(void)
+{
+    return s_valve_ref;
+}
+
+HAL_StatusTypeDef SensorsApp_SetFilter(sensors_channel_t ch, sensor_filter_type_t type,
+                                       uint8_t param)
+{
+    sensor_filter_t f;
+
+    if (ch >= SENSORS_CH_COUNT || SensorFilter_Config(&f, type, param) != HAL_OK)
+        return HAL_ERROR;
+
+    s_filter_type[ch]  = type;
+    s_filter_param[ch] = param;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef SensorsApp_GetFilter(sensors_channel_t ch, sensor_filter_type_t *type,
+                                       uint8_t *param)
+{
+    if (ch >= SENSORS_CH_COUNT)
+        return HAL_ERROR;
+
+    *type  = s_filter_type[ch];
+    *param = s_filter_param[ch];
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef SensorsApp_SetStatsWindow(sensors_channel_t ch, uint8_t slot,
+                                            uint32_t window_ms)
+{
+    if (ch >= SENSORS_CH_COUNT || slot >= SENSORS_STATS_SLOTS || window_ms == 0u)
+        return HAL_ERROR;
+
+    s_window_ms[ch][slot] = window_ms;
+    return HAL_OK;
+}
+
+const sensor_stats_window_t* SensorsApp_GetStats(sensors_channel_t ch, uint8_t slot,
+                                                 uint32_t *window_ms)
+{
+    if (ch >= SENSORS_CH_COUNT || slot >= SENSORS_STATS_SLOTS)
+        return NULL;
+
+    if (window_ms != NULL)
+        *window_ms = s_window_ms[ch][slot];
+    return &s_no_stats;
+}
+
+const i2c_bus_dev_t* SensorsApp_GetBmpBusHealth(void)
+{
+    return &s_bus;
+}
+
+const i2c_bus_dev_t* mpu9250_get_bus_health(void)
+{
+    return &s_bus;
+}
+
+uint32_t I2CBus_GetRecoveryCount(void)
+{
+    return 0;
+}
+
+HAL_StatusTypeDef ImuCapture_Config(uint16_t pre, uint16_t post)
+{
+    return (post == 0u || pre + post > IMU_CAPTURE_DEPTH) ? HAL_ERROR : HAL_OK;
+}
+
+HAL_StatusTypeDef ImuCapture_SetThreshold(imu_axis_t axis, int16_t level,
+                                          imu_capture_edge_t edge)
+{
+    return (axis < IMU_AXIS_COUNT) ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef ImuCapture_Arm(uint8_t src_mask)
+{
+    return HAL_OK;
+}
+
+void ImuCapture_Disarm(void) {}
+void ImuCapture_Trigger(imu_capture_trig_t src) {}
+
+void ImuCapture_GetStatus(imu_capture_status_t *st)
+{
+    memset(st, 0, sizeof(*st));
+    st->state    = IMU_CAPTURE_IDLE;
+    st->trig_src = IMU_CAPTURE_TRIG_NONE;
+}
+
+HAL_StatusTypeDef ImuCapture_GetSample(uint16_t k, mpu9250_raw_data_t *out)
+{
+    return HAL_ERROR;   /* aucune capture terminée */
+}
+
+/* --------------------------------------------------------------------------
+ * EEPROM émulée en RAM : toujours réussie, rien n'est relu au démarrage
+ * -------------------------------------------------------------------------- */
+
+static uint32_t s_ee_writes = 0;
+
+HAL_StatusTypeDef FlashEe_Init(void (*on_record)(uint16_t id, uint32_t value))
+{
+    s_ee_writes = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef FlashEe_Write(uint16_t id, uint32_t value)
+{
+    s_ee_writes++;
+    return HAL_OK;
+}
+
+void FlashEe_GetStats(flash_ee_stats_t *st)
+{
+    memset(st, 0, sizeof(*st));
+    st->used     = s_ee_writes;
+    st->capacity = FLASH_EE_CAPACITY;
+}
+
+/* --------------------------------------------------------------------------
+ * Pilotage
+ * -------------------------------------------------------------------------- */
+
+void Host_Reset(uint16_t tx_size)
+{
+    unsigned ch;
+
+    memset(&host_tim2, 0, sizeof(host_tim2));
+    memset(&host_tim7, 0, sizeof(host_tim7));
+    memset(&host_rcc, 0, sizeof(host_rcc));
+    memset(&host_dwt, 0, sizeof(host_dwt));
+    memset(&huart1, 0, sizeof(huart1));
+    memset(&huart2, 0, sizeof(huart2));
+    huart1.Init.BaudRate = 115200u;
+    host_rcc.CFGR = RCC_CFGR_PPRE1_DIV2;
+    s_now_us = 0;
+
+    s_tx_size = (tx_size > HOST_TX_BUF_SIZE) ? (uint16_t)HOST_TX_BUF_SIZE : tx_size;
+    s_tx_used = 0;
+    s_tx_rd = s_tx_wr = 0;
+    memset(&s_tx_stats, 0, sizeof(s_tx_stats));
+    s_rx_buf = NULL;
+    s_rx_unreported = 0;
+
+    memset(&s_state, 0, sizeof(s_state));
+    s_state.period_ms = 100u;
+    for (ch = 0; ch < SENSORS_CH_COUNT; ch++)
+    {
+        s_filter_type[ch]  = SENSOR_FILTER_NONE;
+        s_filter_param[ch] = 0;
+        s_window_ms[ch][0] = SENSORS_STATS_DEFAULT_0_MS;
+        s_window_ms[ch][1] = SENSORS_STATS_DEFAULT_1_MS;
+    }
+}
+
+/* TIM7 one-shot à 1 MHz (rpi_modbus.c) : débordement -> interruption */
+static void host_tim7_advance(uint32_t us)
+{
+    uint32_t left;
+
+    if ((host_tim7.CR1 & TIM_CR1_CEN) == 0u)
+        return;
+
+    left = host_tim7.ARR + 1u - host_tim7.CNT;
+    if (us < left)
+    {
+        host_tim7.CNT += us;
+        return;
+    }
+
+    host_tim7.CNT  = 0;
+    host_tim7.CR1 &= ~TIM_CR1_CEN;
+    host_tim7.SR  |= TIM_SR_UIF;
+    if (host_tim7.DIER & TIM_DIER_UIE)
+        RpiModbus_IRQHandler();
+}
+
+void Host_AdvanceUs(uint32_t us)
+{
+    s_now_us += us;
+    host_tim2.CNT = (uint32_t)s_now_us;
+    host_tim7_advance(us);
+}
+
+void Host_RxDma(const uint8_t *data, size_t len, uint8_t events)
+{
+    size_t i;
+
+    for (i = 0; i < len && s_rx_buf != NULL; i++)
+    {
+        s_rx_buf[s_rx_pos++] = data[i];
+        s_rx_unreported++;
+        s_rx_stream.NDTR = (uint32_t)(s_rx_size - s_rx_pos);
+
+        /* Moitié puis fin de buffer ; en circulaire NDTR est rechargé */
+        if (s_rx_pos == s_rx_size / 2u && (events & HOST_RX_EV_HT))
+            host_rx_event(HAL_UART_RXEVENT_HT, (uint16_t)(s_rx_size / 2u));
+        if (s_rx_pos == s_rx_size)
+        {
+            s_rx_pos = 0;
+            s_rx_stream.NDTR = s_rx_size;
+            if (events & HOST_RX_EV_TC)
+                host_rx_event(HAL_UART_RXEVENT_TC, s_rx_size);
+        }
+    }
+
+    if (len > 0u && (events & HOST_RX_EV_IDLE))
+        Host_RxIdle();
+}
+
+void Host_RxIdle(void)
+{
+    if (s_rx_buf == NULL)
+        return;
+
+    /* En circulaire, le HAL signale aussi l'IDLE qui suit la fin de
+     * buffer (NDTR rechargé) : Size = taille du buffer
+     */
+    host_rx_event(HAL_UART_RXEVENT_IDLE, (s_rx_pos != 0u) ? s_rx_pos : s_rx_size);
+}
+
+void Host_Rx(const uint8_t *data, size_t len)
+{
+    Host_RxDma(data, len, HOST_RX_EV_ALL);
+}
+
+void Host_RxError(void)
+{
+    if (s_rx_buf == NULL)
+        return;
+
+    /* HAL_UART_IRQHandler : DMA de réception arrêté, RxState prêt, puis
+     * HAL_UART_ErrorCallback() de main.c
+     */
+    s_rx_buf = NULL;
+    s_rx_unreported = 0;
+    huart1.ErrorCode = HAL_UART_ERROR_ORE;
+    huart1.RxState   = HAL_UART_STATE_READY;
+    UartRx_OnError(&huart1);
+}
+
+size_t Host_RxUnreported(void)
+{
+    return s_rx_unreported;
+}
+
+void Host_TxDrain(uint32_t bytes)
+{
+    s_tx_used = (bytes >= s_tx_used) ? 0u : (uint16_t)(s_tx_used - bytes);
+}
+
+size_t Host_TxRead(uint8_t *out, size_t len)
+{
+    size_t n = 0;
+
+    /* Plus ancien que la taille du buffer : écrasé, perdu pour le banc */
+    if (s_tx_wr - s_tx_rd > HOST_TX_BUF_SIZE)
+        s_tx_rd = s_tx_wr - HOST_TX_BUF_SIZE;
+
+    /* Seuls les octets déjà sortis sur la ligne sont reçus par le Pi */
+    while (s_tx_rd + s_tx_used < s_tx_wr && n < len)
+        out[n++] = s_tx[(s_tx_rd++) % HOST_TX_BUF_SIZE];
+    return n;
+}
+
+void Host_GetTxStats(host_tx_stats_t *st)
+{
+    *st = s_tx_stats;
+}
+
+void Host_PublishSample(int32_t temp_centi, uint32_t press_pa, int32_t angle_milli)
+{
+    s_state.temp_centi  = temp_centi;
+    s_state.press_pa    = press_pa;
+    s_state.angle_milli = angle_milli;
+    s_state.sample_tick = HAL_GetTick();
+    s_state.sample_us   = (uint32_t)s_now_us;
+    s_state.sample_seq++;
+}
+
+void Host_ModbusSilence(void)
+{
+    host_tim7.CNT  = 0;
+    host_tim7.CR1 &= ~TIM_CR1_CEN;
+    host_tim7.SR  |= TIM_SR_UIF;
+    RpiModbus_IRQHandler();
+}
@@ -0,0 +1,165 @@
+/*
+ * host_port.h
+ *
+ *  Created on: Feb 8, 2026
+ *      Author: penel
+ */
+
+#ifndef HOST_PORT_H_
+#define HOST_PORT_H_
+
+/*
+ * Portage Linux du protocole Raspberry Pi (COM_drivers/rpi), pour le banc
+ * host_harness.c. Inclus avant chaque source (gcc -include host_port.h) :
+ *
+ *  - en-têtes HAL / CMSIS d'origine (types, constantes), puis
+ *  - périphériques redirigés vers des copies en RAM (TIM2, TIM7, DWT,
+ *    RCC...) et instructions Cortex-M (masquage des interruptions)
+ *    remplacées : les sources du firmware compilent sans modification
+ *
+ * Le reste (UART, capteurs, flash, horloge) est simulé dans host_port.c.
+ * Dossier hors des sources de STM32CubeIDE (.cproject) : jamais compilé
+ * pour la cible. Construction et lancement : python/bench_host.py,
+ * python/modbus_pty_test.py (esclave Modbus derrière un pseudo-terminal).
+ */
+
+#include "main.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* --- Cortex-M : pas d'interruptions réelles, la simulation est séquentielle --- */
+extern uint32_t host_primask;
+
+#define __disable_irq()      (host_primask = 1u)
+#define __enable_irq()       (host_primask = 0u)
+#define __get_PRIMASK()      (host_primask)
+#define __set_PRIMASK(m)     (host_primask = (m))
+#define __DSB()              ((void)0)
+#define __DMB()              ((void)0)
+#define __ISB()              ((void)0)
+
+/* --- Périphériques en RAM --- */
+extern TIM_TypeDef       host_tim2;
+extern TIM_TypeDef       host_tim7;
+extern RCC_TypeDef       host_rcc;
+extern GPIO_TypeDef      host_gpioa;
+extern DWT_Type          host_dwt;
+extern CoreDebug_Type    host_coredebug;
+
+#undef  TIM2
+#define TIM2        (&host_tim2)
+#undef  TIM7
+#define TIM7        (&host_tim7)
+#undef  RCC
+#define RCC         (&host_rcc)
+#undef  GPIOA
+#define GPIOA       (&host_gpioa)
+#undef  DWT
+#define DWT         (&host_dwt)
+#undef  CoreDebug
+#define CoreDebug   (&host_coredebug)
+
+/* --- Pilotage de la simulation (host_harness.c) --- */
+
+extern UART_HandleTypeDef huart1;     /* liaison Pi */
+extern UART_HandleTypeDef huart2;     /* console */
+
+/* Octets émis vers le Pi, en attente de lecture par le banc */
+#define HOST_TX_BUF_SIZE     8192u
+
+typedef struct
+{
+    uint32_t bytes;         /* octets acceptés par UartTx_Write */
+    uint32_t writes;        /* messages acceptés */
+    uint32_t overflows;     /* messages rejetés (buffer simulé plein) */
+    uint16_t high_water;
+} host_tx_stats_t;
+
+/**
+ * @brief Remet la simulation à zéro (horloges, UART, capteurs, flash).
+ *        Appeler avant RpiProto_Init().
+ *
+ * @param tx_size  capacité simulée du buffer d'émission vers le Pi
+ *                 (UART_TX_BUF_SIZE sur cible)
+ */
+void Host_Reset(uint16_t tx_size);
+
+/**
+ * @brief Fait avancer HAL_GetTick(), TIM2 (µs) et TIM7 (fin de trame
+ *        Modbus, interruption au débordement).
+ */
+void Host_AdvanceUs(uint32_t us);
+
+/* Événements du DMA de réception signalés par Host_RxDma() ; les autres
+ * sont manqués (interruptions regroupées ou servies en retard)
+ */
+#define HOST_RX_EV_HT       0x01u       /* moitié du buffer */
+#define HOST_RX_EV_TC       0x02u       /* fin du buffer */
+#define HOST_RX_EV_IDLE     0x04u       /* ligne au repos après le bloc */
+#define HOST_RX_EV_ALL      0x07u
+
+/**
+ * @brief Octets reçus sur la ligne vers le Pi : écrits un à un dans le
+ *        buffer du DMA circulaire (uart_rx.c), avec les événements
+ *        `events` au passage de la moitié, de la fin du buffer et en fin
+ *        de bloc.
+ */
+void Host_RxDma(const uint8_t *data, size_t len, uint8_t events);
+
+/**
+ * @brief Ligne au repos : événement IDLE à la position courante du DMA.
+ */
+void Host_RxIdle(void);
+
+/**
+ * @brief Host_RxDma(), tous les événements signalés.
+ */
+void Host_Rx(const uint8_t *data, size_t len);
+
+/**
+ * @brief Erreur de réception (ORE) : le HAL arrête le DMA puis appelle
+ *        HAL_UART_ErrorCallback().
+ */
+void Host_RxError(void);
+
+/**
+ * @brief Octets écrits par le DMA depuis le dernier événement signalé.
+ *        Au-delà de UART_RX_BUF_SIZE - 1, uart_rx.c ne peut plus les
+ *        distinguer (le DMA a fait un tour complet).
+ */
+size_t Host_RxUnreported(void);
+
+/**
+ * @brief Simule la fin de l'émission DMA : le buffer d'émission se vide
+ *        de `bytes` octets (débit de la ligne).
+ */
+void Host_TxDrain(uint32_t bytes);
+
+/**
+ * @brief Octets sortis sur la ligne (Host_TxDrain) depuis le dernier
+ *        appel, copiés dans out (len max).
+ *        @return nombre d'octets copiés
+ */
+size_t Host_TxRead(uint8_t *out, size_t len);
+
+void Host_GetTxStats(host_tx_stats_t *st);
+
+/* Console de debug (USART2, log.h) : lignes comptées ; copiées sur
+ * stderr si verbose (host_harness -v) */
+extern uint8_t  host_verbose;
+extern uint32_t host_debug_lines;
+
+/**
+ * @brief Nouvel échantillon capteurs (sample_seq++), comme
+ *        SensorsApp_Update() lors d'une publication.
+ */
+void Host_PublishSample(int32_t temp_centi, uint32_t press_pa, int32_t angle_milli);
+
+/**
+ * @brief Déclenche la fin de trame Modbus (interruption TIM7) sans
+ *        attendre le délai.
+ */
+void Host_ModbusSilence(void);
+
+#endif /* HOST_PORT_H_ */
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""
+Banc du protocole Raspberry Pi sans carte : COM_drivers/rpi compilé pour
+Linux (STM32_NUCLEO_CONTROLLER/host) et piloté par host_harness.
+
+  python3 bench_host.py                              # mesures
+  python3 bench_host.py --save-baseline base.json    # référence
+  python3 bench_host.py --baseline base.json         # barrière de régression
+
+Deux binaires :
+  - -O2 : débit (commandes/s), latence (tours de boucle principale de
+    1 ms avant que la réponse soit sortie sur la ligne à 115200 bauds),
+    débordements (buffer d'émission, file de commandes)
+  - -O1 -fsanitize=address,undefined : fuzz (octets aléatoires, commandes
+    mutées, trames binaires et Modbus valides) et réception DMA (uart_rx.c,
+    événements manqués, ORE), toute erreur mémoire ou comportement
+    indéfini arrête le banc
+
+Comparaison à la référence : débit plus bas de plus de --tolerance,
+latence plus haute de plus de --tolerance, ou compteur de robustesse
+différent (lignes tronquées, commandes ou octets perdus, fuzz.alive) -> code de
+sortie 1.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+FIRMWARE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..",
+                        "STM32_NUCLEO_CONTROLLER")
+HOST = os.path.join(FIRMWARE, "host")
+
+SOURCES = [
+    "COM_drivers/rpi/rpi_cmdq.c",
+    "COM_drivers/rpi/rpi_fmt.c",
+    "COM_drivers/rpi/rpi_frame.c",
+    "COM_drivers/rpi/rpi_modbus.c",
+    "COM_drivers/rpi/rpi_protocol.c",
+    "COM_drivers/rpi/rpi_tlm.c",
+    "COM_drivers/param/param.c",
+    "COM_drivers/time/timebase.c",
+    "COM_drivers/time/perf.c",
+    "COM_drivers/uart/uart_rx.c",
+    "COM_drivers/log/log.c",
+    "COM_drivers/log/trace.c",
+    "COM_drivers/sensors/sensor_filter.c",
+    "host/host_port.c",
+    "host/host_harness.c",
+]
+INCLUDES = [
+    "host",
+    "Core/Inc",
+    "Drivers/STM32F4xx_HAL_Driver/Inc",
+    "Drivers/STM32F4xx_HAL_Driver/Inc/Legacy",
+    "Drivers/CMSIS/Device/ST/STM32F4xx/Include",
+    "Drivers/CMSIS/Include",
+    "COM_drivers",
+    "COM_drivers/param",
+    "COM_drivers/rpi",
+    "COM_drivers/sensors",
+    "COM_drivers/time",
+    "COM_drivers/uart",
+    "COM_drivers/log",
+]
+CFLAGS = ["-std=gnu11", "-Wall", "-Wextra", "-Werror", "-Wno-unused-parameter",
+          "-Wno-int-to-pointer-cast", "-DSTM32F446xx", "-DUSE_HAL_DRIVER",
+          "-include", "host_port.h"]
+PERF_FLAGS = ["-O2"]
+FUZZ_FLAGS = ["-O1", "-g", "-fsanitize=address,undefined", "-fno-sanitize-recover=all"]
+
+TOLERANCE = 0.20
+
+# Sens de chaque mesure pour la comparaison à la référence
+HIGHER_IS_BETTER = ("_per_s",)
+LOWER_IS_BETTER = ("_loops",)
+EXACT = ("bad_lines", "_lost", "alive", "cmdq_full", "cmdq_too_long")
+
+
+def build(out: str, flags, cc: str) -> str:
+    cmd = [cc] + CFLAGS + flags + [f"-I{i}" for i in INCLUDES] + SOURCES + ["-o", out]
+    subprocess.run(cmd, cwd=FIRMWARE, check=True)
+    return out
+
+
+def run(exe: str, args) -> dict:
+    proc = subprocess.run([exe] + args, check=True, capture_output=True, text=True)
+    metrics = {}
+    for line in proc.stdout.splitlines():
+        key, _, value = line.partition("=")
+        if value:
+            metrics[key] = float(value)
+    return metrics
+
+
+def compare(metrics: dict, base: dict, tol: float):
+    """Liste des régressions (clé, référence, mesure)."""
+    bad = []
+    for key, ref in base.items():
+        if key not in metrics:
+            bad.append((key, ref, None))
+            continue
+        cur = metrics[key]
+        if key.endswith(HIGHER_IS_BETTER):
+            if cur < ref * (1.0 - tol):
+                bad.append((key, ref, cur))
+        elif key.endswith(LOWER_IS_BETTER):
+            if cur > ref * (1.0 + tol):
+                bad.append((key, ref, cur))
+        elif key.endswith(EXACT):
+            if cur != ref:
+                bad.append((key, ref, cur))
+    return bad
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    ap.add_argument("--cc", default=os.environ.get("CC", "gcc"))
+    ap.add_argument("-n", type=int, default=200000, help="commandes par mesure de débit")
+    ap.add_argument("-f", "--fuzz", type=int, default=200000, help="entrées de fuzz")
+    ap.add_argument("-s", "--seed", type=int, default=1)
+    ap.add_argument("-r", "--record", action="append", default=None,
+                    help="flux enregistré (octets bruts du Pi), par défaut host/streams/*.raw")
+    ap.add_argument("--save-baseline", metavar="JSON")
+    ap.add_argument("--baseline", metavar="JSON")
+    ap.add_argument("--tolerance", type=float, default=TOLERANCE)
+    args = ap.parse_args()
+
+    if shutil.which(args.cc) is None:
+        sys.exit(f"compilateur introuvable : {args.cc}")
+
+    records = args.record
+    if records is None:
+        sdir = os.path.join(HOST, "streams")
+        records = sorted(os.path.join(sdir, f) for f in os.listdir(sdir) if f.endswith(".raw"))
+
+    with tempfile.TemporaryDirectory() as tmp:
+        perf = build(os.path.join(tmp, "host_harness"), PERF_FLAGS, args.cc)
+        fuzz = build(os.path.join(tmp, "host_harness_asan"), FUZZ_FLAGS, args.cc)
+
+        rec_args = [a for r in records for a in ("-r", r)]
+        metrics = run(perf, ["-n", str(args.n), "-f", "0"] + rec_args)
+        metrics.update(run(fuzz, ["-n", "0", "-f", str(args.fuzz), "-s", str(args.seed)]))
+
+    for i, r in enumerate(records):
+        print(f"rec{i} = {os.path.relpath(r, FIRMWARE)}")
+    base = {}
+    if args.baseline:
+        with open(args.baseline) as fp:
+            base = json.load(fp)
+
+    print(f"{'mesure':36} {'valeur':>14} {'référence':>14}")
+    for key, value in metrics.items():
+        ref = base.get(key)
+        print(f"{key:36} {value:14.6g} {'' if ref is None else f'{ref:14.6g}':>14}")
+
+    if args.save_baseline:
+        with open(args.save_baseline, "w") as fp:
+            json.dump(metrics, fp, indent=2, sort_keys=True)
+        print(f"référence écrite : {args.save_baseline}")
+
+    if args.baseline:
+        bad = compare(metrics, base, args.tolerance)
+        for key, ref, cur in bad:
+            print(f"RÉGRESSION {key} : {ref:g} -> {'absent' if cur is None else f'{cur:g}'}")
+        if bad:
+            sys.exit(1)
+        print(f"aucune régression (tolérance {args.tolerance:.0%})")
+
+
+if __name__ == "__main__":
+    main()
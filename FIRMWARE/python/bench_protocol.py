@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+"""
+Comparaison ASCII / binaire : octets sur le lien et CPU hôte par lecture.
+
+  python3 bench_protocol.py                 # hors ligne (codec seul)
+  python3 bench_protocol.py /dev/ttyAMA0    # + aller-retour réel avec la carte
+
+Hors ligne, on mesure sur des réponses types :
+  - octets émis + reçus par lecture (commande + réponse),
+  - temps CPU hôte pour construire la requête et décoder la réponse.
+Avec la carte, on mesure en plus la latence moyenne d'un aller-retour et
+le débit de bout en bout (commandes/s, envois groupés par 8 = taille de la
+file du STM32), limité par la liaison à 115200 bauds ; le débit du
+dispatcher seul est mesuré sur PC par bench_host.py
+(throughput.dispatch_cmds_per_s).
+Télémétrie compressée (MSG_DATA_Z) : octets par échantillon selon la taille
+de lot et coût de décodage Python / numpy ; avec la carte, octets/s reçus
+et cycles de codage mesurés par le STM32 (GET_Z).
+"""
+
+import sys
+import time
+
+import random
+
+import stm32_frame as frame
+import stm32_client_v3 as client
+import stm32_tlm as tlm
+
+N_ITER = 20000
+
+# Réponses types (T = 23.45 °C, P = 101325 Pa)
+ASCII_CASES = [
+    ("GET_T", "T=+23.45_C\r\n", "T"),
+    ("GET_P", "P=101325Pa\r\n", "P"),
+]
+SNAPSHOT_CASES = [
+    ("GET_T", "T=+23.45_C\r\n"),
+    ("GET_P", "P=101325Pa\r\n"),
+    ("GET_A", "A=0.0000\r\n"),
+    ("GET_K", "K=5.00000\r\n"),
+]
+SNAPSHOT_REPLY = "ALL=812,40211,T2345,P101325,A0,K500\r\n"
+BIN_CASES = [
+    (frame.CMD_GET_T, (2345).to_bytes(4, "little", signed=True)),
+    (frame.CMD_GET_P, (101325).to_bytes(4, "little")),
+]
+
+
+def _cpu_per_call(fn, n=N_ITER) -> float:
+    t0 = time.process_time()
+    for _ in range(n):
+        fn()
+    return (time.process_time() - t0) / n * 1e6
+
+
+def bench_offline():
+    print(f"{'mode':8} {'cmd':6} {'octets':>7} {'CPU (µs)':>10}")
+
+    for cmd, reply, prefix in ASCII_CASES:
+        req = (cmd + "\r\n").encode("ascii")
+
+        def one():
+            (cmd + "\r\n").encode("ascii")
+            client._parse_value(reply.strip(), prefix)
+
+        print(f"{'ASCII':8} {cmd:6} {len(req) + len(reply):7d} {_cpu_per_call(one):10.2f}")
+
+    for cmd_id, payload in BIN_CASES:
+        req = frame.encode_frame(cmd_id)
+        rep = frame.encode_frame(cmd_id, payload)
+
+        def one():
+            frame.encode_frame(cmd_id)
+            _, p = frame.decode_frame(rep[:-1])
+            int.from_bytes(p, "little", signed=True)
+
+        print(f"{'BIN':8} 0x{cmd_id:02X}   {len(req) + len(rep):7d} {_cpu_per_call(one):10.2f}")
+
+    # T, P, A, K : 4 commandes contre un instantané GET_ALL
+    four = sum(len(c) + 2 + len(r) for c, r in SNAPSHOT_CASES)
+    snap = len("GET_ALL\r\n") + len(SNAPSHOT_REPLY)
+    print(f"T+P+A+K  : 4 x GET {four} octets / 4 allers-retours, "
+          f"GET_ALL {snap} octets / 1 aller-retour")
+
+
+def _synthetic_stream(n: int = 4000, seed: int = 1):
+    """t_us (10 ms + gigue), T (0.01 °C), P (Pa), A (0.001°) : dérives
+    lentes + bruit de mesure."""
+    rnd = random.Random(seed)
+    t_us, t, p, a = 0, 2345, 101325, 0
+    out = []
+    for _ in range(n):
+        t_us += 10000 + rnd.randint(-30, 30)
+        t += rnd.randint(-2, 2)
+        p += rnd.randint(-15, 15)
+        a += rnd.randint(-40, 40)
+        out.append((t_us, t, p, a))
+    return out
+
+
+def bench_telemetry():
+    """Compression MSG_DATA_Z (hors ligne) et coût de décodage hôte."""
+    samples = _synthetic_stream()
+    n_ch = len(samples[0])
+    raw = len(samples) * (tlm.FRAME_OVERHEAD + 4 + 4 * n_ch)   # seq + t_us + T, P, A
+
+    print(f"{'lot':>4} {'octets/éch.':>12} {'ratio':>6}")
+    for batch in (1, 4, 8, 16):
+        payloads = tlm.encode(samples, batch)
+        enc = sum(len(p) + tlm.FRAME_OVERHEAD for p in payloads)
+        print(f"{batch:4d} {enc / len(samples):12.2f} {raw / enc:6.2f}")
+
+    payloads = tlm.encode(samples, tlm.BATCH_MAX)
+
+    def pure():
+        prev = None
+        for p in payloads:
+            _, recs = tlm.decode_payload(p, n_ch, prev)
+            prev = recs[-1]
+
+    t_pure = _cpu_per_call(pure, 20) / len(samples)
+    try:
+        dec = tlm.TelemetryDecoder(n_ch)
+    except ImportError:
+        print(f"Décodage : Python {t_pure:.2f} µs/éch. (numpy absent)")
+        return
+
+    def vect():
+        tlm.TelemetryDecoder(n_ch).decode(payloads)
+
+    t_vect = _cpu_per_call(vect, 20) / len(samples)
+    dec.decode(payloads)
+    print(f"Décodage : Python {t_pure:.2f} µs/éch., numpy {t_vect:.3f} µs/éch.")
+
+
+def bench_telemetry_live(ser, duration: float = 2.0, period_ms: int = 10):
+    """Octets reçus en MSG_DATA puis MSG_DATA_Z, et coût de codage sur cible."""
+    client.print = lambda *a, **k: None
+    try:
+        client.set_binary_mode(ser)
+        rates = {}
+        for batch in (0, tlm.BATCH_MAX):
+            client.bin_subscribe(ser, "TPA", period_ms, batch)
+            ser.reset_input_buffer()
+            n_bytes = 0
+            t_end = time.perf_counter() + duration
+            while time.perf_counter() < t_end:
+                n_bytes += len(ser.read(ser.in_waiting or 1))
+            client.bin_unsubscribe(ser)
+            rates[batch] = n_bytes / duration
+        client.set_ascii_mode(ser)
+        z = [int(x) for x in client.send_command(ser, "GET_Z")[2:].split(",")]
+    finally:
+        del client.print
+
+    print(f"Flux TPA {period_ms} ms : MSG_DATA {rates[0]:.0f} o/s, "
+          f"MSG_DATA_Z {rates[tlm.BATCH_MAX]:.0f} o/s "
+          f"(ratio {rates[0] / max(rates[tlm.BATCH_MAX], 1):.2f})")
+    print(f"STM32 : {z[0]} éch. en {z[1]} trames, ratio {z[2] / max(z[3], 1):.2f}, "
+          f"codage {z[4]} cycles/éch. ({z[4] / 84:.2f} µs à 84 MHz)")
+
+
+def bench_live(port: str, n: int = 200):
+    import serial
+
+    ser = serial.Serial(port=port, baudrate=client.BAUDRATE, timeout=client.TIMEOUT_S)
+    try:
+        # Pas de trace [DEBUG] pendant la mesure (print masqué dans le module)
+        client.print = lambda *a, **k: None
+
+        t0 = time.perf_counter()
+        for _ in range(n):
+            client.get_temperature(ser)
+        t_ascii = (time.perf_counter() - t0) / n * 1e3
+
+        del client.print
+        client.set_binary_mode(ser)
+
+        t0 = time.perf_counter()
+        for _ in range(n):
+            client.bin_get_temperature(ser)
+        t_bin = (time.perf_counter() - t0) / n * 1e3
+
+        client.set_ascii_mode(ser)
+        print(f"Aller-retour GET_T : ASCII {t_ascii:.2f} ms, BIN {t_bin:.2f} ms")
+
+        bench_snapshot(ser, n)
+
+        bench_burst(ser)
+
+        bench_telemetry_live(ser)
+    finally:
+        ser.close()
+
+
+def bench_snapshot(ser, n: int = 200):
+    """T, P, A, K : quatre GET successifs contre un seul GET_ALL."""
+    client.print = lambda *a, **k: None
+    try:
+        t0 = time.perf_counter()
+        for _ in range(n):
+            client.get_temperature(ser)
+            client.get_pressure(ser)
+            client.get_acceleration(ser)
+            client.get_K(ser)
+        t_four = (time.perf_counter() - t0) / n * 1e3
+
+        t0 = time.perf_counter()
+        for _ in range(n):
+            client.get_all(ser)
+        t_all = (time.perf_counter() - t0) / n * 1e3
+    finally:
+        del client.print
+
+    print(f"T+P+A+K : 4 x GET {t_four:.2f} ms, GET_ALL {t_all:.2f} ms "
+          f"(gain {100.0 * (1.0 - t_all / t_four):.0f} %)")
+
+
+# Mélange de commandes courtes, début, milieu et fin de table
+BURST_CMDS = ["GET_T", "GET_P", "GET_K", "GET_R", "GET_Q", "GET_F=T", "CAP_STAT", "HELP=GET_T"]
+
+
+def bench_burst(ser, n_batches: int = 100):
+    """Commandes/s de bout en bout, file pleine en permanence : mesure la
+    liaison série, pas le dispatcher (voir bench_host.py)."""
+    t0 = time.perf_counter()
+    for _ in range(n_batches):
+        replies = client.send_commands(ser, BURST_CMDS)
+        if any(r.startswith("ERR=") for r in replies):
+            raise RuntimeError(f"Réponse en erreur : {replies}")
+    dt = time.perf_counter() - t0
+
+    n = n_batches * len(BURST_CMDS)
+    n_bytes = sum(len(c) + 2 for c in BURST_CMDS) * n_batches
+    print(f"Bout en bout : {n / dt:.0f} commandes/s "
+          f"(plafond de la liaison : {client.BAUDRATE / 10 / (n_bytes / n):.0f} en émission)")
+
+
+if __name__ == "__main__":
+    bench_offline()
+    bench_telemetry()
+    if len(sys.argv) > 1:
+        bench_live(sys.argv[1])
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""
+Esclave Modbus RTU sans carte : rpi_protocol.c + rpi_modbus.c compilés pour
+Linux (host_harness -p) derrière un pseudo-terminal (os.openpty()), piloté
+par stm32_modbus.py à travers pyserial comme sur /dev/ttyAMA0.
+
+  python3 modbus_pty_test.py            # code de sortie 1 au premier échec
+
+Vérifie :
+  - lecture du bloc d'entrée complet (0x04) : échantillon publié au
+    démarrage du banc (T = 23.45 °C, P = 101325 Pa, A = 12.5 °)
+  - aller-retour 0x10 / 0x03 (K, consigne), 0x06 (un mot de K, adresse
+    esclave)
+  - exceptions 01 (fonction), 02 (adresse), 03 (valeur) ; une écriture
+    refusée ne modifie rien
+  - diffusion (adresse 0) : écriture exécutée, aucune réponse
+  - CRC faux : trame ignorée, comptée dans mb_crc
+  - retour en ASCII par HR_MODE = 0
+"""
+
+import os
+import subprocess
+import sys
+import tempfile
+
+import serial
+
+import bench_host
+import stm32_modbus as mb
+
+TIMEOUT_S = 0.3
+
+
+def expect_exception(code: int, fn, *args):
+    try:
+        fn(*args)
+    except mb.ModbusError as e:
+        if not str(e).startswith(f"Exception {code} "):
+            raise AssertionError(f"exception {code} attendue : {e}") from e
+        return
+    raise AssertionError(f"exception {code} attendue, réponse normale reçue")
+
+
+def expect_silence(ser, adu: bytes):
+    """Requête sans réponse attendue ; silence t3.5 avant la suivante."""
+    ser.reset_input_buffer()
+    ser.write(adu)
+    ser.flush()
+    rsp = ser.read(1)
+    assert rsp == b"", f"réponse inattendue : {rsp.hex()}"
+
+
+def run_tests(ser):
+    mb.enter_modbus(ser)
+
+    # Bloc d'entrée complet, une transaction
+    tm = mb.read_telemetry(ser)
+    assert tm["T"] == 23.45 and tm["P"] == 101325 and tm["A"] == 12.5, tm
+    assert tm["mb_crc"] == 0 and tm["mb_except"] == 0, tm
+
+    # 0x10 puis 0x03 : les deux mots de K en une requête
+    mb.set_K(ser, 1234)
+    assert mb.get_K(ser) == 12.34
+    mb.set_K(ser, 70000)
+    assert mb.get_K(ser) == 700.0
+
+    # 0x06 : mot de poids faible seul, le mot fort est conservé
+    mb.write_register(ser, mb.HR_K + 1, 500)
+    k = (70000 & 0xFFFF0000 | 500) / 100.0
+    assert mb.get_K(ser) == k
+
+    mb.set_control_ref(ser, -1250)
+    regs = mb.read_registers(ser, mb.HR_CTRL_REF, 2, mb.FC_READ_HOLDING)
+    assert mb._regs_to_32(regs, True) == -1250, regs
+
+    # Nouvelle adresse : effective à la requête suivante
+    mb.write_register(ser, mb.HR_ADDR, 17)
+    assert mb.read_registers(ser, mb.HR_ADDR, 1, mb.FC_READ_HOLDING, addr=17) == [17]
+    expect_silence(ser, mb.build_adu(mb.ADDR_DEFAULT, mb.FC_READ_HOLDING, bytes((0, 0, 0, 2))))
+    mb.write_register(ser, mb.HR_ADDR, mb.ADDR_DEFAULT, addr=17)
+
+    # Exceptions
+    expect_exception(1, mb.transact, ser, mb.ADDR_DEFAULT, 0x2B, b"\x0E\x01\x00", 0)
+    expect_exception(2, mb.read_registers, ser, mb.IR_COUNT - 1, 2)
+    expect_exception(2, mb.write_register, ser, mb.HR_COUNT, 0)
+    expect_exception(3, mb.read_registers, ser, 0, 0)
+    expect_exception(3, mb.write_register, ser, mb.HR_MODE, 7)
+    expect_exception(3, mb.set_K, ser, -1)
+    assert mb.get_K(ser) == k       # set_K(-1) refusé en bloc
+
+    # Diffusion : exécutée, sans réponse
+    expect_silence(ser, mb.build_adu(0, mb.FC_WRITE_MULTI,
+                                     bytes((0, mb.HR_K, 0, 2, 4, 0, 0, 0x03, 0xE8))))
+    assert mb.get_K(ser) == 10.0
+    expect_silence(ser, mb.build_adu(0, mb.FC_READ_INPUT, bytes((0, 0, 0, 2))))
+
+    # CRC faux : ignorée, comptée
+    adu = bytearray(mb.build_adu(mb.ADDR_DEFAULT, mb.FC_WRITE_SINGLE, bytes((0, mb.HR_K + 1, 0, 1))))
+    adu[-1] ^= 0x01
+    expect_silence(ser, bytes(adu))
+    assert mb.get_K(ser) == 10.0
+
+    tm = mb.read_telemetry(ser)
+    assert tm["mb_crc"] == 1, tm
+    assert tm["mb_except"] == 6, tm
+
+    # Retour en ASCII
+    mb.exit_modbus(ser)
+    ser.reset_input_buffer()
+    ser.write(b"GET_K\r\n")
+    resp = ser.readline().decode("ascii", errors="ignore").strip()
+    assert resp == "K=10.00000", resp
+
+
+def main():
+    master, slave = os.openpty()
+    with tempfile.TemporaryDirectory() as tmp:
+        exe = bench_host.build(os.path.join(tmp, "host_harness_asan"),
+                               bench_host.FUZZ_FLAGS, os.environ.get("CC", "gcc"))
+        proc = subprocess.Popen([exe, "-p", str(master)], pass_fds=(master,))
+        os.close(master)
+        try:
+            with serial.Serial(os.ttyname(slave), 115200, timeout=TIMEOUT_S) as ser:
+                run_tests(ser)
+        except (AssertionError, mb.ModbusError) as e:
+            print(f"ÉCHEC : {e!r}")
+            sys.exit(1)
+        finally:
+            os.close(slave)
+            rc = proc.wait(timeout=5)
+    if rc != 0:
+        sys.exit(f"host_harness -p : code {rc}")
+    print("Modbus RTU sur pty : OK")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""
+Interrogation de plusieurs STM32 sur un même bus RS-485 (voir "NODE=" dans
+COM_drivers/rpi/rpi_protocol.h).
+
+  python3 rs485_poll.py /dev/ttyAMA0 1 2 3 4     # adresses des nœuds
+
+Chaque nœud reçoit ses requêtes en une seule écriture, étiquetées
+("@<n>:#<tag>:CMD") : il les traite d'un passage de boucle et répond à la
+suite, sans aller-retour par commande. Le nœud suivant n'est interrogé
+qu'une fois toutes les réponses reçues (ou le délai écoulé) : un seul
+émetteur à la fois sur la paire.
+
+Côté Raspberry Pi, le sens du transceiver suit RTS (mode RS-485 du noyau)
+si --rts-de est donné ; sinon le transceiver doit gérer seul le sens.
+"""
+
+import argparse
+import time
+
+import serial
+
+import stm32_client_v3 as client
+
+BROADCAST = 255                      # RPI_NODE_BROADCAST
+NODE_TIMEOUT_S = 0.05                # réponse d'un nœud absent
+POLL_CMDS = ("GET_ALL", "GET_I2C")
+
+
+def configure_rs485(ser):
+    """Sens du transceiver piloté par RTS, basculé par le pilote série."""
+    import serial.rs485
+    ser.rs485_mode = serial.rs485.RS485Settings(rts_level_for_tx=True,
+                                                rts_level_for_rx=False)
+
+
+def broadcast(ser, cmd: str):
+    """Commande exécutée par tous les nœuds, sans réponse (ex: SET_K=...)."""
+    ser.write(f"@{BROADCAST}:{cmd}\r\n".encode("ascii"))
+    ser.flush()
+
+
+def poll_node(ser, node: int, cmds=POLL_CMDS, timeout: float = NODE_TIMEOUT_S) -> dict:
+    """
+    Envoie toutes les requêtes d'un nœud d'un coup et collecte les réponses
+    par tag. Retourne {commande: réponse} ; les commandes sans réponse
+    sont absentes.
+    """
+    prefix = f"@{node}:"
+    ser.reset_input_buffer()
+    ser.write("".join(f"{prefix}#{tag}:{cmd}\r\n" for tag, cmd in enumerate(cmds)).encode("ascii"))
+    ser.flush()
+
+    out = {}
+    buf = bytearray()
+    deadline = time.monotonic() + timeout
+    while len(out) < len(cmds) and time.monotonic() < deadline:
+        buf += ser.read(ser.in_waiting or 1)
+        while b"\n" in buf:
+            line, _, rest = bytes(buf).partition(b"\n")
+            buf = bytearray(rest)
+            text = line.decode("ascii", errors="ignore").strip()
+            if not text.startswith(prefix + "#"):
+                continue                    # écho ou trafic d'un autre nœud
+            tag, _, resp = text[len(prefix) + 1:].partition(":")
+            if tag.isdigit() and int(tag) < len(cmds):
+                out[cmds[int(tag)]] = resp
+    return out
+
+
+def sweep(ser, nodes, cmds=POLL_CMDS) -> dict:
+    """Un tour du bus : {nœud: {commande: réponse}}."""
+    return {n: poll_node(ser, n, cmds) for n in nodes}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    ap.add_argument("port")
+    ap.add_argument("nodes", type=int, nargs="+")
+    ap.add_argument("--baud", type=int, default=client.BAUDRATE)
+    ap.add_argument("--period", type=float, default=1.0, help="s entre deux tours")
+    ap.add_argument("--rts-de", action="store_true", help="RTS pilote DE du transceiver")
+    args = ap.parse_args()
+
+    with serial.Serial(args.port, args.baud, timeout=NODE_TIMEOUT_S) as ser:
+        if args.rts_de:
+            configure_rs485(ser)
+        missed = {n: 0 for n in args.nodes}
+        try:
+            while True:
+                t0 = time.perf_counter()
+                res = sweep(ser, args.nodes)
+                dt = (time.perf_counter() - t0) * 1e3
+                for n, r in res.items():
+                    if "GET_ALL" not in r:
+                        missed[n] += 1
+                        print(f"  nœud {n:3}: pas de réponse ({missed[n]})")
+                        continue
+                    a = client.parse_all(r["GET_ALL"])
+                    print(f"  nœud {n:3}: seq={a['seq']} T={a['T']:.2f} P={a['P']} "
+                          f"K={a['K']:.2f} I2C={r.get('GET_I2C', '?')}")
+                print(f"tour de {len(args.nodes)} nœuds : {dt:.1f} ms")
+                time.sleep(args.period)
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == "__main__":
+    main()
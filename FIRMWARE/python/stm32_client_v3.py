@@ -5,23 +5,61 @@ TP Bus & Réseaux
 
 Protocole main.c :
   - Commandes envoyées (ASCII, sans \r\n) :
-      "GET_T", "GET_P", "GET_A", "GET_K", "SET_K=1234", ...
+      "GET_T", "GET_P", "GET_A", "GET_K", "SET_K=1234",
+      "SET_F=T,E,3", "GET_F=T", "GET_I2C", "GET_R", "GET_TX", "GET_Q",
+      "CAP_CFG=256,768", "CAP_ARM=CVS", "CAP_TRIG", "CAP_STAT", "CAP_READ=0,8",
+      "GET_ALL", "GET_ALL=TP", "BAUD=921600", "BAUD_OK", "GET_S", "SET_W=T,0,1000", "SUB=TP,100", "UNSUB", "HELP", "HELP=SET_F", ...
+      "PAR_LIST", "PAR_GET=K", "PAR_SET=NODE,3", "PAR_STAT" (réglages en flash)
+      "TIME=<t1>" (synchronisation d'horloge, stm32_time.py)
+      "LOG", "LOG=MPU,E" (niveaux des traces de la console USART2)
+      "TRC" (trace binaire, décodée avec l'ELF par stm32_trace.py)
+      "GET_PERF", "GET_PERF=I2C", "PERF_RST" (profil en cycles, stm32_perf.py)
   - Réponses STM32 (exemples) :
       "T=+12.34_C\r\n"
       "P=101325Pa\r\n"
       "A=125.7000\r\n"
       "K=12.34000\r\n"
-      "ERR=CMD\r\n"
+      "F=T,E,3\r\n"
+      "R=250ms\r\n"
+      "ALL=812,40211345,T2345,P101325,A0,K1234\r\n"   (seq, t_us, unités natives)
+      "D=42,40211345,T2345,P101325\r\n"   (poussé après SUB)
+      "ERR=CMD\r\n"                (nom inconnu)
+      "ERR=ARG\r\n"                (argument absent ou invalide)
+
+  - "MODE=BIN" bascule en trames binaires COBS + CRC16 (stm32_frame.py),
+    utilisées par les fonctions bin_*.
+
+  - "#<tag>:<commande>" -> "#<tag>:<réponse>" : plusieurs requêtes en vol,
+    appariées par tag (classe TaggedLink).
+
+  - "MODE=MODBUS[,adresse]" bascule en esclave Modbus RTU (stm32_modbus.py).
+
+  - "NODE=<adresse>" : bus RS-485 multipoint, "@<adresse>:<commande>"
+    (rs485_poll.py).
 """
 
+import queue
 import serial
+import struct
+import threading
 import time
+from concurrent.futures import Future, TimeoutError as FutureTimeout
+
+import stm32_frame as frame
+import stm32_tlm as tlm
 
 # === Paramètres série ===
 SERIAL_PORT = "/dev/ttyAMA0"   # ⚠️ à adapter : /dev/serial0, /dev/ttyACM0, etc.
-BAUDRATE    = 115200
+BAUDRATE    = 115200           # débit au reset du STM32
 TIMEOUT_S   = 1.0              # délai de lecture en secondes
 
+# Débit négocié à la connexion (BAUD=), None = rester à BAUDRATE.
+# 460800 / 921600 / 2000000 ; RTSCTS si les fils RTS/CTS sont câblés
+# (STM32 : PA12 RTS, PA11 CTS ; Raspberry Pi : GPIO17 RTS, GPIO16 CTS).
+FAST_BAUDRATE   = 921600
+RTSCTS          = False
+BAUD_CONFIRM_S  = 1.0          # RPI_BAUD_CONFIRM_MS côté STM32
+
 
 # --- Fonction générique d’envoi / lecture ligne ---
 def send_command(ser, cmd: str) -> str:
@@ -48,6 +86,10 @@ def send_command(ser, cmd: str) -> str:
             if not b:
                 break
             if b in (b"\r", b"\n"):
+                # Lignes vides et données poussées (SUB) ignorées ici
+                if not buf or buf.startswith(b"D="):
+                    buf.clear()
+                    continue
                 break
             buf += b
         else:
@@ -60,6 +102,43 @@ def send_command(ser, cmd: str) -> str:
     return resp
 
 
+def send_commands(ser, cmds) -> list:
+    """
+    Envoie plusieurs commandes d'un coup (le STM32 les met en file,
+    8 au plus) puis lit une réponse par commande, dans l'ordre.
+    """
+    ser.reset_input_buffer()
+    ser.write("".join(c + "\r\n" for c in cmds).encode("ascii"))
+    ser.flush()
+
+    replies = []
+    deadline = time.time() + TIMEOUT_S * max(1, len(cmds))
+    buf = bytearray()
+    while len(replies) < len(cmds) and time.time() < deadline:
+        data = ser.read(ser.in_waiting or 1)
+        for b in data:
+            if b not in (0x0D, 0x0A):
+                buf.append(b)
+                continue
+            line = buf.decode("ascii", errors="ignore").strip()
+            buf.clear()
+            if line and not line.startswith("D="):
+                replies.append(line)
+    if len(replies) < len(cmds):
+        raise RuntimeError(f"{len(cmds) - len(replies)} réponse(s) manquante(s)")
+    return replies
+
+
+def get_queue_stats(ser) -> dict:
+    """File de commandes du STM32 : profondeur, remplissage max, pertes."""
+    resp = send_command(ser, "GET_Q")
+    if not resp.startswith("Q="):
+        raise RuntimeError(f"Réponse inattendue : {resp!r}")
+    depth, max_used, overflows, too_long = map(int, resp[2:].split(","))
+    return {"depth": depth, "max_used": max_used,
+            "overflows": overflows, "too_long": too_long}
+
+
 # --- Parser générique de valeur d’après le main.c ---
 def _parse_value(resp: str, prefix: str):
     """
@@ -125,6 +204,81 @@ def get_acceleration(ser):
     return _parse_value(resp, "A")
 
 
+def get_rate(ser):
+    """
+    Période d'acquisition courante du STM32 en ms (adaptative : 50..1000).
+    """
+    resp = send_command(ser, "GET_R")
+    return _parse_value(resp, "R")
+
+
+def get_tx_stats(ser) -> dict:
+    """
+    Buffers d'émission DMA du STM32 : remplissage max (octets) et messages
+    rejetés faute de place, pour l'UART Raspberry et l'UART debug.
+    """
+    resp = send_command(ser, "GET_TX")
+    if not resp.startswith("TX="):
+        raise RuntimeError(f"Réponse inattendue : {resp!r}")
+    hw_pi, ovf_pi, hw_dbg, ovf_dbg = map(int, resp[3:].split(","))
+    return {"pi": {"high_water": hw_pi, "overflows": ovf_pi},
+            "debug": {"high_water": hw_dbg, "overflows": ovf_dbg}}
+
+
+LOG_LEVELS = "OEWID"   # off, erreur, avertissement, info, debug
+
+
+def get_log(ser) -> dict:
+    """
+    Traces de debug du STM32 (console USART2, jamais sur ce lien) :
+    niveau par module et compteurs de lignes émises / perdues (buffer
+    plein) / tronquées.
+    """
+    resp = send_command(ser, "LOG")
+    if not resp.startswith("LOG="):
+        raise RuntimeError(f"Réponse inattendue : {resp!r}")
+    levels, counters = resp[4:].split(";")
+    lines, dropped, truncated = map(int, counters.split(","))
+    return {"levels": dict(m.split(":") for m in levels.split(",")),
+            "lines": lines, "dropped": dropped, "truncated": truncated}
+
+
+def set_log_level(ser, module: str, level: str):
+    """Niveau ('O', 'E', 'W', 'I', 'D') d'un module, '*' pour tous."""
+    if level not in LOG_LEVELS:
+        raise ValueError(f"Niveau inconnu : {level!r}")
+    resp = send_command(ser, f"LOG={module},{level}")
+    if not resp.startswith("LOG="):
+        raise RuntimeError(f"LOG refusé : {resp!r}")
+
+
+# Unités natives du firmware -> unités physiques
+_ALL_SCALE = {"T": 100.0, "P": 1, "A": 1000.0, "K": 100.0}
+
+
+def get_all(ser, values: str = "TPAK") -> dict:
+    """
+    Lit T, P, A et K en un seul aller-retour, issus du même échantillon :
+    "ALL=<seq>,<t_us>,T2345,P101325,A0,K1234".
+    Retourne {'seq': .., 't_us': .., 'T': 23.45, 'P': 101325, ...} ; t_us
+    (horloge STM32, 32 bits) -> heure murale : stm32_time.ClockSync.
+    """
+    cmd = "GET_ALL" if values == "TPAK" else f"GET_ALL={values}"
+    return parse_all(send_command(ser, cmd))
+
+
+def parse_all(resp: str) -> dict:
+    """Décode une réponse "ALL=..." (sans préfixe d'adresse ni tag)."""
+    if not resp.startswith("ALL="):
+        raise RuntimeError(f"Réponse inattendue : {resp!r}")
+    fields = resp[4:].split(",")
+    out = {"seq": int(fields[0]), "t_us": int(fields[1])}
+    for f in fields[2:]:
+        scale = _ALL_SCALE[f[0]]
+        out[f[0]] = int(f[1:]) / scale if scale != 1 else int(f[1:])
+    return out
+
+
 def get_K(ser):
     resp = send_command(ser, "GET_K")
     return _parse_value(resp, "K")
@@ -139,8 +293,511 @@ def set_K(ser, k_centi: int):
     return resp  # typiquement "SET_K=OK" ou "ERR=CMD"
 
 
-def get_help(ser) -> str:
-    return send_command(ser, "HELP")
+# --- Paramètres enregistrés en flash (PAR_*) ---
+def param_list(ser) -> dict:
+    """
+    Registre des paramètres persistants :
+    {'K': {'value': 500, 'min': 0, 'max': 100000, 'default': 500}, ...}
+    (valeurs entières, unités natives du firmware).
+    """
+    resp = send_command(ser, "PAR_LIST")
+    if not resp.startswith("PAR="):
+        raise RuntimeError(f"Réponse inattendue : {resp!r}")
+    out = {}
+    for entry in resp[4:].split(";"):
+        name, value, vmin, vmax, default = entry.split(",")
+        out[name] = {"value": int(value), "min": int(vmin),
+                     "max": int(vmax), "default": int(default)}
+    return out
+
+
+def param_get(ser, name: str) -> int:
+    resp = send_command(ser, f"PAR_GET={name}")
+    if not resp.startswith(f"PAR={name},"):
+        raise RuntimeError(f"Réponse inattendue : {resp!r}")
+    return int(resp.split(",")[1])
+
+
+def param_set(ser, name: str, value: int):
+    """Change et enregistre un paramètre (ERR=FLASH : appliqué, non enregistré)."""
+    resp = send_command(ser, f"PAR_SET={name},{value}")
+    if resp != "PAR_SET=OK":
+        raise RuntimeError(f"PAR_SET refusé : {resp!r}")
+
+
+def param_stats(ser) -> dict:
+    """EEPROM émulée : page active, recopies, remplissage, erreurs."""
+    resp = send_command(ser, "PAR_STAT")
+    if not resp.startswith("PAR_STAT="):
+        raise RuntimeError(f"Réponse inattendue : {resp!r}")
+    page, gen, used, cap, crc, erases = map(int, resp[9:].split(","))
+    return {"page": page, "generation": gen, "used": used, "capacity": cap,
+            "crc_errors": crc, "erases": erases}
+
+
+def set_filter(ser, channel: str, ftype: str, param: int):
+    """
+    Filtre d'un canal ('T', 'P', 'A') :
+      ftype = 'N' (aucun), 'E' (EMA, alpha = 1/2^param),
+              'M' (moyenne sur param échantillons), 'D' (médiane sur param)
+    """
+    return send_command(ser, f"SET_F={channel},{ftype},{param}")
+
+
+def get_filter(ser, channel: str):
+    """
+    Retourne (type, param) du filtre d'un canal, ex: ('E', 2).
+    """
+    resp = send_command(ser, f"GET_F={channel}")
+    if not resp.startswith("F="):
+        raise RuntimeError(f"Réponse inattendue : {resp!r}")
+    _, ftype, param = resp[2:].split(",")
+    return ftype, int(param)
+
+
+# === Statistiques par fenêtre (min / max / moyenne / variance) ===
+
+STATS_FIELDS = ("window_ms", "seq", "count", "min", "max", "mean", "var", "std", "end_tick_ms")
+
+
+def set_stats_window(ser, channel: str, slot: int, window_ms: int):
+    """
+    Longueur de la fenêtre `slot` (0 ou 1) d'un canal ('T', 'P', 'A'),
+    de 100 ms à 1 h. Par défaut : slot 0 = 1 s, slot 1 = 1 min.
+    """
+    return send_command(ser, f"SET_W={channel},{slot},{window_ms}")
+
+
+def get_stats(ser) -> dict:
+    """
+    Dernières fenêtres terminées de tous les canaux, en une seule requête.
+    Retourne {('T', 0): {...}, ('T', 1): {...}, ...} en unités du canal
+    (T en 0.01 °C, P en Pa, A en 0.001°). seq == 0 : pas encore de fenêtre ;
+    seq change à chaque nouvelle fenêtre.
+    """
+    resp = send_command(ser, "GET_S")
+    if not resp.startswith("S="):
+        raise RuntimeError(f"Réponse inattendue : {resp!r}")
+    stats = {}
+    for entry in resp[2:].split(";"):
+        key, values = entry.split(":")
+        stats[(key[0], int(key[1:]))] = dict(zip(STATS_FIELDS, map(int, values.split(","))))
+    return stats
+
+
+# === Capture IMU 1 kHz (façon oscilloscope) ===
+
+CAPTURE_READ_CHUNK = 8   # échantillons max par CAP_READ
+
+
+def capture_config(ser, pre: int, post: int):
+    """Taille des fenêtres avant / après déclenchement (pre + post <= 1024)."""
+    return send_command(ser, f"CAP_CFG={pre},{post}")
+
+
+def capture_threshold(ser, axis: int, level: int, edge: str = "B"):
+    """
+    Déclenchement sur seuil : axis 0..5 = ax, ay, az, gx, gy, gz (LSB bruts),
+    edge = 'R' (montant), 'F' (descendant), 'B' (les deux).
+    """
+    return send_command(ser, f"CAP_THR={axis},{level},{edge}")
+
+
+def capture_arm(ser, sources: str = "CVS"):
+    """
+    Arme la capture. sources : C = commande CAP_TRIG, V = commande vanne (CAN),
+    S = seuil.
+    """
+    return send_command(ser, f"CAP_ARM={sources}")
+
+
+def capture_trigger(ser):
+    return send_command(ser, "CAP_TRIG")
+
+
+def capture_status(ser) -> dict:
+    """
+    Retourne l'état de la capture :
+      state : 'I' (arrêt), 'A' (armée), 'T' (déclenchée), 'D' (terminée)
+              'E' (FIFO perdue après le déclenchement, à réarmer)
+    """
+    resp = send_command(ser, "CAP_STAT")
+    if not resp.startswith("CAP="):
+        raise RuntimeError(f"Réponse inattendue : {resp!r}")
+    state, src, pre, total, t_us, ovf = resp[4:].split(",")
+    return {
+        "state": state, "source": src, "pre": int(pre), "total": int(total),
+        "trigger_us": int(t_us), "overflows": int(ovf),
+    }
+
+
+def _decode_capture_hex(hex_str: str):
+    samples = []
+    for i in range(0, len(hex_str), 24):
+        raw = bytes.fromhex(hex_str[i:i + 24])
+        axes = [int.from_bytes(raw[j:j + 2], "big", signed=True) for j in range(0, 12, 2)]
+        samples.append(tuple(axes))
+    return samples
+
+
+def capture_download(ser):
+    """
+    Télécharge une capture terminée.
+    Retourne (pre, [(ax, ay, az, gx, gy, gz), ...]) ; l'échantillon d'indice
+    `pre` est celui du déclenchement, période 1 ms.
+    """
+    st = capture_status(ser)
+    if st["state"] != "D":
+        raise RuntimeError(f"Capture non terminée (état {st['state']!r})")
+
+    samples = []
+    k = 0
+    while k < st["total"]:
+        n = min(CAPTURE_READ_CHUNK, st["total"] - k)
+        resp = send_command(ser, f"CAP_READ={k},{n}")
+        if not resp.startswith(f"C={k}:"):
+            raise RuntimeError(f"Réponse inattendue : {resp!r}")
+        chunk = _decode_capture_hex(resp.split(":", 1)[1])
+        if not chunk:
+            break
+        samples.extend(chunk)
+        k += len(chunk)
+    return st["pre"], samples
+
+
+# === Abonnement (flux poussé par le STM32) ===
+
+def subscribe(ser, channels: str = "TPA", period_ms: int = 100):
+    """
+    Le STM32 pousse "D=<seq>,<t_us>,T2345,P101325,A0" toutes les period_ms
+    (10..60000), ou à chaque changement de valeur si period_ms = 0.
+    Valeurs en unités natives : T en 0.01 °C, P en Pa, A en 0.001°.
+    """
+    return send_command(ser, f"SUB={channels},{period_ms}")
+
+
+def unsubscribe(ser):
+    return send_command(ser, "UNSUB")
+
+
+def _parse_data_line(line: str):
+    """ "D=42,40211345,T2345,P101325" -> (42, 40211345, {'T': 2345, 'P': 101325}) """
+    fields = line[2:].split(",")
+    return int(fields[0]), int(fields[1]), {f[0]: int(f[1:]) for f in fields[2:]}
+
+
+def stream(ser):
+    """
+    Générateur sur les lignes poussées : (seq, t_us, {'T': 2345, ...}, perdues)
+    où `perdues` est le nombre de messages manquants détectés par le seq.
+    """
+    expected = None
+    buf = bytearray()
+    while True:
+        data = ser.read(ser.in_waiting or 1)
+        for b in data:
+            if b not in (0x0D, 0x0A):
+                buf.append(b)
+                continue
+            line = buf.decode("ascii", errors="ignore")
+            buf.clear()
+            if not line.startswith("D="):
+                continue
+            seq, t_us, values = _parse_data_line(line)
+            lost = 0 if expected is None else (seq - expected) & 0xFFFFFFFF
+            expected = (seq + 1) & 0xFFFFFFFF
+            yield seq, t_us, values, lost
+
+
+# === Mode binaire (trames COBS + CRC16) ===
+
+def send_frame(ser, cmd_id: int, payload: bytes = b"") -> bytes:
+    """
+    Envoie une trame binaire et attend la réponse de même id.
+    Retourne le payload ; lève RuntimeError sur réponse d'erreur ou timeout.
+    """
+    ser.reset_input_buffer()
+    ser.write(frame.encode_frame(cmd_id, payload))
+    ser.flush()
+
+    reader = frame.FrameReader()
+    deadline = time.time() + TIMEOUT_S
+    while time.time() < deadline:
+        data = ser.read(ser.in_waiting or 1)
+        for rid, rpayload in reader.feed(data):
+            if rid == cmd_id:
+                return rpayload
+            if rid in (cmd_id | frame.ERR_FLAG, frame.ERR_FLAG):
+                raise RuntimeError(f"Erreur STM32 {rpayload[0] if rpayload else '?'} (cmd 0x{cmd_id:02X})")
+    raise RuntimeError(f"Timeout trame binaire (cmd 0x{cmd_id:02X})")
+
+
+def set_binary_mode(ser):
+    resp = send_command(ser, "MODE=BIN")
+    if resp != "MODE=BIN":
+        raise RuntimeError(f"Réponse inattendue : {resp!r}")
+
+
+def set_ascii_mode(ser):
+    send_frame(ser, frame.CMD_MODE_ASCII)
+
+
+def bin_get_temperature(ser) -> float:
+    (t,) = struct.unpack("<i", send_frame(ser, frame.CMD_GET_T))
+    return t / 100.0
+
+
+def bin_get_pressure(ser) -> int:
+    (p,) = struct.unpack("<I", send_frame(ser, frame.CMD_GET_P))
+    return p
+
+
+def bin_get_angle(ser) -> float:
+    (a,) = struct.unpack("<i", send_frame(ser, frame.CMD_GET_A))
+    return a / 1000.0
+
+
+def bin_get_K(ser) -> float:
+    (k,) = struct.unpack("<i", send_frame(ser, frame.CMD_GET_K))
+    return k / 100.0
+
+
+def bin_set_K(ser, k_centi: int):
+    send_frame(ser, frame.CMD_SET_K, struct.pack("<i", k_centi))
+
+
+def bin_get_rate(ser) -> int:
+    (r,) = struct.unpack("<I", send_frame(ser, frame.CMD_GET_R))
+    return r
+
+
+def bin_get_all(ser, values: str = "TPAK") -> dict:
+    """Équivalent binaire de get_all (trame CMD_GET_ALL)."""
+    mask = sum(1 << "TPAK".index(c) for c in values)
+    payload = send_frame(ser, frame.CMD_GET_ALL, bytes((mask,)))
+    seq, t_us, *raw = struct.unpack(f"<II{len(values)}i", payload)
+    out = {"seq": seq, "t_us": t_us}
+    for c, v in zip("".join(c for c in "TPAK" if c in values), raw):
+        scale = _ALL_SCALE[c]
+        out[c] = v / scale if scale != 1 else v
+    return out
+
+
+def bin_subscribe(ser, channels: str = "TPA", period_ms: int = 100, batch: int = 0):
+    """
+    batch = 0 : une trame MSG_DATA par échantillon ; 1..16 : échantillons
+    groupés et compressés dans MSG_DATA_Z (stm32_tlm.py).
+    """
+    mask = sum(1 << "TPA".index(c) for c in channels)
+    payload = struct.pack("<BI", mask, period_ms)
+    if batch:
+        payload += bytes((batch,))
+    send_frame(ser, frame.CMD_SUB, payload)
+
+
+def bin_unsubscribe(ser):
+    send_frame(ser, frame.CMD_UNSUB)
+
+
+def bin_decode_data(payload: bytes, channels: str = "TPA"):
+    """Payload MSG_DATA -> (seq, t_us, {'T': 2345, ...}) ; channels dans l'ordre T, P, A."""
+    seq, t_us, *values = struct.unpack(f"<II{len(channels)}i", payload)
+    return seq, t_us, dict(zip(channels, values))
+
+
+def negotiate_baud(ser, baud: int, rtscts: bool = False) -> int:
+    """
+    Passe le lien au débit `baud` :
+      1. "BAUD=<baud>[,H]" à l'ancien débit -> "BAUD=<baud>,<débit réel>"
+      2. bascule du port local, puis "BAUD_OK" au nouveau débit
+    Sans réponse à BAUD_OK, le STM32 revient seul à l'ancien débit après
+    BAUD_CONFIRM_S : on en fait autant. Retourne le débit en service.
+    """
+    old_baud, old_rtscts = ser.baudrate, ser.rtscts
+
+    resp = send_command(ser, f"BAUD={baud}" + (",H" if rtscts else ""))
+    if not resp.startswith(f"BAUD={baud},"):
+        raise RuntimeError(f"Débit {baud} refusé : {resp!r}")
+
+    ser.baudrate = baud
+    ser.rtscts = rtscts
+    time.sleep(0.01)   # bascule du STM32
+
+    try:
+        resp = send_command(ser, "BAUD_OK")
+    except Exception:
+        resp = ""
+    if resp.startswith("BAUD_OK="):
+        return baud
+
+    # Echec : retour à l'ancien débit des deux côtés
+    ser.baudrate, ser.rtscts = old_baud, old_rtscts
+    time.sleep(BAUD_CONFIRM_S + 0.1)
+    ser.reset_input_buffer()
+    return old_baud
+
+
+def get_help(ser, cmd: str = None):
+    """
+    Sans argument : liste des commandes du STM32 (table du firmware).
+    Avec cmd : "<cmd>=<argument> : <aide>".
+    """
+    if cmd is None:
+        resp = send_command(ser, "HELP")
+        if not resp.startswith("HELP="):
+            raise RuntimeError(f"Réponse inattendue: {resp!r}")
+        return resp[5:].split(",")
+    return send_command(ser, "HELP=" + cmd)
+
+
+# === Requêtes étiquetées : plusieurs commandes en vol ===
+
+class TaggedLink:
+    """
+    Un thread lit le port en continu ; chaque requête porte un tag
+    ("#<tag>:CMD" en ASCII, enveloppe CMD_TAG en binaire) et sa réponse est
+    remise à l'appelant qui attend ce tag, quel que soit l'ordre d'arrivée.
+    Rien n'est jeté :
+      - données poussées (D=..., MSG_DATA) -> file `data` : (seq, t_us, {...})
+      - lignes / trames sans tag (debug, boot) -> file `unsolicited`
+
+        link = TaggedLink(ser)
+        futs = [link.submit(c) for c in ("GET_T", "GET_P", "GET_ALL")]
+        print([f.result() for f in futs])
+        link.close()
+
+    En binaire (après set_binary_mode), submit prend un id CMD_* et un
+    payload, et la réponse est le payload (RuntimeError si erreur STM32).
+    """
+
+    MAX_IN_FLIGHT = 8   # cases de la file de commandes du STM32 (rpi_cmdq.h)
+
+    def __init__(self, ser, binary: bool = False, channels: str = "TPA"):
+        self.ser = ser
+        self.binary = binary
+        self.channels = channels          # canaux abonnés (décodage MSG_DATA)
+        self._z_prev = None               # dernier enregistrement MSG_DATA_Z
+        self._z_next = None               # seq attendu de la trame suivante
+        self.data = queue.Queue()
+        self.unsolicited = queue.Queue()
+        self._lock = threading.Lock()
+        self._slots = threading.BoundedSemaphore(self.MAX_IN_FLIGHT)
+        self._pending = {}
+        self._next_tag = 0
+        self._running = True
+        ser.reset_input_buffer()
+        self._thread = threading.Thread(target=self._reader, daemon=True)
+        self._thread.start()
+
+    # --- Côté appelant ---
+
+    def submit(self, cmd, payload: bytes = b"", timeout: float = TIMEOUT_S) -> Future:
+        """Envoie sans attendre ; la Future donne la réponse (sans le tag)."""
+        if not self._slots.acquire(timeout=timeout):
+            raise RuntimeError("Trop de requêtes en vol")
+        fut = Future()
+        fut.add_done_callback(lambda _: self._slots.release())
+
+        with self._lock:
+            tag = self._next_tag
+            while tag in self._pending:
+                tag = (tag + 1) & 0xFFFF
+            self._next_tag = (tag + 1) & 0xFFFF
+            fut.tag = tag
+            self._pending[tag] = fut
+
+            if self.binary:
+                msg = frame.encode_frame(frame.CMD_TAG, struct.pack("<HB", tag, cmd) + payload)
+            else:
+                msg = f"#{tag}:{cmd}\r\n".encode("ascii")
+            self.ser.write(msg)
+        return fut
+
+    def request(self, cmd, payload: bytes = b"", timeout: float = TIMEOUT_S):
+        """submit() puis attente de la réponse."""
+        fut = self.submit(cmd, payload, timeout)
+        try:
+            return fut.result(timeout)
+        except FutureTimeout:
+            self._resolve(fut.tag, error=RuntimeError(f"Timeout ({cmd!r})"))
+            raise RuntimeError(f"Timeout ({cmd!r})")
+
+    def close(self):
+        self._running = False
+        self._thread.join(TIMEOUT_S * 2)
+
+    # --- Thread de lecture ---
+
+    def _resolve(self, tag: int, result=None, error=None):
+        with self._lock:
+            fut = self._pending.pop(tag, None)
+        if fut is None:
+            return False   # tag inconnu ou requête déjà abandonnée
+        if error is not None:
+            fut.set_exception(error)
+        else:
+            fut.set_result(result)
+        return True
+
+    def _on_line(self, line: str):
+        if line.startswith("#"):
+            head, sep, body = line.partition(":")
+            if sep and head[1:].isdigit() and self._resolve(int(head[1:]), body):
+                return
+        if line.startswith("D="):
+            self.data.put(_parse_data_line(line))
+        else:
+            self.unsolicited.put(line)
+
+    def _on_frame(self, fid: int, payload: bytes):
+        if fid == frame.CMD_TAG and len(payload) >= 3:
+            tag, rid = struct.unpack_from("<HB", payload)
+            if rid & frame.ERR_FLAG:
+                code = payload[3] if len(payload) > 3 else "?"
+                self._resolve(tag, error=RuntimeError(f"Erreur STM32 {code} (cmd 0x{rid & 0x7F:02X})"))
+            else:
+                self._resolve(tag, payload[3:])
+        elif fid == frame.MSG_DATA:
+            self.data.put(bin_decode_data(payload, self.channels))
+        elif fid == frame.MSG_DATA_Z:
+            # Trame delta après une perte (trou dans seq) : ignorée jusqu'à
+            # la clé suivante
+            try:
+                seq, _ = tlm.get_varint(payload, 1)
+                if seq != self._z_next:
+                    self._z_prev = None
+                # t_us en premier canal de chaque enregistrement
+                seq, recs = tlm.decode_payload(payload, len(self.channels) + 1, self._z_prev)
+            except tlm.TelemetryError:
+                return
+            for i, rec in enumerate(recs):
+                self.data.put((seq + i, rec[0] & 0xFFFFFFFF, dict(zip(self.channels, rec[1:]))))
+            if recs:
+                self._z_prev = recs[-1]
+                self._z_next = seq + len(recs)
+        else:
+            self.unsolicited.put((fid, payload))
+
+    def _reader(self):
+        buf = bytearray()
+        frames = frame.FrameReader()
+        while self._running:
+            try:
+                data = self.ser.read(self.ser.in_waiting or 1)
+            except Exception as e:   # port fermé / débranché
+                for tag in list(self._pending):
+                    self._resolve(tag, error=RuntimeError(f"Lien perdu : {e}"))
+                return
+            if self.binary:
+                for fid, payload in frames.feed(data):
+                    self._on_frame(fid, payload)
+                continue
+            for b in data:
+                if b not in (0x0D, 0x0A):
+                    buf.append(b)
+                elif buf:
+                    self._on_line(buf.decode("ascii", errors="ignore"))
+                    buf.clear()
 
 
 # === Petit mode sniff au démarrage ===
@@ -148,7 +805,9 @@ def get_help(ser) -> str:
 def sniff_boot(ser, duration=2.0):
     """
     Pendant `duration` secondes, lit tout ce qui arrive sur le port
-    et l'affiche (permet de voir '=== Protocole UART1 pret (Raspberry Pi) ===').
+    et l'affiche. Les traces de démarrage du STM32 ne passent que par la
+    console USART2 (ST-LINK) : rien ne doit arriver ici avant la première
+    commande, sinon le lien est pollué (mauvais débit, autre émetteur).
     """
     print(f"Sniff boot ({duration}s)...")
     start = time.time()
@@ -169,7 +828,7 @@ def sniff_boot(ser, duration=2.0):
 # === Programme principal ===
 
 def main():
-    # Ouverture du port série
+    # Ouverture du port série (débit du reset)
     ser = serial.Serial(
         port=SERIAL_PORT,
         baudrate=BAUDRATE,
@@ -179,8 +838,21 @@ def main():
     print(f"Connecté sur {SERIAL_PORT} à {BAUDRATE} bauds")
     print("Ctrl+C pour quitter.\n")
 
-    # 1) On sniffe au démarrage pour vérifier qu’on voit le boot STM32
-    sniff_boot(ser, duration=3.0)
+    # 1) Lien silencieux au repos, puis le protocole doit répondre
+    sniff_boot(ser, duration=1.0)
+    try:
+        print("HELP :", ", ".join(get_help(ser)), "\n")
+    except RuntimeError as e:
+        print("Pas de réponse du protocole :", e, "\n")
+
+    # 2) Puis on monte le débit si demandé
+    if FAST_BAUDRATE:
+        try:
+            baud = negotiate_baud(ser, FAST_BAUDRATE, RTSCTS)
+        except RuntimeError as e:
+            print("Négociation de débit :", e)
+            baud = BAUDRATE
+        print(f"Débit du lien : {baud} bauds{' (RTS/CTS)' if ser.rtscts else ''}\n")
 
     try:
         while True:
@@ -190,6 +862,7 @@ def main():
             print("3) Lire accélération")
             print("4) Lire K (GET_K)")
             print("5) SET_K (ex: 1234 -> 12.34)")
+            print("6) Tout lire (GET_ALL)")
             print("h) HELP")
             print("q) Quitter")
             choice = input("> ").strip()
@@ -212,8 +885,12 @@ def main():
                     k_centi = int(val)
                     resp = set_K(ser, k_centi)
                     print("Réponse SET_K :", resp)
+                elif choice == "6":
+                    snap = get_all(ser)
+                    print(f"Echantillon {snap['seq']} @ {snap['t_us']} us : "
+                          f"T={snap['T']} P={snap['P']} A={snap['A']} K={snap['K']}")
                 elif choice.lower() == "h":
-                    print("HELP :", get_help(ser))
+                    print("HELP :", ", ".join(get_help(ser)))
                 elif choice.lower() == "q":
                     break
                 else:
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""
+Codec des trames binaires STM32 (voir COM_drivers/rpi/rpi_frame.h)
+
+  COBS( id | len | payload[len] | crc16_lo | crc16_hi )  0x00
+
+  - crc16 : CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) sur id, len, payload
+  - payload : entiers little-endian
+  - réponse en erreur : id | 0x80, payload = 1 octet (ERR_*)
+"""
+
+import binascii
+import struct
+
+# === Identifiants de commande (rpi_bin_cmd_t) ===
+CMD_GET_T      = 0x01
+CMD_GET_P      = 0x02
+CMD_GET_A      = 0x03
+CMD_GET_K      = 0x04
+CMD_SET_K      = 0x05
+CMD_GET_R      = 0x06
+CMD_SUB        = 0x07
+CMD_UNSUB      = 0x08
+CMD_GET_ALL    = 0x09   # [masque T,P,A,K] -> seq, t_us, valeurs
+CMD_TIME       = 0x0A   # uint64 t1 -> uint64 t1, t2, t3 (stm32_time.py)
+MSG_DATA       = 0x10   # poussé par le STM32 après CMD_SUB : seq, t_us, valeurs
+MSG_DATA_Z     = 0x11   # idem, compressé (stm32_tlm.py) : CMD_SUB avec lot > 0
+CMD_TAG        = 0x7E   # enveloppe : uint16 tag, id, payload (réponse idem)
+CMD_MODE_ASCII = 0x7F
+
+ERR_FLAG = 0x80
+ERR_CMD  = 1
+ERR_ARG  = 2
+ERR_CRC  = 3
+ERR_FLASH = 4   # valeur appliquée mais non enregistrée
+
+PAYLOAD_MAX = 48
+
+
+class FrameError(Exception):
+    pass
+
+
+def crc16(data: bytes) -> int:
+    # crc_hqx = CRC-16/CCITT, implémenté en C dans la bibliothèque standard
+    return binascii.crc_hqx(data, 0xFFFF)
+
+
+def cobs_encode(data: bytes) -> bytes:
+    out = bytearray()
+    for block in data.split(b"\x00"):
+        # Blocs de 254 octets non nuls au plus
+        while len(block) >= 254:
+            out.append(255)
+            out += block[:254]
+            block = block[254:]
+        out.append(len(block) + 1)
+        out += block
+    return bytes(out)
+
+
+def cobs_decode(data: bytes) -> bytes:
+    out = bytearray()
+    i = 0
+    n = len(data)
+    while i < n:
+        code = data[i]
+        end = i + code
+        if code == 0 or end > n:
+            raise FrameError("COBS invalide")
+        out += data[i + 1:end]
+        i = end
+        if code != 0xFF and i < n:
+            out.append(0)
+    return bytes(out)
+
+
+def encode_frame(cmd_id: int, payload: bytes = b"") -> bytes:
+    """Trame complète, délimiteur 0x00 compris."""
+    if len(payload) > PAYLOAD_MAX:
+        raise FrameError("payload trop long")
+    raw = bytes((cmd_id, len(payload))) + payload
+    raw += struct.pack("<H", crc16(raw))
+    return cobs_encode(raw) + b"\x00"
+
+
+def decode_frame(data: bytes):
+    """
+    Décode une trame (sans le 0x00 final). Retourne (id, payload).
+    Lève FrameError si COBS / longueur / CRC invalide.
+    """
+    raw = cobs_decode(data)
+    if len(raw) < 4 or len(raw) != 4 + raw[1]:
+        raise FrameError("longueur invalide")
+    (crc,) = struct.unpack_from("<H", raw, len(raw) - 2)
+    if crc16(raw[:-2]) != crc:
+        raise FrameError("CRC invalide")
+    return raw[0], raw[2:-2]
+
+
+class FrameReader:
+    """
+    Découpe un flux d'octets en trames (délimiteur 0x00).
+    Les trames corrompues (ex: printf de debug mélangé au flux) sont ignorées
+    et comptées dans `errors`.
+    """
+
+    def __init__(self):
+        self._buf = bytearray()
+        self.errors = 0
+
+    def feed(self, data: bytes):
+        frames = []
+        for b in data:
+            if b != 0:
+                self._buf.append(b)
+                continue
+            if self._buf:
+                try:
+                    frames.append(decode_frame(bytes(self._buf)))
+                except FrameError:
+                    self.errors += 1
+                self._buf.clear()
+        return frames
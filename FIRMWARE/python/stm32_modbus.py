@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+"""
+Maître Modbus RTU pour le STM32 (voir COM_drivers/rpi/rpi_modbus.h)
+
+  adresse | fonction | données | crc16_lo | crc16_hi
+
+  - crc16 : CRC-16/MODBUS (poly 0xA001 réfléchi, init 0xFFFF)
+  - registres 16 bits big-endian ; valeurs 32 bits sur deux registres,
+    mot de poids fort en premier
+  - "MODE=MODBUS[,adresse]" (ASCII) passe le STM32 en esclave RTU,
+    l'écriture de 0 dans HR_MODE le remet en ASCII
+
+  python3 stm32_modbus.py [/dev/ttyAMA0]   # lit la télémétrie en boucle
+"""
+
+import struct
+import sys
+import time
+
+import serial
+
+FC_READ_HOLDING = 0x03
+FC_READ_INPUT   = 0x04
+FC_WRITE_SINGLE = 0x06
+FC_WRITE_MULTI  = 0x10
+
+ADDR_DEFAULT = 1
+
+# === Registres d'entrée (rpi_mb_input_reg_t), tous int32 / uint32 ===
+# (nom, signé, échelle)
+INPUT_REGS = (
+    ("T",            True,  100.0),    # °C
+    ("P",            False, 1),        # Pa
+    ("A",            True,  1000.0),   # °
+    ("period_ms",    False, 1),
+    ("seq",          False, 1),
+    ("t_us",         False, 1),    # horodatage (stm32_time.py)
+    ("i2c_bmp_fail", False, 1),
+    ("i2c_imu_fail", False, 1),
+    ("i2c_recover",  False, 1),
+    ("tx_overflow",  False, 1),
+    ("cmdq_lost",    False, 1),
+    ("mb_frames",    False, 1),
+    ("mb_crc",       False, 1),
+    ("mb_except",    False, 1),
+)
+IR_COUNT = 2 * len(INPUT_REGS)
+
+# === Registres de maintien (rpi_mb_holding_reg_t) ===
+HR_K        = 0    # int32, K x100
+HR_CTRL_REF = 2    # int32, consigne de température en 0.01 °C
+HR_ADDR     = 4
+HR_MODE     = 5    # 0 = retour en ASCII
+HR_COUNT    = 6
+
+EXCEPTIONS = {1: "fonction", 2: "adresse", 3: "valeur", 4: "esclave"}
+
+# Au-delà de 19200 bauds : silence de fin de trame fixé à 1750 µs
+T35_S = 0.00175
+
+
+class ModbusError(Exception):
+    pass
+
+
+_CRC_TABLE = []
+for _i in range(256):
+    _c = _i
+    for _ in range(8):
+        _c = (_c >> 1) ^ 0xA001 if _c & 1 else _c >> 1
+    _CRC_TABLE.append(_c)
+
+
+def crc16(data: bytes) -> int:
+    crc = 0xFFFF
+    for b in data:
+        crc = (crc >> 8) ^ _CRC_TABLE[(crc ^ b) & 0xFF]
+    return crc
+
+
+def build_adu(addr: int, fc: int, data: bytes) -> bytes:
+    adu = bytes((addr, fc)) + data
+    return adu + struct.pack("<H", crc16(adu))
+
+
+def transact(ser, addr: int, fc: int, data: bytes, rsp_len: int) -> bytes:
+    """
+    Envoie une requête et lit la réponse (rsp_len = taille attendue des
+    données, hors adresse, fonction et CRC). Retourne les données.
+    """
+    ser.reset_input_buffer()
+    ser.write(build_adu(addr, fc, data))
+    ser.flush()
+
+    rsp = ser.read(2)
+    if len(rsp) < 2:
+        raise ModbusError(f"Timeout (fonction 0x{fc:02X})")
+    # Exception : fonction | 0x80, un octet de code
+    rsp += ser.read((1 if rsp[1] & 0x80 else rsp_len) + 2)
+
+    if len(rsp) < 5 or crc16(rsp[:-2]) != struct.unpack("<H", rsp[-2:])[0]:
+        raise ModbusError(f"Réponse corrompue : {rsp.hex()}")
+    if rsp[0] != addr:
+        raise ModbusError(f"Adresse inattendue : {rsp[0]}")
+    if rsp[1] == fc | 0x80:
+        raise ModbusError(f"Exception {rsp[2]} ({EXCEPTIONS.get(rsp[2], '?')})")
+    if rsp[1] != fc or len(rsp) != rsp_len + 4:
+        raise ModbusError(f"Réponse inattendue : {rsp.hex()}")
+
+    # Silence avant la requête suivante
+    time.sleep(T35_S)
+    return rsp[2:-2]
+
+
+def read_registers(ser, start: int, count: int, fc: int = FC_READ_INPUT,
+                   addr: int = ADDR_DEFAULT) -> list:
+    data = transact(ser, addr, fc, struct.pack(">HH", start, count), 1 + 2 * count)
+    if data[0] != 2 * count:
+        raise ModbusError("Nombre d'octets inattendu")
+    return list(struct.unpack(f">{count}H", data[1:]))
+
+
+def write_register(ser, reg: int, value: int, addr: int = ADDR_DEFAULT):
+    transact(ser, addr, FC_WRITE_SINGLE, struct.pack(">HH", reg, value & 0xFFFF), 4)
+
+
+def write_registers(ser, start: int, values, addr: int = ADDR_DEFAULT):
+    values = [v & 0xFFFF for v in values]
+    data = struct.pack(f">HHB{len(values)}H", start, len(values), 2 * len(values), *values)
+    transact(ser, addr, FC_WRITE_MULTI, data, 4)
+
+
+def _regs_to_32(regs, signed: bool) -> int:
+    v = (regs[0] << 16) | regs[1]
+    if signed and v & 0x80000000:
+        v -= 1 << 32
+    return v
+
+
+def read_telemetry(ser, addr: int = ADDR_DEFAULT) -> dict:
+    """Bloc d'entrée complet en une seule transaction 0x04."""
+    regs = read_registers(ser, 0, IR_COUNT, FC_READ_INPUT, addr)
+    out = {}
+    for i, (name, signed, scale) in enumerate(INPUT_REGS):
+        v = _regs_to_32(regs[2 * i:2 * i + 2], signed)
+        out[name] = v / scale if scale != 1 else v
+    return out
+
+
+def get_K(ser, addr: int = ADDR_DEFAULT) -> float:
+    regs = read_registers(ser, HR_K, 2, FC_READ_HOLDING, addr)
+    return _regs_to_32(regs, True) / 100.0
+
+
+def set_K(ser, k_centi: int, addr: int = ADDR_DEFAULT):
+    # Les deux mots en une requête : pas de valeur intermédiaire
+    write_registers(ser, HR_K, ((k_centi >> 16) & 0xFFFF, k_centi & 0xFFFF), addr)
+
+
+def set_control_ref(ser, ref_centi: int, addr: int = ADDR_DEFAULT):
+    write_registers(ser, HR_CTRL_REF, ((ref_centi >> 16) & 0xFFFF, ref_centi & 0xFFFF), addr)
+
+
+def enter_modbus(ser, addr: int = ADDR_DEFAULT):
+    """Bascule ASCII -> Modbus RTU (réponse "MODE=MODBUS,<adresse>")."""
+    ser.reset_input_buffer()
+    ser.write(f"MODE=MODBUS,{addr}\r\n".encode("ascii"))
+    ser.flush()
+    resp = ser.readline().decode("ascii", errors="ignore").strip()
+    if resp != f"MODE=MODBUS,{addr}":
+        raise ModbusError(f"Réponse inattendue : {resp!r}")
+    time.sleep(T35_S)
+
+
+def exit_modbus(ser, addr: int = ADDR_DEFAULT):
+    """Retour en ASCII après la réponse à l'écriture de HR_MODE."""
+    write_register(ser, HR_MODE, 0, addr)
+
+
+def main():
+    port = sys.argv[1] if len(sys.argv) > 1 else "/dev/ttyAMA0"
+    with serial.Serial(port, 115200, timeout=0.2) as ser:
+        enter_modbus(ser)
+        try:
+            while True:
+                t0 = time.perf_counter()
+                tm = read_telemetry(ser)
+                dt = (time.perf_counter() - t0) * 1e3
+                print(f"seq={tm['seq']} T={tm['T']:.2f} P={tm['P']} A={tm['A']:.3f} "
+                      f"R={tm['period_ms']}ms  ({dt:.1f} ms)")
+                time.sleep(0.5)
+        except KeyboardInterrupt:
+            pass
+        finally:
+            exit_modbus(ser)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,200 @@
+#!/usr/bin/env python3
+"""
+Profil en cycles CPU du STM32 (COM_drivers/time/perf.h).
+
+  python3 stm32_perf.py /dev/ttyAMA0                       # relevé
+  python3 stm32_perf.py /dev/ttyAMA0 --reset --wait 60 --save v12.json
+  python3 stm32_perf.py --show v12.json
+  python3 stm32_perf.py --diff v12.json v13.json           # deux firmwares
+
+Commandes utilisées :
+  "GET_PERF"          -> "PERF=<Hz CPU>;<sonde>,<n>,<min>,<max>,<moy>;..."
+  "GET_PERF=<sonde>"  -> "PERF=<sonde>,<n>,<min>,<max>,<moy>:<h0>,...,<h23>"
+  "PERF_RST"          -> "PERF_RST=OK"
+Durées en cycles ; la case k de l'histogramme compte les durées de
+[2^k ; 2^(k+1)[ cycles, la dernière tout ce qui dépasse.
+
+--diff compare moyenne, maximum et 99e centile (borne haute de la case)
+de chaque sonde ; une moyenne plus haute de plus de --tolerance sur une
+sonde présente dans les deux relevés -> code de sortie 1.
+"""
+
+import argparse
+import json
+import sys
+import time
+
+TOLERANCE = 0.10
+
+
+# === Réponses GET_PERF ===
+
+def _stats(fields):
+    name, count, cmin, cmax, mean = fields
+    return name, {"count": int(count), "min": int(cmin), "max": int(cmax), "mean": int(mean)}
+
+
+def parse_summary(resp: str):
+    """'PERF=<Hz>;<sonde>,...;...' -> (Hz, {sonde: stats})."""
+    if not resp.startswith("PERF="):
+        raise RuntimeError(f"Réponse inattendue : {resp!r}")
+    hz, *items = resp[5:].split(";")
+    return int(hz), dict(_stats(item.split(",")) for item in items)
+
+
+def parse_probe(resp: str):
+    """'PERF=<sonde>,<n>,<min>,<max>,<moy>:<h0>,...' -> (sonde, stats + hist)."""
+    if not resp.startswith("PERF="):
+        raise RuntimeError(f"Réponse inattendue : {resp!r}")
+    head, _, hist = resp[5:].partition(":")
+    name, st = _stats(head.split(","))
+    st["hist"] = [int(v) for v in hist.split(",")]
+    return name, st
+
+
+def read_perf(ser, reset: bool = False) -> dict:
+    """Relevé complet : résumé puis histogramme de chaque sonde active."""
+    import stm32_client_v3 as client
+
+    hz, probes = parse_summary(client.send_command(ser, "GET_PERF"))
+    for name, st in probes.items():
+        if st["count"] > 0:
+            probes[name] = parse_probe(client.send_command(ser, f"GET_PERF={name}"))[1]
+    if reset:
+        client.send_command(ser, "PERF_RST")
+    return {"hz": hz, "time": time.time(), "probes": probes}
+
+
+# === Affichage ===
+
+def percentile_bound(st: dict, q: float):
+    """Borne haute (cycles) de la case contenant le centile q, plafonnée au
+    maximum mesuré ; None sans histogramme."""
+    hist = st.get("hist", [])
+    total = sum(hist)
+    if total == 0:
+        return None
+    acc = 0
+    for k, n in enumerate(hist):
+        acc += n
+        if acc >= q * total and k < len(hist) - 1:
+            return min(1 << (k + 1), st["max"])
+    return st["max"]
+
+
+def _us(cycles, hz: int) -> str:
+    return "-" if cycles is None else f"{cycles * 1e6 / hz:.1f}"
+
+
+def _bars(hist) -> str:
+    """Histogramme compact : une colonne par case, de la première à la dernière non vide."""
+    used = [k for k, n in enumerate(hist) if n]
+    if not used:
+        return ""
+    top = max(hist)
+    levels = " .:-=+*#"
+    cols = "".join(levels[min(len(levels) - 1, (n * (len(levels) - 1) + top - 1) // top)]
+                   for n in hist[used[0]:used[-1] + 1])
+    return f"2^{used[0]:<2} |{cols}| 2^{used[-1] + 1}"
+
+
+def print_snapshot(snap: dict):
+    hz = snap["hz"]
+    print(f"CPU {hz / 1e6:g} MHz, durées en µs")
+    print(f"{'sonde':10} {'n':>9} {'min':>9} {'moy':>9} {'p99<':>9} {'max':>9}  histogramme (cycles)")
+    for name, st in snap["probes"].items():
+        if st["count"] == 0:
+            continue
+        hist = st.get("hist", [])
+        print(f"{name:10} {st['count']:9d} {_us(st['min'], hz):>9} {_us(st['mean'], hz):>9} "
+              f"{_us(percentile_bound(st, 0.99), hz):>9} {_us(st['max'], hz):>9}  {_bars(hist)}")
+
+
+def _pct(a, b) -> str:
+    if a is None or b is None:
+        return "-"
+    if a == 0:
+        return "=" if b == 0 else "+inf"
+    return f"{(b - a) / a:+.0%}"
+
+
+def diff(a: dict, b: dict, tol: float) -> list:
+    """Affiche l'écart b - a par sonde ; retourne les sondes en régression."""
+    bad = []
+    print(f"{'sonde':10} {'moy A':>9} {'moy B':>9} {'écart':>7} {'p99< A':>9} {'p99< B':>9} "
+          f"{'max A':>9} {'max B':>9}  (µs)")
+    names = list(a["probes"]) + [n for n in b["probes"] if n not in a["probes"]]
+    for name in names:
+        sa, sb = a["probes"].get(name), b["probes"].get(name)
+        if (sa is None or sa["count"] == 0) and (sb is None or sb["count"] == 0):
+            continue
+        if sa is None or sa["count"] == 0 or sb is None or sb["count"] == 0:
+            print(f"{name:10} {'absente de ' + ('A' if sb else 'B'):>27}")
+            continue
+        # Moyennes comparées en temps : les deux firmwares n'ont pas forcément la même horloge
+        ma, mb = sa["mean"] / a["hz"], sb["mean"] / b["hz"]
+        pa = percentile_bound(sa, 0.99)
+        pb = percentile_bound(sb, 0.99)
+        flag = ""
+        if ma > 0 and mb > ma * (1.0 + tol):
+            flag = "  RÉGRESSION"
+            bad.append(name)
+        print(f"{name:10} {_us(sa['mean'], a['hz']):>9} {_us(sb['mean'], b['hz']):>9} "
+              f"{_pct(ma, mb):>7} {_us(pa, a['hz']):>9} {_us(pb, b['hz']):>9} "
+              f"{_us(sa['max'], a['hz']):>9} {_us(sb['max'], b['hz']):>9}{flag}")
+    return bad
+
+
+# === Programme principal ===
+
+def _load(path: str) -> dict:
+    with open(path) as fp:
+        return json.load(fp)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    ap.add_argument("port", nargs="?")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--reset", action="store_true", help="remet le profil à zéro après le relevé")
+    ap.add_argument("--wait", type=float, default=0.0, metavar="S",
+                    help="remet à zéro puis mesure pendant S secondes")
+    ap.add_argument("--save", metavar="JSON")
+    ap.add_argument("--show", metavar="JSON")
+    ap.add_argument("--diff", nargs=2, metavar=("A", "B"))
+    ap.add_argument("--tolerance", type=float, default=TOLERANCE)
+    args = ap.parse_args()
+
+    if args.diff:
+        bad = diff(_load(args.diff[0]), _load(args.diff[1]), args.tolerance)
+        if bad:
+            print(f"moyenne en hausse de plus de {args.tolerance:.0%} : {', '.join(bad)}")
+            sys.exit(1)
+        return
+
+    if args.show:
+        print_snapshot(_load(args.show))
+        return
+
+    if args.port is None:
+        ap.error("port série, --show ou --diff requis")
+
+    import serial
+    import stm32_client_v3 as client
+
+    client.print = lambda *a, **k: None   # trace [DEBUG] de send_command
+    with serial.Serial(args.port, args.baud, timeout=client.TIMEOUT_S) as ser:
+        if args.wait > 0:
+            client.send_command(ser, "PERF_RST")
+            time.sleep(args.wait)
+        snap = read_perf(ser, reset=args.reset)
+
+    print_snapshot(snap)
+    if args.save:
+        with open(args.save, "w") as fp:
+            json.dump(snap, fp, indent=2)
+        print(f"relevé écrit : {args.save}", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
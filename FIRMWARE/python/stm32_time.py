@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""
+Synchronisation d'horloge Raspberry Pi <-> STM32 (voir "TIME=" dans
+COM_drivers/rpi/rpi_protocol.h et COM_drivers/time/timebase.h).
+
+  python3 stm32_time.py /dev/ttyAMA0 --period 1
+
+Échange de type NTP sur la liaison série (µs) :
+  t1  heure du Pi à l'émission de "TIME=<t1>"
+  t2  horloge STM32 à la réception de la commande
+  t3  horloge STM32 à l'émission de la réponse
+  t4  heure du Pi à la réception de "TIME=<t1>,<t2>,<t3>"
+
+  décalage θ = ((t2 - t1) + (t3 - t4)) / 2      (STM32 - Pi)
+  délai    δ = (t4 - t1) - (t3 - t2)
+
+après retrait du temps de sérialisation (10 bits par caractère) : le STM32
+horodate la commande une fois reçue en entier (ligne IDLE, un caractère
+de plus), le Pi la réponse une fois reçue en entier.
+
+Le STM32 ne corrige pas son horloge. ClockSync garde les derniers
+échanges, retient ceux de plus faible délai (les moins retardés par
+l'ordonnanceur du Pi) et ajuste par moindres carrés
+  heure Pi = horloge STM32 + décalage + dérive x (horloge STM32 - ref)
+to_wall() convertit ensuite un horodatage t_us du STM32 (32 bits :
+GET_ALL, D=..., MSG_DATA, CAP_STAT) en heure murale.
+"""
+
+import argparse
+import struct
+import time
+
+import serial
+
+import stm32_client_v3 as client
+import stm32_frame as frame
+
+WINDOW = 32            # échanges conservés
+BEST_FRACTION = 0.5    # part des échanges de plus faible délai retenue
+WRAP32 = 1 << 32
+
+
+def _now_us() -> int:
+    return time.time_ns() // 1000
+
+
+def _char_us(ser) -> float:
+    """Durée d'un caractère sur la ligne (start + 8 bits + stop)."""
+    return 10e6 / ser.baudrate
+
+
+def exchange(ser, timeout: float = client.TIMEOUT_S):
+    """
+    Un échange ASCII. Retourne (t1, t2, t3, t4) corrigés de la
+    sérialisation, ou None sans réponse valide.
+    """
+    ser.reset_input_buffer()
+    t1 = _now_us()
+    req = f"TIME={t1}\r\n".encode("ascii")
+    ser.write(req)
+
+    prefix = f"TIME={t1},".encode("ascii")
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        line = ser.read_until(b"\n")
+        t4 = _now_us()
+        if not line.endswith(b"\n"):
+            return None
+        line = line.strip()
+        if not line.startswith(prefix):
+            continue                     # D=... ou réponse d'un échange abandonné
+        t2, t3 = (int(x) for x in line[len(prefix):].split(b","))
+        c = _char_us(ser)
+        # Bloc DMA livré à la ligne IDLE, un caractère après le '\n'
+        return (t1, t2 - (len(req) + 1) * c, t3, t4 - (len(line) + 2) * c)
+    return None
+
+
+def exchange_bin(ser, timeout: float = client.TIMEOUT_S):
+    """Même échange en mode binaire (CMD_TIME)."""
+    ser.reset_input_buffer()
+    t1 = _now_us()
+    req = frame.encode_frame(frame.CMD_TIME, struct.pack("<Q", t1))
+    ser.write(req)
+
+    reader = frame.FrameReader()
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        for fid, payload in reader.feed(ser.read(ser.in_waiting or 1)):
+            t4 = _now_us()
+            if fid != frame.CMD_TIME or len(payload) != 24:
+                continue
+            r1, t2, t3 = struct.unpack("<QQQ", payload)
+            if r1 != t1:
+                continue
+            c = _char_us(ser)
+            n_rsp = len(frame.encode_frame(frame.CMD_TIME, payload))
+            return (t1, t2 - (len(req) + 1) * c, t3, t4 - n_rsp * c)
+    return None
+
+
+class ClockSync:
+    """
+    Modèle heure Pi <-> horloge STM32 (µs) à partir des échanges TIME.
+
+        sync = ClockSync()
+        for _ in range(8):
+            sync.add(*exchange(ser))
+        wall = sync.to_wall(client.get_all(ser)["t_us"])   # s, comme time.time()
+    """
+
+    def __init__(self, window: int = WINDOW):
+        self.window = window
+        self.samples = []                # (s, θ, δ) : s = milieu côté STM32
+        self.offset_us = None            # Pi - STM32 en ref_us
+        self.drift_ppm = 0.0
+        self.ref_us = 0
+        self.last_t2 = None              # dernière horloge STM32 64 bits connue
+
+    def add(self, t1: float, t2: float, t3: float, t4: float):
+        """Ajoute un échange ; retourne (θ, δ) en µs."""
+        theta = ((t2 - t1) + (t3 - t4)) / 2.0
+        delay = (t4 - t1) - (t3 - t2)
+        self.samples.append(((t2 + t3) / 2.0, theta, delay))
+        del self.samples[:-self.window]
+        self.last_t2 = int(t2)
+        self._fit()
+        return theta, delay
+
+    def _fit(self):
+        best = sorted(self.samples, key=lambda x: x[2])
+        best = best[:max(2, int(len(best) * BEST_FRACTION))]
+
+        # Pi - STM32 = -θ, droite en fonction de l'horloge STM32
+        self.ref_us = best[0][0]
+        xs = [s - self.ref_us for s, _, _ in best]
+        ys = [-theta for _, theta, _ in best]
+        n = len(xs)
+        mx, my = sum(xs) / n, sum(ys) / n
+        sxx = sum((x - mx) ** 2 for x in xs)
+        if n < 2 or sxx < 1e6:           # moins d'une seconde d'écart : décalage seul
+            self.offset_us = ys[0]
+            self.drift_ppm = 0.0
+            return
+        slope = sum((x - mx) * (y - my) for x, y in zip(xs, ys)) / sxx
+        self.offset_us = my - slope * mx
+        self.drift_ppm = slope * 1e6
+
+    def unwrap(self, stamp32: int) -> int:
+        """Horodatage 32 bits -> horloge STM32 64 bits (proche du dernier t2)."""
+        if self.last_t2 is None:
+            raise RuntimeError("Aucun échange TIME")
+        d = (stamp32 - self.last_t2) % WRAP32
+        if d >= WRAP32 // 2:
+            d -= WRAP32
+        return self.last_t2 + d
+
+    def to_pi_us(self, stm32_us: float) -> float:
+        """Horloge STM32 64 bits -> heure Pi (µs depuis l'epoch)."""
+        if self.offset_us is None:
+            raise RuntimeError("Aucun échange TIME")
+        return stm32_us + self.offset_us + (stm32_us - self.ref_us) * self.drift_ppm * 1e-6
+
+    def to_wall(self, stamp32: int) -> float:
+        """Horodatage t_us du STM32 -> heure murale (s, comme time.time())."""
+        return self.to_pi_us(self.unwrap(stamp32)) / 1e6
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    ap.add_argument("port")
+    ap.add_argument("--baud", type=int, default=client.BAUDRATE)
+    ap.add_argument("--period", type=float, default=1.0, help="s entre deux échanges")
+    ap.add_argument("--count", type=int, default=0, help="0 = sans fin")
+    args = ap.parse_args()
+
+    with serial.Serial(args.port, args.baud, timeout=client.TIMEOUT_S) as ser:
+        sync = ClockSync()
+        n = 0
+        try:
+            while args.count == 0 or n < args.count:
+                ts = exchange(ser)
+                if ts is None:
+                    print("pas de réponse TIME")
+                else:
+                    theta, delay = sync.add(*ts)
+                    print(f"θ={theta:12.1f} µs  δ={delay:7.1f} µs  "
+                          f"modèle: décalage={sync.offset_us:.1f} µs "
+                          f"dérive={sync.drift_ppm:+.2f} ppm")
+                n += 1
+                time.sleep(args.period)
+        except KeyboardInterrupt:
+            pass
+
+        if sync.offset_us is not None:
+            client.print = lambda *a, **k: None   # trace [DEBUG] de send_command
+            snap = client.get_all(ser)
+            wall = sync.to_wall(snap["t_us"])
+            print(f"Echantillon {snap['seq']} : "
+                  f"{time.strftime('%H:%M:%S', time.localtime(wall))}.{int(wall * 1e6) % 1000000:06d}, "
+                  f"il y a {(time.time() - wall) * 1e3:.1f} ms")
+
+
+if __name__ == "__main__":
+    main()
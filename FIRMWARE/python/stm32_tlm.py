@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+"""
+Télémétrie compressée du STM32 (voir COM_drivers/rpi/rpi_tlm.h)
+
+  payload MSG_DATA_Z = flags | varint seq | enregistrement | enregistrement ...
+
+  - enregistrement : un varint par canal : t_us puis les canaux abonnés
+    (ordre T, P, A)
+  - valeur : zigzag(v - v précédent) modulo 2^32 ; trame clé (flags & KEY) :
+    premier enregistrement absolu
+  - seq : numéro du premier enregistrement, +1 par suivant
+
+Deux décodeurs :
+  - decode_payload() : Python pur, une trame (TaggedLink, faible débit)
+  - TelemetryDecoder : numpy, un lot de trames d'un coup (enregistrements)
+"""
+
+KEY = 0x01
+BATCH_MAX = 16
+KEY_INTERVAL = 64
+PAYLOAD_MAX = 48
+VARINT_MAX = 5
+FRAME_OVERHEAD = 6   # id, len, crc16, COBS, 0x00
+
+
+class TelemetryError(Exception):
+    pass
+
+
+def zigzag(v: int) -> int:
+    v &= 0xFFFFFFFF
+    return ((v << 1) ^ (0xFFFFFFFF if v & 0x80000000 else 0)) & 0xFFFFFFFF
+
+
+def unzigzag(u: int) -> int:
+    return (u >> 1) ^ -(u & 1)
+
+
+def _wrap32(v: int) -> int:
+    return ((v + 0x80000000) & 0xFFFFFFFF) - 0x80000000
+
+
+def put_varint(v: int) -> bytes:
+    out = bytearray()
+    while v >= 0x80:
+        out.append((v & 0x7F) | 0x80)
+        v >>= 7
+    out.append(v)
+    return bytes(out)
+
+
+def get_varint(buf: bytes, off: int):
+    v = shift = 0
+    while True:
+        if off >= len(buf) or shift > 28:
+            raise TelemetryError("varint tronqué")
+        b = buf[off]
+        off += 1
+        v |= (b & 0x7F) << shift
+        if not b & 0x80:
+            return v, off
+        shift += 7
+
+
+# === Codeur de référence (même découpage que RpiTlm_Add) ===
+
+def encode(samples, batch: int = BATCH_MAX, seq0: int = 0) -> list:
+    """samples : liste d'enregistrements (tuples int32) -> liste de payloads."""
+    payloads = []
+    buf = None
+    prev = None
+    since_key = 0
+    n_rec = 0
+    for i, rec in enumerate(samples):
+        if buf is None:
+            if since_key >= KEY_INTERVAL:
+                prev = None
+            buf = bytearray((0 if prev is not None else KEY,))
+            buf += put_varint(seq0 + i)
+            if prev is None:
+                since_key = 0
+        for ch, v in enumerate(rec):
+            d = v if prev is None else v - prev[ch]
+            buf += put_varint(zigzag(d))
+        prev = rec
+        n_rec += 1
+        since_key += 1
+        if n_rec >= batch or len(buf) + VARINT_MAX * len(rec) > PAYLOAD_MAX:
+            payloads.append(bytes(buf))
+            buf = None
+            n_rec = 0
+    if buf is not None:
+        payloads.append(bytes(buf))
+    return payloads
+
+
+# === Décodage Python pur ===
+
+def decode_payload(payload: bytes, n_ch: int, prev=None):
+    """
+    Une trame -> (seq, [enregistrements]). prev = dernier enregistrement de
+    la trame précédente (ignoré pour une trame clé).
+    """
+    if not payload:
+        raise TelemetryError("trame vide")
+    key = payload[0] & KEY
+    if not key and prev is None:
+        raise TelemetryError("trame delta sans référence")
+    seq, off = get_varint(payload, 1)
+    recs = []
+    cur = None if key else list(prev)
+    while off < len(payload):
+        rec = []
+        for ch in range(n_ch):
+            u, off = get_varint(payload, off)
+            d = unzigzag(u)
+            rec.append(_wrap32(d if cur is None else cur[ch] + d))
+        recs.append(rec)
+        cur = rec
+    return seq, recs
+
+
+# === Décodage vectorisé (numpy) ===
+
+class TelemetryDecoder:
+    """
+    Décode un lot de payloads MSG_DATA_Z en tableaux :
+
+        dec = TelemetryDecoder(n_ch=3)
+        seq, values = dec.decode(payloads)   # (N,), (N, 3) int32
+
+    L'état (dernier enregistrement, seq attendu) est gardé d'un lot à
+    l'autre. Trou dans seq : enregistrements ignorés jusqu'à la clé suivante
+    (compteur `dropped_frames`).
+    """
+
+    def __init__(self, n_ch: int):
+        import numpy as np
+        self.np = np
+        self.n_ch = n_ch
+        self.prev = None          # dernier enregistrement (int64)
+        self.next_seq = None
+        self.dropped_frames = 0
+
+    def _varints(self, buf):
+        np = self.np
+        ends = np.flatnonzero(buf < 0x80)
+        if len(ends) == 0:
+            return np.zeros(0, np.uint64)
+        buf = buf[:ends[-1] + 1]
+        starts = np.empty_like(ends)
+        starts[0] = 0
+        starts[1:] = ends[:-1] + 1
+        # Rang de chaque octet dans son varint -> décalage 7 * rang
+        rank = np.arange(len(buf)) - np.repeat(starts, ends - starts + 1)
+        vals = (buf & 0x7F).astype(np.uint64) << (7 * rank).astype(np.uint64)
+        return np.add.reduceat(vals, starts)
+
+    def decode(self, payloads):
+        np = self.np
+        chunks, seqs, counts, keys = [], [], [], []
+
+        # En-têtes : quelques octets par trame, en Python
+        for p in payloads:
+            key = bool(p[0] & KEY)
+            seq, off = get_varint(p, 1)
+            if not key and (self.next_seq is None or seq != self.next_seq):
+                self.next_seq = None
+                self.dropped_frames += 1
+                continue
+            rec = np.frombuffer(p, np.uint8, offset=off)
+            n = int(np.count_nonzero(rec < 0x80)) // self.n_ch
+            if n == 0:
+                continue
+            chunks.append(rec)
+            seqs.append(seq)
+            counts.append(n)
+            keys.append(key)
+            self.next_seq = (seq + n) & 0xFFFFFFFF
+
+        if not chunks:
+            return np.zeros(0, np.uint32), np.zeros((0, self.n_ch), np.int32)
+
+        u = self._varints(np.concatenate(chunks))
+        d = ((u >> np.uint64(1)).astype(np.int64) ^ -(u & np.uint64(1)).astype(np.int64))
+        d = d.reshape(-1, self.n_ch)
+
+        counts = np.asarray(counts)
+        first_row = np.concatenate(([0], np.cumsum(counts)[:-1]))
+
+        # Lignes absolues : début de trame clé, et première ligne du lot
+        # rattachée au dernier enregistrement du lot précédent
+        absolute = np.zeros(len(d), bool)
+        absolute[first_row[np.asarray(keys)]] = True
+        if not keys[0]:
+            d[0] += self.prev
+            absolute[0] = True
+
+        # Somme cumulée remise à zéro sur chaque ligne absolue
+        total = np.cumsum(d, axis=0)
+        abs_rows = np.flatnonzero(absolute)
+        base = total[abs_rows] - d[abs_rows]
+        seg = np.cumsum(absolute) - 1
+        out = total - base[seg]
+        out = ((out + 0x80000000) & 0xFFFFFFFF) - 0x80000000
+        self.prev = out[-1].copy()
+
+        seq = np.repeat(np.asarray(seqs, np.int64), counts) + \
+            (np.arange(len(d)) - np.repeat(first_row, counts))
+        return (seq & 0xFFFFFFFF).astype(np.uint32), out.astype(np.int32)
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""
+Décodeur de la trace binaire du STM32 (COM_drivers/log/trace.h).
+
+  python3 stm32_trace.py firmware.elf /dev/ttyAMA0          # lecture continue
+  python3 stm32_trace.py firmware.elf /dev/ttyAMA0 --sync   # + heure murale
+  python3 stm32_trace.py firmware.elf --hex capture.txt     # lignes "TRC=..."
+
+Les chaînes de format ne sont pas dans la flash : TRACEn() les range dans
+la section .trace_fmt de l'ELF (non chargée, adresse 0), et le jeton d'un
+événement est l'adresse de sa chaîne. Il faut donc l'ELF exact de la
+carte (Debug/STM32_NUCLEO_CONTROLLER.elf).
+
+Réponse de la commande TRC :
+  "TRC=<événements>,<perdus>:<mots de 32 bits, 8 chiffres hex chacun>"
+  mot 0 : jeton | nombre d'arguments << 16, mot 1 : horodatage µs
+  (32 bits, Timebase_Now32), puis les arguments.
+"""
+
+import argparse
+import re
+import struct
+import sys
+import time
+
+TRACE_SECTION = ".trace_fmt"
+TRC_PERIOD_S = 0.05          # entre deux lectures quand la trace est vide
+
+_SPEC = re.compile(r"%(?P<flags>[-+ 0#]*)(?P<width>\d*)(?:\.\d+)?(?:hh|h|ll|l|z|j|t)?(?P<conv>[diuxXoc%])")
+
+
+# === Section .trace_fmt de l'ELF ===
+
+def read_section(elf_path: str, name: str = TRACE_SECTION):
+    """(adresse, contenu) d'une section d'un ELF 32 ou 64 bits little-endian."""
+    with open(elf_path, "rb") as fp:
+        data = fp.read()
+    if data[:4] != b"\x7fELF":
+        raise ValueError(f"{elf_path} : pas un ELF")
+    is64 = data[4] == 2
+    if data[5] != 1:
+        raise ValueError(f"{elf_path} : ELF big-endian non géré")
+
+    if is64:
+        shoff, = struct.unpack_from("<Q", data, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x3A)
+        fmt = "<IIQQQQIIQQ"
+    else:
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+        fmt = "<IIIIIIIIII"
+
+    sections = [struct.unpack_from(fmt, data, shoff + i * shentsize) for i in range(shnum)]
+    str_off, str_size = sections[shstrndx][4], sections[shstrndx][5]
+    strtab = data[str_off:str_off + str_size]
+
+    for sh_name, _, _, sh_addr, sh_offset, sh_size, *_ in sections:
+        end = strtab.index(b"\0", sh_name)
+        if strtab[sh_name:end].decode() == name:
+            return sh_addr, data[sh_offset:sh_offset + sh_size]
+    raise ValueError(f"{elf_path} : pas de section {name} (firmware sans trace ?)")
+
+
+def load_formats(elf_path: str) -> dict:
+    """Jeton (16 bits) -> (emplacement "fichier:ligne", format)."""
+    base, blob = read_section(elf_path)
+    table = {}
+    pos = 0
+    while pos < len(blob):
+        end = blob.find(b"\0", pos)
+        if end < 0:
+            end = len(blob)
+        if end > pos:
+            where, _, fmt = blob[pos:end].decode("utf-8", errors="replace").partition("\t")
+            table[(base + pos) & 0xFFFF] = (where.split("/")[-1], fmt)
+        pos = end + 1
+    return table
+
+
+# === Reconstruction des lignes ===
+
+def format_event(fmt: str, args) -> str:
+    """printf limité aux entiers 32 bits (voir trace.h)."""
+    it = iter(args)
+
+    def one(m):
+        conv = m.group("conv")
+        if conv == "%":
+            return "%"
+        v = next(it, 0)
+        if conv in "di" and v & 0x80000000:
+            v -= 1 << 32
+        if conv == "u":
+            conv = "d"
+        return ("%" + m.group("flags") + m.group("width") + conv) % v
+
+    return _SPEC.sub(one, fmt)
+
+
+def decode_words(words, table: dict):
+    """Mots bruts -> [(t_us, emplacement, texte)]."""
+    out = []
+    i = 0
+    while i + 2 <= len(words):
+        token = words[i] & 0xFFFF
+        nargs = (words[i] >> 16) & 0xFF
+        t_us = words[i + 1]
+        args = words[i + 2:i + 2 + nargs]
+        i += 2 + nargs
+        if token in table:
+            where, fmt = table[token]
+            out.append((t_us, where, format_event(fmt, args)))
+        else:
+            out.append((t_us, "?", f"jeton 0x{token:04X} inconnu (ELF différent ?) "
+                                   + " ".join(f"{a:08X}" for a in args)))
+    return out
+
+
+def parse_trc(line: str):
+    """'TRC=<événements>,<perdus>:<hex>' -> (événements, perdus, mots)."""
+    line = line.strip()
+    if not line.startswith("TRC="):
+        raise ValueError(f"Réponse inattendue : {line!r}")
+    head, _, hexa = line[4:].partition(":")
+    events, lost = map(int, head.split(","))
+    words = [int(hexa[k:k + 8], 16) for k in range(0, len(hexa) - 7, 8)]
+    return events, lost, words
+
+
+def read_trace(ser):
+    """Une lecture TRC sur le lien série (stm32_client_v3.send_command)."""
+    import stm32_client_v3 as client
+
+    return parse_trc(client.send_command(ser, "TRC"))
+
+
+# === Programme principal ===
+
+def _print_events(events, sync=None):
+    for t_us, where, text in events:
+        if sync is not None:
+            wall = sync.to_wall(t_us)
+            stamp = time.strftime("%H:%M:%S", time.localtime(wall)) + f".{int(wall * 1e6) % 1000000:06d}"
+        else:
+            stamp = f"{t_us:10d}"
+        print(f"{stamp}  {where:24} {text}")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    ap.add_argument("elf")
+    ap.add_argument("port", nargs="?")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--hex", metavar="FICHIER", help="décode les lignes TRC=... d'un fichier")
+    ap.add_argument("--sync", action="store_true", help="heure murale (échanges TIME)")
+    args = ap.parse_args()
+
+    table = load_formats(args.elf)
+    print(f"{len(table)} formats dans {TRACE_SECTION}", file=sys.stderr)
+
+    if args.hex:
+        with open(args.hex) as fp:
+            for line in fp:
+                if line.startswith("TRC="):
+                    _print_events(decode_words(parse_trc(line)[2], table))
+        return
+
+    if args.port is None:
+        ap.error("port série ou --hex requis")
+
+    import serial
+    import stm32_client_v3 as client
+    import stm32_time
+
+    client.print = lambda *a, **k: None   # trace [DEBUG] de send_command
+    with serial.Serial(args.port, args.baud, timeout=client.TIMEOUT_S) as ser:
+        sync = None
+        if args.sync:
+            sync = stm32_time.ClockSync()
+            for _ in range(8):
+                ts = stm32_time.exchange(ser)
+                if ts is not None:
+                    sync.add(*ts)
+            if sync.offset_us is None:
+                sys.exit("pas de réponse TIME")
+
+        lost_seen = None
+        try:
+            while True:
+                _, lost, words = read_trace(ser)
+                if lost_seen is not None and lost != lost_seen:
+                    print(f"--- {lost - lost_seen} événement(s) perdu(s) (buffer plein)")
+                lost_seen = lost
+                _print_events(decode_words(words, table), sync)
+                if not words:
+                    time.sleep(TRC_PERIOD_S)
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == "__main__":
+    main()